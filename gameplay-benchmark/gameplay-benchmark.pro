@@ -0,0 +1,53 @@
+QT -= core gui
+TARGET = gameplay-benchmark
+CONFIG += console
+CONFIG -= app_bundle
+CONFIG -= qt
+CONFIG += c++11
+CONFIG(debug, debug|release): DEFINES += _DEBUG
+
+TEMPLATE = app
+
+SOURCES += src/main.cpp \
+    src/QueryBenchmark.cpp \
+    src/CullingBenchmark.cpp \
+    src/FindBenchmark.cpp \
+    src/MatrixBenchmark.cpp
+
+HEADERS += src/QueryBenchmark.h \
+    src/CullingBenchmark.h \
+    src/FindBenchmark.h \
+    src/MatrixBenchmark.h
+
+INCLUDEPATH += ../gameplay/src
+INCLUDEPATH += ../external-deps/include
+
+win32 {
+    DEFINES += _WINDOWS WIN32 _UNICODE UNICODE
+    CONFIG(debug, debug|release): LIBS += -L$$PWD/../gameplay/Debug/debug/ -lgameplay
+    CONFIG(release, debug|release): LIBS += -L$$PWD/../gameplay/Release/release/ -lgameplay
+    CONFIG(debug, debug|release): LIBS += -L$$PWD/../external-deps/lib/windows/x86_64/Debug/ -lgameplay-deps
+    CONFIG(release, debug|release): LIBS += -L$$PWD/../external-deps/lib/windows/x86_64/Release/ -lgameplay-deps
+    LIBS += -lkernel32 -luser32 -lgdi32 -lwinspool -lcomdlg32 -ladvapi32 -lshell32 -lole32 -loleaut32 -luuid -lodbc32 -lodbccp32
+    QMAKE_CXXFLAGS_WARN_ON -= -w34100
+    QMAKE_CXXFLAGS_WARN_ON -= -w34189
+    QMAKE_CXXFLAGS_WARN_ON -= -w4302
+}
+
+linux {
+    DEFINES += __linux__
+    CONFIG(debug, debug|release): LIBS += -L$$PWD/../gameplay/Debug/debug/ -lgameplay
+    CONFIG(release, debug|release): LIBS += -L$$PWD/../gameplay/Release/release/ -lgameplay
+    CONFIG(debug, debug|release): LIBS += -L$$PWD/../external-deps/lib/linux/x86_64/Debug/ -lgameplay-deps
+    CONFIG(release, debug|release): LIBS += -L$$PWD/../external-deps/lib/linux/x86_64/Release/ -lgameplay-deps
+    LIBS += -lm -lrt -ldl -lpthread
+    QMAKE_CXXFLAGS += -lstdc++ -pthread -w
+}
+
+macx {
+    CONFIG(debug, debug|release): LIBS += -L$$PWD/../gameplay/Debug/ -lgameplay
+    CONFIG(release, debug|release):LIBS += -L$$PWD/../gameplay/Release/ -lgameplay
+    CONFIG(debug, debug|release): LIBS += -L$$PWD/../external-deps/lib/macos/x86_64/Debug/ -lgameplay-deps
+    CONFIG(release, debug|release): LIBS += -L$$PWD/../external-deps/lib/macos/x86_64/Release/ -lgameplay-deps
+    QMAKE_CXXFLAGS += -x c++ -stdlib=libc++ -w -arch x86_64
+}
@@ -0,0 +1,284 @@
+#include "Base.h"
+#include "BoundingBox.h"
+#include "BoundingSphere.h"
+#include "Frustum.h"
+#include "MathUtil.h"
+#include "CullingBenchmark.h"
+#include <chrono>
+#include <random>
+
+using namespace gameplay;
+
+#define CULLING_BENCHMARK_OBJECT_COUNT 100000
+#define CULLING_BENCHMARK_FRAME_COUNT 100
+#define CULLING_BENCHMARK_SPACING 4.0f
+#define CULLING_BENCHMARK_FAR_PLANE 100.0f
+#define CULLING_BENCHMARK_TAIL_COUNT 200
+
+static const char* __instructionSets[] = { "scalar", "sse4", "avx2", "neon" };
+
+/**
+ * The spheres and boxes to cull, one array per component.
+ */
+struct CullingObjects
+{
+    std::vector<float> centerX;
+    std::vector<float> centerY;
+    std::vector<float> centerZ;
+    std::vector<float> radius;
+    std::vector<float> minX;
+    std::vector<float> minY;
+    std::vector<float> minZ;
+    std::vector<float> maxX;
+    std::vector<float> maxY;
+    std::vector<float> maxZ;
+};
+
+static double getMilliseconds(std::chrono::high_resolution_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+static void createObjects(size_t count, std::mt19937& random, CullingObjects& objects)
+{
+    float size = cbrtf((float)count) * CULLING_BENCHMARK_SPACING;
+    std::uniform_real_distribution<float> position(-size * 0.5f, size * 0.5f);
+    std::uniform_real_distribution<float> halfSize(0.1f, 1.0f);
+    for (size_t i = 0; i < count; ++i)
+    {
+        objects.centerX.push_back(position(random));
+        objects.centerY.push_back(position(random));
+        objects.centerZ.push_back(position(random));
+        objects.radius.push_back(halfSize(random));
+        float x = position(random);
+        float y = position(random);
+        float z = position(random);
+        float extentX = halfSize(random);
+        float extentY = halfSize(random);
+        float extentZ = halfSize(random);
+        objects.minX.push_back(x - extentX);
+        objects.minY.push_back(y - extentY);
+        objects.minZ.push_back(z - extentZ);
+        objects.maxX.push_back(x + extentX);
+        objects.maxY.push_back(y + extentY);
+        objects.maxZ.push_back(z + extentZ);
+    }
+}
+
+/**
+ * Creates the frustum of a camera at the center of the objects that turns a little each frame,
+ * so most blocks of objects are culled by the same plane as on the frame before.
+ */
+static Frustum createFrustum(size_t frame)
+{
+    Matrix projection;
+    Matrix::createPerspective(60.0f, 16.0f / 9.0f, 0.1f, CULLING_BENCHMARK_FAR_PLANE, &projection);
+    float angle = (float)frame * 0.01f;
+    Matrix view;
+    Matrix::createLookAt(Vector3::zero(), Vector3(sinf(angle), 0.1f, cosf(angle)), Vector3(0.0f, 1.0f, 0.0f), &view);
+    return Frustum(projection * view);
+}
+
+/**
+ * Every fourth frame tests only some of the planes.
+ */
+static int getPlaneMask(size_t frame, std::mt19937& random)
+{
+    return frame % 4 == 3 ? (int)(random() % (Frustum::PLANE_ALL + 1)) : Frustum::PLANE_ALL;
+}
+
+static void getPlanes(const Frustum& frustum, const Plane* planes[6])
+{
+    planes[0] = &frustum.getNear();
+    planes[1] = &frustum.getFar();
+    planes[2] = &frustum.getLeft();
+    planes[3] = &frustum.getRight();
+    planes[4] = &frustum.getBottom();
+    planes[5] = &frustum.getTop();
+}
+
+/**
+ * Culls the spheres one at a time, with the same test as BoundingSphere::intersects(const Plane&).
+ */
+static size_t cullSpheres(const Frustum& frustum, const CullingObjects& objects, size_t begin, size_t count, int planeMask, uint32_t* visibility)
+{
+    const Plane* planes[6];
+    getPlanes(frustum, planes);
+    size_t visible = 0;
+    memset(visibility, 0, (count + 31) / 32 * sizeof(uint32_t));
+    for (size_t i = 0; i < count; ++i)
+    {
+        size_t object = begin + i;
+        BoundingSphere sphere(Vector3(objects.centerX[object], objects.centerY[object], objects.centerZ[object]), objects.radius[object]);
+        bool culled = false;
+        for (size_t plane = 0; plane < 6 && !culled; ++plane)
+        {
+            culled = (planeMask & (1 << plane)) && sphere.intersects(*planes[plane]) == Plane::INTERSECTS_BACK;
+        }
+        if (!culled)
+        {
+            visibility[i / 32] |= 1u << (i % 32);
+            ++visible;
+        }
+    }
+    return visible;
+}
+
+/**
+ * Culls the boxes one at a time, with the same test as BoundingBox::intersects(const Plane&).
+ */
+static size_t cullBoxes(const Frustum& frustum, const CullingObjects& objects, size_t begin, size_t count, int planeMask, uint32_t* visibility)
+{
+    const Plane* planes[6];
+    getPlanes(frustum, planes);
+    size_t visible = 0;
+    memset(visibility, 0, (count + 31) / 32 * sizeof(uint32_t));
+    for (size_t i = 0; i < count; ++i)
+    {
+        size_t object = begin + i;
+        BoundingBox box(Vector3(objects.minX[object], objects.minY[object], objects.minZ[object]),
+                        Vector3(objects.maxX[object], objects.maxY[object], objects.maxZ[object]));
+        bool culled = false;
+        for (size_t plane = 0; plane < 6 && !culled; ++plane)
+        {
+            culled = (planeMask & (1 << plane)) && box.intersects(*planes[plane]) == Plane::INTERSECTS_BACK;
+        }
+        if (!culled)
+        {
+            visibility[i / 32] |= 1u << (i % 32);
+            ++visible;
+        }
+    }
+    return visible;
+}
+
+static size_t cullSpheres(const Frustum& frustum, const CullingObjects& objects, size_t begin, size_t count, int planeMask, uint32_t* visibility,
+                          unsigned char* coherency)
+{
+    return frustum.cullSpheres(objects.centerX.data() + begin, objects.centerY.data() + begin, objects.centerZ.data() + begin, objects.radius.data() + begin, count,
+                               visibility, coherency, planeMask);
+}
+
+static size_t cullBoxes(const Frustum& frustum, const CullingObjects& objects, size_t begin, size_t count, int planeMask, uint32_t* visibility,
+                        unsigned char* coherency)
+{
+    return frustum.cullBoxes(objects.minX.data() + begin, objects.minY.data() + begin, objects.minZ.data() + begin, objects.maxX.data() + begin, objects.maxY.data() + begin,
+                             objects.maxZ.data() + begin, count, visibility, coherency, planeMask);
+}
+
+/**
+ * Compares the visible bits of count objects and the number of visible objects.
+ */
+static bool compareVisibility(const std::vector<uint32_t>& visibility, size_t visible, const std::vector<uint32_t>& reference, size_t referenceVisible,
+                              size_t count)
+{
+    if (visible != referenceVisible)
+        return false;
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (((visibility[i / 32] ^ reference[i / 32]) >> (i % 32)) & 1)
+            return false;
+    }
+    return true;
+}
+
+int runCullingBenchmark(int argc, char** argv)
+{
+    size_t objectCount = argc > 0 ? (size_t)std::max(atoi(argv[0]), 1) : CULLING_BENCHMARK_OBJECT_COUNT;
+    size_t frameCount = argc > 1 ? (size_t)std::max(atoi(argv[1]), 1) : CULLING_BENCHMARK_FRAME_COUNT;
+
+    std::mt19937 random((unsigned int)objectCount);
+    CullingObjects objects;
+    createObjects(objectCount, random, objects);
+    std::vector<Frustum> frustums;
+    std::vector<int> planeMasks;
+    for (size_t frame = 0; frame < frameCount; ++frame)
+    {
+        frustums.push_back(createFrustum(frame));
+        planeMasks.push_back(getPlaneMask(frame, random));
+    }
+
+    // The references are computed once, for every frame.
+    size_t words = (objectCount + 31) / 32;
+    std::vector<std::vector<uint32_t>> sphereReferences(frameCount, std::vector<uint32_t>(words));
+    std::vector<std::vector<uint32_t>> boxReferences(frameCount, std::vector<uint32_t>(words));
+    std::vector<size_t> sphereVisible(frameCount);
+    std::vector<size_t> boxVisible(frameCount);
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t frame = 0; frame < frameCount; ++frame)
+    {
+        sphereVisible[frame] = cullSpheres(frustums[frame], objects, 0, objectCount, planeMasks[frame], sphereReferences[frame].data());
+    }
+    double sphereTime = getMilliseconds(start) / (double)frameCount;
+    start = std::chrono::high_resolution_clock::now();
+    for (size_t frame = 0; frame < frameCount; ++frame)
+    {
+        boxVisible[frame] = cullBoxes(frustums[frame], objects, 0, objectCount, planeMasks[frame], boxReferences[frame].data());
+    }
+    double boxTime = getMilliseconds(start) / (double)frameCount;
+
+    printf("%zu objects, %zu frames, milliseconds per cull\n", objectCount, frameCount);
+    printf("%-12s %9s %9s\n", "", "spheres", "boxes");
+    printf("%-12s %9.3f %9.3f\n", "per object", sphereTime, boxTime);
+
+    std::string instructionSet = MathUtil::getInstructionSet();
+    bool identical = true;
+    std::vector<uint32_t> visibility(words);
+    std::vector<uint32_t> reference(words);
+    std::vector<unsigned char> coherency(words);
+    for (const char* name : __instructionSets)
+    {
+        if (!MathUtil::setInstructionSet(name))
+            continue;
+
+        // The coherency is kept from frame to frame, as a renderer would.
+        size_t mismatches = 0;
+        std::fill(coherency.begin(), coherency.end(), 0);
+        start = std::chrono::high_resolution_clock::now();
+        for (size_t frame = 0; frame < frameCount; ++frame)
+        {
+            size_t visible = cullSpheres(frustums[frame], objects, 0, objectCount, planeMasks[frame], visibility.data(), coherency.data());
+            if (!compareVisibility(visibility, visible, sphereReferences[frame], sphereVisible[frame], objectCount))
+                ++mismatches;
+        }
+        sphereTime = getMilliseconds(start) / (double)frameCount;
+        std::fill(coherency.begin(), coherency.end(), 0);
+        start = std::chrono::high_resolution_clock::now();
+        for (size_t frame = 0; frame < frameCount; ++frame)
+        {
+            size_t visible = cullBoxes(frustums[frame], objects, 0, objectCount, planeMasks[frame], visibility.data(), coherency.data());
+            if (!compareVisibility(visibility, visible, boxReferences[frame], boxVisible[frame], objectCount))
+                ++mismatches;
+        }
+        boxTime = getMilliseconds(start) / (double)frameCount;
+        printf("%-12s %9.3f %9.3f\n", name, sphereTime, boxTime);
+
+        // Short runs at any offset cover the tails of the blocks and the unaligned arrays.
+        std::mt19937 tails((unsigned int)objectCount);
+        for (size_t i = 0; i < CULLING_BENCHMARK_TAIL_COUNT; ++i)
+        {
+            size_t count = std::min((size_t)(tails() % 100), objectCount);
+            size_t begin = tails() % (objectCount - count + 1);
+            size_t frame = tails() % frameCount;
+            int planeMask = getPlaneMask(tails() % 4, tails);
+            unsigned char* blocks = i % 2 ? coherency.data() : nullptr;
+            std::fill(coherency.begin(), coherency.end(), 0);
+            size_t referenceVisible = cullSpheres(frustums[frame], objects, begin, count, planeMask, reference.data());
+            size_t visible = cullSpheres(frustums[frame], objects, begin, count, planeMask, visibility.data(), blocks);
+            if (!compareVisibility(visibility, visible, reference, referenceVisible, count))
+                ++mismatches;
+            referenceVisible = cullBoxes(frustums[frame], objects, begin, count, planeMask, reference.data());
+            visible = cullBoxes(frustums[frame], objects, begin, count, planeMask, visibility.data(), blocks);
+            if (!compareVisibility(visibility, visible, reference, referenceVisible, count))
+                ++mismatches;
+        }
+        if (mismatches)
+        {
+            printf("MISMATCH: %zu %s culls differ from the tests of one object at a time\n", mismatches, name);
+            identical = false;
+        }
+    }
+    MathUtil::setInstructionSet(instructionSet.c_str());
+    printf("%s\n", identical ? "Every visibility bit matches the tests of one object at a time." : "Some visibility bits differ.");
+    return identical ? 0 : 1;
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+/**
+ * Runs the batched frustum culling of spheres and boxes with the kernels of
+ * each instruction set the cpu supports and checks every visibility bit
+ * against the tests of one object at a time.
+ *
+ * Usage: gameplay-benchmark culling [objects] [frames]
+ *
+ * @param argc The number of arguments after "culling".
+ * @param argv The arguments after "culling".
+ * @return 0 if every bit matched, 1 if not.
+ */
+int runCullingBenchmark(int argc, char** argv);
@@ -0,0 +1,251 @@
+#include "Base.h"
+#include "Scene.h"
+#include "SceneObject.h"
+#include "FindBenchmark.h"
+#include <chrono>
+#include <random>
+
+using namespace gameplay;
+
+#define FIND_BENCHMARK_CAR_COUNT 10000
+#define FIND_BENCHMARK_HIERARCHY_COUNT 300
+#define FIND_BENCHMARK_REPEAT_COUNT 10
+#define FIND_BENCHMARK_SEARCH_COUNT 40
+#define FIND_BENCHMARK_SPARE_INTERVAL 100
+
+static const char* __hierarchyNames[] = { "A", "AB", "B", "Wheel", "W", "" };
+
+static double getMicroseconds(std::chrono::high_resolution_clock::time_point start)
+{
+    return std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+/**
+ * Finds the objects below an object with a breadth first walk, nearest first.
+ */
+static void findBreadthFirst(SceneObject* object, const std::string& name, bool recursive, bool exactMatch, std::vector<SceneObject*>& objects)
+{
+    std::vector<SceneObject*> queue(1, object);
+    for (size_t i = 0; i < queue.size(); ++i)
+    {
+        for (const auto& child : queue[i]->getChildren())
+        {
+            const std::string& childName = child->getName();
+            if (exactMatch ? childName == name : childName.compare(0, name.size(), name) == 0)
+                objects.push_back(child.get());
+            if (recursive)
+                queue.push_back(child.get());
+        }
+    }
+}
+
+static size_t getDepth(const SceneObject* object, const SceneObject* ancestor)
+{
+    size_t depth = 0;
+    for (; object != ancestor; object = object->getParent().get())
+    {
+        ++depth;
+    }
+    return depth;
+}
+
+/**
+ * Checks that findObject returns the first object of the walk and that findObjects
+ * returns the same objects as the walk, level by level.
+ */
+static bool checkSearch(SceneObject* object, const std::string& name, bool recursive, bool exactMatch)
+{
+    std::vector<SceneObject*> reference;
+    findBreadthFirst(object, name, recursive, exactMatch, reference);
+    std::shared_ptr<SceneObject> found = object->findObject(name, recursive, exactMatch);
+    if (found.get() != (reference.empty() ? nullptr : reference.front()))
+        return false;
+
+    std::vector<std::shared_ptr<SceneObject>> objects;
+    if (object->findObjects(name, objects, recursive, exactMatch) != reference.size() || objects.size() != reference.size())
+        return false;
+    std::vector<SceneObject*> sorted;
+    for (size_t i = 0; i < objects.size(); ++i)
+    {
+        if (i > 0 && getDepth(objects[i - 1].get(), object) > getDepth(objects[i].get(), object))
+            return false;
+        sorted.push_back(objects[i].get());
+    }
+    std::sort(sorted.begin(), sorted.end());
+    std::sort(reference.begin(), reference.end());
+    return sorted == reference;
+}
+
+/**
+ * Builds a scene of cars, each a few levels below the root with a body and four wheels,
+ * so every car has the same names as thousands of others. Only a few cars have a spare wheel.
+ */
+static std::shared_ptr<SceneObject> createCars(size_t count, std::vector<std::shared_ptr<SceneObject>>& cars)
+{
+    std::shared_ptr<SceneObject> root = std::make_shared<SceneObject>();
+    for (size_t i = 0; i < count; ++i)
+    {
+        std::shared_ptr<SceneObject> parent = root;
+        for (size_t level = 0; level < 3; ++level)
+        {
+            std::shared_ptr<SceneObject> object = std::make_shared<SceneObject>();
+            parent->addChild(object);
+            parent = object;
+        }
+        std::shared_ptr<SceneObject> car = std::make_shared<SceneObject>();
+        car->setName("Car");
+        parent->addChild(car);
+        std::shared_ptr<SceneObject> body = std::make_shared<SceneObject>();
+        body->setName("Body");
+        car->addChild(body);
+        for (size_t wheel = 0; wheel < 4; ++wheel)
+        {
+            std::shared_ptr<SceneObject> object = std::make_shared<SceneObject>();
+            object->setName("Wheel");
+            body->addChild(object);
+        }
+        if (i % FIND_BENCHMARK_SPARE_INTERVAL == 0)
+        {
+            std::shared_ptr<SceneObject> spare = std::make_shared<SceneObject>();
+            spare->setName("Spare");
+            body->addChild(spare);
+        }
+        cars.push_back(car);
+    }
+    root->getScene()->updateTransforms();
+    return root;
+}
+
+/**
+ * Builds a random hierarchy with few distinct names. Some are sorted by an update and
+ * some have subtrees moved afterwards, so both ways of searching the scene are used.
+ */
+static std::shared_ptr<SceneObject> createHierarchy(size_t index, std::mt19937& random, std::vector<std::shared_ptr<SceneObject>>& objects)
+{
+    std::shared_ptr<SceneObject> root = std::make_shared<SceneObject>();
+    objects.assign(1, root);
+    size_t count = 1 + random() % 400;
+    for (size_t i = 0; i < count; ++i)
+    {
+        std::shared_ptr<SceneObject> object = std::make_shared<SceneObject>();
+        object->setName(__hierarchyNames[random() % 6]);
+        objects[random() % objects.size()]->addChild(object);
+        objects.push_back(object);
+    }
+    if (index % 3 == 0)
+        root->getScene()->updateTransforms();
+    for (size_t i = 0; index % 2 == 1 && i < 20; ++i)
+    {
+        std::shared_ptr<SceneObject> object = objects[1 + random() % (objects.size() - 1)];
+        std::shared_ptr<SceneObject> parent = objects[random() % objects.size()];
+        bool descendant = false;
+        for (SceneObject* ancestor = parent.get(); ancestor && !descendant; ancestor = ancestor->getParent().get())
+        {
+            descendant = ancestor == object.get();
+        }
+        if (!descendant)
+        {
+            object->getParent()->removeChild(object);
+            parent->addChild(object);
+        }
+    }
+    if (index % 5 == 1)
+        root->getScene()->updateTransforms();
+    return root;
+}
+
+int runFindBenchmark(int argc, char** argv)
+{
+    size_t carCount = argc > 0 ? (size_t)std::max(atoi(argv[0]), 1) : FIND_BENCHMARK_CAR_COUNT;
+    size_t hierarchyCount = argc > 1 ? (size_t)std::max(atoi(argv[1]), 1) : FIND_BENCHMARK_HIERARCHY_COUNT;
+
+    std::vector<std::shared_ptr<SceneObject>> cars;
+    std::shared_ptr<SceneObject> root = createCars(carCount, cars);
+    printf("%zu cars, microseconds per search\n", carCount);
+    printf("%-28s %10s %10s\n", "", "find", "walk");
+
+    // Each search is timed on every car, with findObject and with the walk.
+    struct Search
+    {
+        const char* label;
+        const char* name;
+        bool recursive;
+    };
+    const Search searches[] = { { "car findObject Wheel", "Wheel", true }, { "car findObject Body, direct", "Body", false } };
+    bool identical = true;
+    std::vector<SceneObject*> objects;
+    for (const Search& search : searches)
+    {
+        size_t found = 0;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (size_t repeat = 0; repeat < FIND_BENCHMARK_REPEAT_COUNT; ++repeat)
+        {
+            for (const auto& car : cars)
+            {
+                found += car->findObject(search.name, search.recursive) != nullptr;
+            }
+        }
+        double findTime = getMicroseconds(start) / (double)(FIND_BENCHMARK_REPEAT_COUNT * carCount);
+        start = std::chrono::high_resolution_clock::now();
+        for (size_t repeat = 0; repeat < FIND_BENCHMARK_REPEAT_COUNT; ++repeat)
+        {
+            for (const auto& car : cars)
+            {
+                objects.clear();
+                findBreadthFirst(car.get(), search.name, search.recursive, true, objects);
+            }
+        }
+        double walkTime = getMicroseconds(start) / (double)(FIND_BENCHMARK_REPEAT_COUNT * carCount);
+        printf("%-28s %10.3f %10.3f\n", search.label, findTime, walkTime);
+        if (found != FIND_BENCHMARK_REPEAT_COUNT * carCount)
+            identical = false;
+    }
+    // The whole scene is searched for every wheel and for the few spare wheels, with each.
+    const Search rootSearches[] = { { "root findObjects Wheel", "Wheel", true }, { "root findObjects Spare", "Spare", true } };
+    const size_t rootCounts[] = { 4 * carCount, (carCount + FIND_BENCHMARK_SPARE_INTERVAL - 1) / FIND_BENCHMARK_SPARE_INTERVAL };
+    for (size_t i = 0; i < 2; ++i)
+    {
+        std::vector<std::shared_ptr<SceneObject>> found;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (size_t repeat = 0; repeat < FIND_BENCHMARK_REPEAT_COUNT; ++repeat)
+        {
+            found.clear();
+            root->findObjects(rootSearches[i].name, found);
+        }
+        double findTime = getMicroseconds(start) / (double)FIND_BENCHMARK_REPEAT_COUNT;
+        start = std::chrono::high_resolution_clock::now();
+        for (size_t repeat = 0; repeat < FIND_BENCHMARK_REPEAT_COUNT; ++repeat)
+        {
+            objects.clear();
+            findBreadthFirst(root.get(), rootSearches[i].name, true, true, objects);
+        }
+        double walkTime = getMicroseconds(start) / (double)FIND_BENCHMARK_REPEAT_COUNT;
+        printf("%-28s %10.3f %10.3f\n", rootSearches[i].label, findTime, walkTime);
+        if (found.size() != rootCounts[i] || !checkSearch(root.get(), rootSearches[i].name, true, true))
+            identical = false;
+    }
+    if (!identical)
+        printf("MISMATCH: the searches of the cars differ from the walk\n");
+
+    // The random hierarchies are searched from random objects with exact names and prefixes.
+    std::mt19937 random((unsigned int)hierarchyCount);
+    size_t mismatches = 0;
+    std::vector<std::shared_ptr<SceneObject>> hierarchy;
+    for (size_t i = 0; i < hierarchyCount; ++i)
+    {
+        createHierarchy(i, random, hierarchy);
+        for (size_t search = 0; search < FIND_BENCHMARK_SEARCH_COUNT; ++search)
+        {
+            SceneObject* object = hierarchy[random() % hierarchy.size()].get();
+            std::string name = __hierarchyNames[random() % 5];
+            bool recursive = random() % 2 == 0;
+            bool exactMatch = random() % 2 == 0;
+            if (!checkSearch(object, name, recursive, exactMatch))
+                ++mismatches;
+        }
+    }
+    printf("%zu random hierarchies, %zu searches, %zu differ from the walk\n", hierarchyCount, hierarchyCount * FIND_BENCHMARK_SEARCH_COUNT, mismatches);
+    if (mismatches)
+        identical = false;
+    return identical ? 0 : 1;
+}
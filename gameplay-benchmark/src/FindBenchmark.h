@@ -0,0 +1,14 @@
+#pragma once
+
+/**
+ * Times SceneObject::findObject and findObjects in a scene of many cars
+ * against a breadth first walk, and checks them against that walk on
+ * random hierarchies.
+ *
+ * Usage: gameplay-benchmark find [cars] [hierarchies]
+ *
+ * @param argc The number of arguments after "find".
+ * @param argv The arguments after "find".
+ * @return 0 if every search matched the walk, 1 if not.
+ */
+int runFindBenchmark(int argc, char** argv);
@@ -0,0 +1,198 @@
+#include "Base.h"
+#include "AffineTransform.h"
+#include "Matrix.h"
+#include "MathUtil.h"
+#include "Quaternion.h"
+#include "MatrixBenchmark.h"
+#include <chrono>
+#include <random>
+
+using namespace gameplay;
+
+#define MATRIX_BENCHMARK_MATRIX_COUNT 1000
+#define MATRIX_BENCHMARK_REPEAT_COUNT 1000
+#define MATRIX_BENCHMARK_SINGULAR_INTERVAL 100
+#define MATRIX_BENCHMARK_TOLERANCE 1.0e-5f
+
+static const char* __instructionSets[] = { "scalar", "sse4", "avx2", "neon" };
+
+/**
+ * The results of the kernels of one instruction set.
+ */
+struct MatrixResults
+{
+    std::vector<Matrix> products;
+    std::vector<Matrix> inverses;
+    std::vector<bool> inverted;
+    std::vector<AffineTransform> affineProducts;
+};
+
+static double getNanoseconds(std::chrono::high_resolution_clock::time_point start)
+{
+    return std::chrono::duration<double, std::nano>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+/**
+ * Creates transforms of objects with random translations, rotations and scales, and a few
+ * cameras with a projection. Some have a zero scale, so they can't be inverted.
+ */
+static void createMatrices(size_t count, std::mt19937& random, std::vector<Matrix>& matrices, std::vector<AffineTransform>& transforms)
+{
+    std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+    std::uniform_real_distribution<float> axis(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> angle(-GP_MATH_PI, GP_MATH_PI);
+    std::uniform_real_distribution<float> scale(0.1f, 10.0f);
+    for (size_t i = 0; i < count; ++i)
+    {
+        Vector3 direction(axis(random), axis(random), axis(random));
+        if (direction.isZero())
+            direction.x = 1.0f;
+        direction.normalize();
+        Vector3 s(scale(random), scale(random), scale(random));
+        if (i % MATRIX_BENCHMARK_SINGULAR_INTERVAL == MATRIX_BENCHMARK_SINGULAR_INTERVAL - 1)
+            s.y = 0.0f;
+        AffineTransform transform(Vector3(position(random), position(random), position(random)), Quaternion(direction, angle(random)), s);
+        Matrix matrix = transform.getMatrix();
+        if (i % 10 == 5)
+        {
+            Matrix projection;
+            Matrix::createPerspective(60.0f, 16.0f / 9.0f, 0.1f, 1000.0f, &projection);
+            matrix = projection * matrix;
+        }
+        matrices.push_back(matrix);
+        transforms.push_back(transform);
+    }
+}
+
+static float getLargest(const float* m, size_t count)
+{
+    float largest = 1.0f;
+    for (size_t i = 0; i < count; ++i)
+    {
+        largest = std::max(largest, std::fabs(m[i]));
+    }
+    return largest;
+}
+
+/**
+ * Checks that the values of two matrices are equal, relative to the largest value of the first.
+ */
+static bool isEqual(const float* reference, const float* m, size_t count)
+{
+    float tolerance = getLargest(reference, count) * MATRIX_BENCHMARK_TOLERANCE;
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (!(std::fabs(reference[i] - m[i]) <= tolerance))
+            return false;
+    }
+    return true;
+}
+
+/**
+ * Runs the kernels on every matrix and its next one, and returns the average times of a call in nanoseconds.
+ */
+static void runKernels(const std::vector<Matrix>& matrices, const std::vector<AffineTransform>& transforms, size_t repeatCount,
+                       MatrixResults& results, double* times)
+{
+    size_t count = matrices.size();
+    results.products.assign(count, Matrix());
+    results.inverses.assign(count, Matrix());
+    results.inverted.assign(count, false);
+    results.affineProducts.assign(count, AffineTransform());
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t repeat = 0; repeat < repeatCount; ++repeat)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            Matrix::multiply(matrices[i], matrices[(i + 1) % count], &results.products[i]);
+        }
+    }
+    times[0] = getNanoseconds(start) / (double)(repeatCount * count);
+
+    start = std::chrono::high_resolution_clock::now();
+    for (size_t repeat = 0; repeat < repeatCount; ++repeat)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            results.inverted[i] = matrices[i].invert(&results.inverses[i]);
+        }
+    }
+    times[1] = getNanoseconds(start) / (double)(repeatCount * count);
+
+    start = std::chrono::high_resolution_clock::now();
+    for (size_t repeat = 0; repeat < repeatCount; ++repeat)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            AffineTransform::multiply(transforms[i], transforms[(i + 1) % count], &results.affineProducts[i]);
+        }
+    }
+    times[2] = getNanoseconds(start) / (double)(repeatCount * count);
+}
+
+/**
+ * Checks the results of an instruction set against the scalar ones, and that the kernels
+ * give the same results when the destination is one of their inputs.
+ */
+static bool checkKernels(const std::vector<Matrix>& matrices, const std::vector<AffineTransform>& transforms,
+                         const MatrixResults& reference, const MatrixResults& results)
+{
+    size_t count = matrices.size();
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (!isEqual(reference.products[i].m, results.products[i].m, 16) ||
+            !isEqual(reference.affineProducts[i].m, results.affineProducts[i].m, 12) ||
+            reference.inverted[i] != results.inverted[i] ||
+            (reference.inverted[i] && !isEqual(reference.inverses[i].m, results.inverses[i].m, 16)))
+            return false;
+
+        Matrix product = matrices[i];
+        Matrix::multiply(product, matrices[(i + 1) % count], &product);
+        Matrix inverse = matrices[i];
+        bool inverted = inverse.invert();
+        AffineTransform affineProduct = transforms[(i + 1) % count];
+        AffineTransform::multiply(transforms[i], affineProduct, &affineProduct);
+        if (std::memcmp(product.m, results.products[i].m, sizeof(product.m)) != 0 ||
+            std::memcmp(affineProduct.m, results.affineProducts[i].m, sizeof(affineProduct.m)) != 0 ||
+            inverted != results.inverted[i] ||
+            (inverted && std::memcmp(inverse.m, results.inverses[i].m, sizeof(inverse.m)) != 0))
+            return false;
+    }
+    return true;
+}
+
+int runMatrixBenchmark(int argc, char** argv)
+{
+    size_t matrixCount = argc > 0 ? (size_t)std::max(atoi(argv[0]), 2) : MATRIX_BENCHMARK_MATRIX_COUNT;
+    size_t repeatCount = argc > 1 ? (size_t)std::max(atoi(argv[1]), 1) : MATRIX_BENCHMARK_REPEAT_COUNT;
+
+    std::mt19937 random(1);
+    std::vector<Matrix> matrices;
+    std::vector<AffineTransform> transforms;
+    createMatrices(matrixCount, random, matrices, transforms);
+
+    printf("%zu matrices, %zu repeats, nanoseconds per call\n", matrixCount, repeatCount);
+    printf("%-8s %10s %10s %10s %10s\n", "", "multiply", "invert", "affine", "identical");
+
+    // Each instruction set is compared with the scalar kernels, which run first.
+    std::string instructionSet = MathUtil::getInstructionSet();
+    bool identical = true;
+    MatrixResults reference;
+    MatrixResults results;
+    for (const char* name : __instructionSets)
+    {
+        if (!MathUtil::setInstructionSet(name))
+            continue;
+
+        double times[3];
+        bool scalar = std::strcmp(name, "scalar") == 0;
+        runKernels(matrices, transforms, repeatCount, scalar ? reference : results, times);
+        bool matches = checkKernels(matrices, transforms, reference, scalar ? reference : results);
+        printf("%-8s %10.2f %10.2f %10.2f %10s\n", name, times[0], times[1], times[2], matches ? "yes" : "NO");
+        identical = identical && matches;
+    }
+    MathUtil::setInstructionSet(instructionSet.c_str());
+    printf("%s\n", identical ? "Every result matches the scalar kernels." : "Some results differ from the scalar kernels.");
+    return identical ? 0 : 1;
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+/**
+ * Times Matrix::multiply, Matrix::invert and AffineTransform::multiply with
+ * the kernels of each instruction set the cpu supports and checks their
+ * results against the scalar kernels.
+ *
+ * Usage: gameplay-benchmark matrices [matrices] [repeats]
+ *
+ * @param argc The number of arguments after "matrices".
+ * @param argv The arguments after "matrices".
+ * @return 0 if every result matched, 1 if not.
+ */
+int runMatrixBenchmark(int argc, char** argv);
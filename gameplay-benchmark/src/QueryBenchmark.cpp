@@ -0,0 +1,593 @@
+#include "Base.h"
+#include "Scene.h"
+#include "SceneObject.h"
+#include "BoundingVolumeHierarchy.h"
+#include "SpatialHashGrid.h"
+#include "QueryBenchmark.h"
+#include <chrono>
+#include <random>
+
+using namespace gameplay;
+
+#define QUERY_BENCHMARK_QUERY_COUNT 100
+#define QUERY_BENCHMARK_SPACING 4.0f
+#define QUERY_BENCHMARK_QUERY_SIZE 5.0f
+#define QUERY_BENCHMARK_RAY_LENGTH 100.0f
+#define QUERY_BENCHMARK_FAR_PLANE 50.0f
+#define QUERY_BENCHMARK_NEAREST_COUNT 8
+#define QUERY_BENCHMARK_CHANGE_ROUNDS 2
+
+enum QueryType
+{
+    QUERY_BOX,
+    QUERY_SPHERE,
+    QUERY_FRUSTUM,
+    QUERY_RAYCAST,
+    QUERY_RAYCAST_ALL,
+    QUERY_NEAREST,
+    QUERY_TYPE_COUNT,
+    QUERY_FRUSTUM_IN_BOX = QUERY_TYPE_COUNT,
+    QUERY_RESULT_COUNT
+};
+
+static const char* __queryNames[QUERY_TYPE_COUNT] = { "box", "sphere", "frustum", "raycast", "raycastAll", "nearest" };
+
+/**
+ * The objects of a run with their world bounds. The objects are never
+ * added to a scene, they are only the identities the indices return.
+ */
+struct QueryObjects
+{
+    std::vector<std::shared_ptr<SceneObject>> owners;
+    std::vector<SceneObject*> objects;
+    std::vector<BoundingBox> boxes;
+    std::vector<uint32_t> layerMasks;
+};
+
+struct Queries
+{
+    std::vector<BoundingBox> boxes;
+    std::vector<BoundingSphere> spheres;
+    std::vector<Frustum> frustums;
+    std::vector<Ray> rays;
+    std::vector<Vector3> points;
+};
+
+/**
+ * A spatial index that is run with its own proxies for the objects.
+ */
+struct QueryIndex
+{
+    const char* name;
+    std::unique_ptr<SpatialIndex> index;
+    bool frustumInBox;
+    std::vector<size_t> proxies;
+};
+
+/**
+ * The objects found by each query, one after the other, with the end of
+ * the objects of each query. The nearest hit of each raycast is kept by
+ * its distance, since objects at the same distance may come in any order.
+ * Brute force also finds the objects of each frustum that are in the box
+ * of its corners, for the indices that reject the others.
+ */
+struct QueryResults
+{
+    std::vector<SceneObject*> objects[QUERY_RESULT_COUNT];
+    std::vector<size_t> ends[QUERY_RESULT_COUNT];
+    std::vector<float> distances;
+    double times[QUERY_TYPE_COUNT];
+};
+
+static double getMicroseconds(std::chrono::high_resolution_clock::time_point start)
+{
+    return std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+static Vector3 randomPoint(std::mt19937& random, float size)
+{
+    std::uniform_real_distribution<float> distribution(0.0f, size);
+    return Vector3(distribution(random), distribution(random), distribution(random));
+}
+
+static Vector3 randomDirection(std::mt19937& random)
+{
+    // Not too close to the up axis, so it makes a valid view.
+    std::normal_distribution<float> distribution;
+    Vector3 direction;
+    do
+    {
+        direction.set(distribution(random), distribution(random), distribution(random));
+        direction.normalize();
+    }
+    while (direction.isZero() || fabsf(direction.y) > 0.99f);
+    return direction;
+}
+
+/**
+ * Scatters the objects uniformly in a cube that grows with their count,
+ * so every run has the same density of objects.
+ */
+static float createObjects(size_t count, std::mt19937& random, QueryObjects& objects)
+{
+    float size = cbrtf((float)count) * QUERY_BENCHMARK_SPACING;
+    std::uniform_real_distribution<float> halfSize(0.1f, 1.0f);
+    objects.owners.resize(count);
+    objects.objects.resize(count);
+    objects.boxes.resize(count);
+    objects.layerMasks.assign(count, 1);
+    for (size_t i = 0; i < count; ++i)
+    {
+        objects.owners[i] = std::make_shared<SceneObject>();
+        objects.objects[i] = objects.owners[i].get();
+        Vector3 center = randomPoint(random, size);
+        Vector3 extent(halfSize(random), halfSize(random), halfSize(random));
+        objects.boxes[i].set(center - extent, center + extent);
+    }
+    return size;
+}
+
+static void createQueries(size_t count, float size, std::mt19937& random, Queries& queries)
+{
+    Matrix projection;
+    Matrix::createPerspective(60.0f, 16.0f / 9.0f, 0.1f, QUERY_BENCHMARK_FAR_PLANE, &projection);
+    Vector3 extent(QUERY_BENCHMARK_QUERY_SIZE, QUERY_BENCHMARK_QUERY_SIZE, QUERY_BENCHMARK_QUERY_SIZE);
+    for (size_t i = 0; i < count; ++i)
+    {
+        Vector3 center = randomPoint(random, size);
+        queries.boxes.push_back(BoundingBox(center - extent, center + extent));
+        queries.spheres.push_back(BoundingSphere(randomPoint(random, size), QUERY_BENCHMARK_QUERY_SIZE));
+
+        Vector3 eye = randomPoint(random, size);
+        Matrix view;
+        Matrix::createLookAt(eye, eye + randomDirection(random), Vector3(0.0f, 1.0f, 0.0f), &view);
+        queries.frustums.push_back(Frustum(projection * view));
+        queries.rays.push_back(Ray(randomPoint(random, size), randomDirection(random)));
+        queries.points.push_back(randomPoint(random, size));
+    }
+}
+
+/**
+ * The same slab test as the indices, so the distances of the hits are the same.
+ */
+static bool intersectRay(const BoundingBox& box, const Ray& ray, float maxDistance, float* distance)
+{
+    const Vector3& origin = ray.getOrigin();
+    const Vector3& direction = ray.getDirection();
+    const float largest = std::numeric_limits<float>::max();
+    Vector3 inverseDirection(direction.x != 0.0f ? 1.0f / direction.x : largest,
+                             direction.y != 0.0f ? 1.0f / direction.y : largest,
+                             direction.z != 0.0f ? 1.0f / direction.z : largest);
+    float t1 = (box.min.x - origin.x) * inverseDirection.x;
+    float t2 = (box.max.x - origin.x) * inverseDirection.x;
+    float tmin = std::min(t1, t2);
+    float tmax = std::max(t1, t2);
+    t1 = (box.min.y - origin.y) * inverseDirection.y;
+    t2 = (box.max.y - origin.y) * inverseDirection.y;
+    tmin = std::max(tmin, std::min(t1, t2));
+    tmax = std::min(tmax, std::max(t1, t2));
+    t1 = (box.min.z - origin.z) * inverseDirection.z;
+    t2 = (box.max.z - origin.z) * inverseDirection.z;
+    tmin = std::max(tmin, std::min(t1, t2));
+    tmax = std::min(tmax, std::max(t1, t2));
+    tmin = std::max(tmin, 0.0f);
+    if (tmin > tmax || tmin > maxDistance)
+        return false;
+    *distance = tmin;
+    return true;
+}
+
+static void clearResults(QueryResults& results)
+{
+    for (size_t type = 0; type < QUERY_RESULT_COUNT; ++type)
+    {
+        results.objects[type].clear();
+        results.ends[type].clear();
+    }
+    for (size_t type = 0; type < QUERY_TYPE_COUNT; ++type)
+    {
+        results.times[type] = 0.0;
+    }
+    results.distances.clear();
+}
+
+/**
+ * Tests every object against every query.
+ */
+static void runBruteForce(const QueryObjects& objects, const Queries& queries, QueryResults& results)
+{
+    clearResults(results);
+    size_t count = objects.boxes.size();
+    auto start = std::chrono::high_resolution_clock::now();
+    for (const BoundingBox& query : queries.boxes)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (objects.boxes[i].intersects(query))
+                results.objects[QUERY_BOX].push_back(objects.objects[i]);
+        }
+        results.ends[QUERY_BOX].push_back(results.objects[QUERY_BOX].size());
+    }
+    results.times[QUERY_BOX] = getMicroseconds(start);
+
+    start = std::chrono::high_resolution_clock::now();
+    for (const BoundingSphere& query : queries.spheres)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (query.intersects(objects.boxes[i]))
+                results.objects[QUERY_SPHERE].push_back(objects.objects[i]);
+        }
+        results.ends[QUERY_SPHERE].push_back(results.objects[QUERY_SPHERE].size());
+    }
+    results.times[QUERY_SPHERE] = getMicroseconds(start);
+
+    start = std::chrono::high_resolution_clock::now();
+    for (const Frustum& query : queries.frustums)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (query.intersects(objects.boxes[i]))
+                results.objects[QUERY_FRUSTUM].push_back(objects.objects[i]);
+        }
+        results.ends[QUERY_FRUSTUM].push_back(results.objects[QUERY_FRUSTUM].size());
+    }
+    results.times[QUERY_FRUSTUM] = getMicroseconds(start);
+
+    Vector3 corners[8];
+    for (const Frustum& query : queries.frustums)
+    {
+        query.getCorners(corners);
+        BoundingBox region(corners[0], corners[0]);
+        for (size_t i = 1; i < 8; ++i)
+        {
+            region.min.set(std::min(region.min.x, corners[i].x), std::min(region.min.y, corners[i].y), std::min(region.min.z, corners[i].z));
+            region.max.set(std::max(region.max.x, corners[i].x), std::max(region.max.y, corners[i].y), std::max(region.max.z, corners[i].z));
+        }
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (objects.boxes[i].intersects(region) && query.intersects(objects.boxes[i]))
+                results.objects[QUERY_FRUSTUM_IN_BOX].push_back(objects.objects[i]);
+        }
+        results.ends[QUERY_FRUSTUM_IN_BOX].push_back(results.objects[QUERY_FRUSTUM_IN_BOX].size());
+    }
+
+    start = std::chrono::high_resolution_clock::now();
+    for (const Ray& query : queries.rays)
+    {
+        float nearest = std::numeric_limits<float>::max();
+        SceneObject* object = nullptr;
+        for (size_t i = 0; i < count; ++i)
+        {
+            float distance;
+            if (intersectRay(objects.boxes[i], query, nearest, &distance) && distance < nearest)
+            {
+                nearest = distance;
+                object = objects.objects[i];
+            }
+        }
+        if (object)
+            results.objects[QUERY_RAYCAST].push_back(object);
+        results.ends[QUERY_RAYCAST].push_back(results.objects[QUERY_RAYCAST].size());
+        results.distances.push_back(object ? nearest : -1.0f);
+    }
+    results.times[QUERY_RAYCAST] = getMicroseconds(start);
+
+    start = std::chrono::high_resolution_clock::now();
+    for (const Ray& query : queries.rays)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            float distance;
+            if (intersectRay(objects.boxes[i], query, QUERY_BENCHMARK_RAY_LENGTH, &distance))
+                results.objects[QUERY_RAYCAST_ALL].push_back(objects.objects[i]);
+        }
+        results.ends[QUERY_RAYCAST_ALL].push_back(results.objects[QUERY_RAYCAST_ALL].size());
+    }
+    results.times[QUERY_RAYCAST_ALL] = getMicroseconds(start);
+
+    // The distances to the centers are computed the same way as in the indices.
+    const float maxDistanceSquared = QUERY_BENCHMARK_QUERY_SIZE * QUERY_BENCHMARK_QUERY_SIZE;
+    std::vector<std::pair<float, size_t>> nearest;
+    start = std::chrono::high_resolution_clock::now();
+    for (const Vector3& query : queries.points)
+    {
+        nearest.clear();
+        for (size_t i = 0; i < count; ++i)
+        {
+            const BoundingBox& box = objects.boxes[i];
+            float x = (box.min.x + box.max.x) * 0.5f - query.x;
+            float y = (box.min.y + box.max.y) * 0.5f - query.y;
+            float z = (box.min.z + box.max.z) * 0.5f - query.z;
+            float distanceSquared = x * x + y * y + z * z;
+            if (distanceSquared <= maxDistanceSquared)
+                nearest.push_back(std::make_pair(distanceSquared, i));
+        }
+        size_t found = std::min(nearest.size(), (size_t)QUERY_BENCHMARK_NEAREST_COUNT);
+        std::partial_sort(nearest.begin(), nearest.begin() + found, nearest.end());
+        for (size_t i = 0; i < found; ++i)
+        {
+            results.objects[QUERY_NEAREST].push_back(objects.objects[nearest[i].second]);
+        }
+        results.ends[QUERY_NEAREST].push_back(results.objects[QUERY_NEAREST].size());
+    }
+    results.times[QUERY_NEAREST] = getMicroseconds(start);
+}
+
+/**
+ * Runs every query through a spatial index.
+ */
+static void runIndex(SpatialIndex& index, const Queries& queries, QueryResults& results)
+{
+    clearResults(results);
+    uint32_t layerMask = Scene::LAYER_ALL;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (const BoundingBox& query : queries.boxes)
+    {
+        index.query(query, results.objects[QUERY_BOX], layerMask);
+        results.ends[QUERY_BOX].push_back(results.objects[QUERY_BOX].size());
+    }
+    results.times[QUERY_BOX] = getMicroseconds(start);
+
+    start = std::chrono::high_resolution_clock::now();
+    for (const BoundingSphere& query : queries.spheres)
+    {
+        index.query(query, results.objects[QUERY_SPHERE], layerMask);
+        results.ends[QUERY_SPHERE].push_back(results.objects[QUERY_SPHERE].size());
+    }
+    results.times[QUERY_SPHERE] = getMicroseconds(start);
+
+    start = std::chrono::high_resolution_clock::now();
+    for (const Frustum& query : queries.frustums)
+    {
+        index.query(query, results.objects[QUERY_FRUSTUM], layerMask);
+        results.ends[QUERY_FRUSTUM].push_back(results.objects[QUERY_FRUSTUM].size());
+    }
+    results.times[QUERY_FRUSTUM] = getMicroseconds(start);
+
+    start = std::chrono::high_resolution_clock::now();
+    for (const Ray& query : queries.rays)
+    {
+        SpatialIndex::Hit hit;
+        bool found = index.raycast(query, std::numeric_limits<float>::max(), &hit, layerMask);
+        if (found)
+            results.objects[QUERY_RAYCAST].push_back(hit.object);
+        results.ends[QUERY_RAYCAST].push_back(results.objects[QUERY_RAYCAST].size());
+        results.distances.push_back(found ? hit.distance : -1.0f);
+    }
+    results.times[QUERY_RAYCAST] = getMicroseconds(start);
+
+    std::vector<SpatialIndex::Hit> hits;
+    start = std::chrono::high_resolution_clock::now();
+    for (const Ray& query : queries.rays)
+    {
+        hits.clear();
+        index.raycastAll(query, QUERY_BENCHMARK_RAY_LENGTH, hits, layerMask);
+        for (const SpatialIndex::Hit& hit : hits)
+        {
+            results.objects[QUERY_RAYCAST_ALL].push_back(hit.object);
+        }
+        results.ends[QUERY_RAYCAST_ALL].push_back(results.objects[QUERY_RAYCAST_ALL].size());
+    }
+    results.times[QUERY_RAYCAST_ALL] = getMicroseconds(start);
+
+    start = std::chrono::high_resolution_clock::now();
+    for (const Vector3& query : queries.points)
+    {
+        index.queryNearest(query, QUERY_BENCHMARK_NEAREST_COUNT, QUERY_BENCHMARK_QUERY_SIZE, results.objects[QUERY_NEAREST], layerMask);
+        results.ends[QUERY_NEAREST].push_back(results.objects[QUERY_NEAREST].size());
+    }
+    results.times[QUERY_NEAREST] = getMicroseconds(start);
+}
+
+/**
+ * Changes the objects between two runs of the queries. Every tenth object
+ * moves, every hundredth one grows larger than the cells of the grid in the
+ * first round and shrinks back in the next one, and every hundredth one is
+ * removed. Each index is updated in turn and the time it takes is returned.
+ */
+static void changeObjects(size_t round, std::mt19937& random, QueryObjects& objects, std::vector<QueryIndex>& indices, std::vector<double>& times)
+{
+    std::uniform_real_distribution<float> offset(-QUERY_BENCHMARK_SPACING, QUERY_BENCHMARK_SPACING);
+    std::vector<size_t> changed;
+    std::vector<size_t> removed;
+    for (size_t i = 0; i < objects.boxes.size(); ++i)
+    {
+        if (i % 100 == 50)
+        {
+            removed.push_back(i);
+            continue;
+        }
+        if (i % 10 != 0)
+            continue;
+        BoundingBox& box = objects.boxes[i];
+        Vector3 center = box.getCenter() + Vector3(offset(random), offset(random), offset(random));
+        Vector3 extent = (box.max - box.min) * 0.5f;
+        if (i % 100 == 0)
+        {
+            float halfSize = round % 2 == 0 ? QUERY_BENCHMARK_QUERY_SIZE * 4.0f : 0.5f;
+            extent.set(halfSize, halfSize, halfSize);
+        }
+        box.set(center - extent, center + extent);
+        changed.push_back(i);
+    }
+
+    // The removed objects are swapped with the last ones, from the last one
+    // down, so the indices of the objects still to remove don't change.
+    times.clear();
+    for (QueryIndex& index : indices)
+    {
+        std::vector<size_t>& proxies = index.proxies;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (size_t i : changed)
+        {
+            index.index->update(proxies[i], objects.boxes[i]);
+        }
+        for (size_t i = removed.size(); i > 0; --i)
+        {
+            size_t object = removed[i - 1];
+            index.index->remove(proxies[object]);
+            proxies[object] = proxies.back();
+            proxies.pop_back();
+        }
+        times.push_back(getMicroseconds(start) / 1000.0);
+    }
+    for (size_t i = removed.size(); i > 0; --i)
+    {
+        size_t object = removed[i - 1];
+        objects.owners[object] = objects.owners.back();
+        objects.objects[object] = objects.objects.back();
+        objects.boxes[object] = objects.boxes.back();
+        objects.layerMasks[object] = objects.layerMasks.back();
+        objects.owners.pop_back();
+        objects.objects.pop_back();
+        objects.boxes.pop_back();
+        objects.layerMasks.pop_back();
+    }
+}
+
+/**
+ * Counts the queries of a type whose objects differ from brute force.
+ * The objects of each query are sorted first, the order they are found in doesn't matter.
+ */
+static size_t compareResults(QueryResults& reference, size_t referenceType, QueryResults& results, size_t type)
+{
+    size_t mismatches = 0;
+    size_t begin = 0;
+    size_t referenceBegin = 0;
+    for (size_t query = 0; query < reference.ends[referenceType].size(); ++query)
+    {
+        std::vector<SceneObject*>& objects = results.objects[type];
+        std::vector<SceneObject*>& referenceObjects = reference.objects[referenceType];
+        size_t end = results.ends[type][query];
+        size_t referenceEnd = reference.ends[referenceType][query];
+        std::sort(objects.begin() + begin, objects.begin() + end);
+        std::sort(referenceObjects.begin() + referenceBegin, referenceObjects.begin() + referenceEnd);
+        bool same = type == QUERY_RAYCAST ? results.distances[query] == reference.distances[query] :
+            end - begin == referenceEnd - referenceBegin && std::equal(objects.begin() + begin, objects.begin() + end, referenceObjects.begin() + referenceBegin);
+        if (!same)
+            ++mismatches;
+        begin = end;
+        referenceBegin = referenceEnd;
+    }
+    return mismatches;
+}
+
+/**
+ * Compares the results of each index with brute force and prints the queries that differ.
+ */
+static bool checkResults(QueryResults& reference, const std::vector<QueryIndex>& indices, std::vector<QueryResults>& results, size_t queryCount)
+{
+    bool identical = true;
+    for (size_t i = 0; i < indices.size(); ++i)
+    {
+        for (size_t type = 0; type < QUERY_TYPE_COUNT; ++type)
+        {
+            size_t referenceType = type == QUERY_FRUSTUM && indices[i].frustumInBox ? (size_t)QUERY_FRUSTUM_IN_BOX : type;
+            size_t mismatches = compareResults(reference, referenceType, results[i], type);
+            if (mismatches)
+            {
+                printf("MISMATCH: %zu of %zu %s %s queries differ from brute force\n", mismatches, queryCount, indices[i].name, __queryNames[type]);
+                identical = false;
+            }
+        }
+    }
+    return identical;
+}
+
+static void printTimes(const char* name, const QueryResults& results, size_t queryCount)
+{
+    printf("%-12s", name);
+    for (size_t type = 0; type < QUERY_TYPE_COUNT; ++type)
+    {
+        printf(" %11.2f", results.times[type] / (double)queryCount);
+    }
+    printf("\n");
+}
+
+int runQueryBenchmark(int argc, char** argv)
+{
+    size_t queryCount = argc > 0 ? (size_t)std::max(atoi(argv[0]), 1) : QUERY_BENCHMARK_QUERY_COUNT;
+    std::vector<size_t> objectCounts;
+    for (int i = 1; i < argc; ++i)
+    {
+        objectCounts.push_back((size_t)std::max(atoi(argv[i]), 1));
+    }
+    if (objectCounts.empty())
+        objectCounts = { 10000, 100000, 1000000 };
+
+    bool identical = true;
+    for (size_t objectCount : objectCounts)
+    {
+        // Each run is seeded by its count, so it is the same every time.
+        std::mt19937 random((unsigned int)objectCount);
+        QueryObjects objects;
+        float size = createObjects(objectCount, random, objects);
+        Queries queries;
+        createQueries(queryCount, size, random, queries);
+
+        QueryResults reference;
+        runBruteForce(objects, queries, reference);
+
+        // Both indices are built from all the objects at once.
+        std::vector<QueryIndex> indices(2);
+        indices[0].name = "bvh";
+        indices[0].index.reset(new BoundingVolumeHierarchy());
+        indices[0].frustumInBox = false;
+        indices[1].name = "grid";
+        indices[1].index.reset(new SpatialHashGrid());
+        indices[1].frustumInBox = true;
+        std::vector<QueryResults> results(indices.size());
+        printf("%zu objects, %zu queries, microseconds per query\n", objectCount, queryCount);
+        for (QueryIndex& index : indices)
+        {
+            auto start = std::chrono::high_resolution_clock::now();
+            index.index->insert(objects.objects, objects.boxes, objects.layerMasks, index.proxies);
+            printf("%s built in %.2f ms\n", index.name, getMicroseconds(start) / 1000.0);
+        }
+        printf("%-12s", "");
+        for (size_t type = 0; type < QUERY_TYPE_COUNT; ++type)
+        {
+            printf(" %11s", __queryNames[type]);
+        }
+        printf("\n");
+        printTimes("brute force", reference, queryCount);
+        for (size_t i = 0; i < indices.size(); ++i)
+        {
+            runIndex(*indices[i].index, queries, results[i]);
+            printTimes(indices[i].name, results[i], queryCount);
+        }
+        for (size_t i = 0; i < indices.size(); ++i)
+        {
+            printf("%-12s", (std::string(indices[i].name) + " speedup").c_str());
+            for (size_t type = 0; type < QUERY_TYPE_COUNT; ++type)
+            {
+                printf(" %10.1fx", reference.times[type] / results[i].times[type]);
+            }
+            printf("\n");
+        }
+        identical &= checkResults(reference, indices, results, queryCount);
+
+        // The queries are checked again after the objects changed in each index.
+        std::vector<double> times;
+        for (size_t round = 0; round < QUERY_BENCHMARK_CHANGE_ROUNDS; ++round)
+        {
+            changeObjects(round, random, objects, indices, times);
+            printf("changed %s objects:", round % 2 == 0 ? "and grew" : "and shrank");
+            for (size_t i = 0; i < indices.size(); ++i)
+            {
+                printf(" %s %.2f ms", indices[i].name, times[i]);
+            }
+            printf("\n");
+            runBruteForce(objects, queries, reference);
+            for (size_t i = 0; i < indices.size(); ++i)
+            {
+                runIndex(*indices[i].index, queries, results[i]);
+            }
+            identical &= checkResults(reference, indices, results, queryCount);
+        }
+        printf("\n");
+    }
+    printf("%s\n", identical ? "All the queries match brute force." : "Some queries differ from brute force.");
+    return identical ? 0 : 1;
+}
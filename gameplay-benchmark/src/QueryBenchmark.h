@@ -0,0 +1,14 @@
+#pragma once
+
+/**
+ * Runs the spatial queries of the scene indices against brute force tests
+ * of every object, at each object count, and checks that they find the
+ * same objects.
+ *
+ * Usage: gameplay-benchmark queries [queries] [objects...]
+ *
+ * @param argc The number of arguments after "queries".
+ * @param argv The arguments after "queries".
+ * @return 0 if every query matched brute force, 1 if not.
+ */
+int runQueryBenchmark(int argc, char** argv);
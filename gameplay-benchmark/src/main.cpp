@@ -0,0 +1,119 @@
+#include "Base.h"
+#include "SceneObject.h"
+#include "ThreadPool.h"
+#include "QueryBenchmark.h"
+#include "CullingBenchmark.h"
+#include "FindBenchmark.h"
+#include "MatrixBenchmark.h"
+#include <chrono>
+
+using namespace gameplay;
+
+#define BENCHMARK_OBJECT_COUNT 100000
+#define BENCHMARK_FRAME_COUNT 100
+#define BENCHMARK_FAN_OUT 8
+
+/**
+ * Builds a hierarchy of objects with BENCHMARK_FAN_OUT children per object,
+ * filled level by level, with an offset and a rotation on each object.
+ */
+static std::shared_ptr<SceneObject> createHierarchy(size_t count, std::vector<std::shared_ptr<SceneObject>>& objects)
+{
+    objects.clear();
+    objects.reserve(count);
+    std::shared_ptr<SceneObject> root = std::make_shared<SceneObject>();
+    objects.push_back(root);
+    for (size_t i = 1; i < count; ++i)
+    {
+        std::shared_ptr<SceneObject> object = std::make_shared<SceneObject>();
+        float angle = (float)(i % 360) * 0.01f;
+        object->setLocalPosition(Vector3((float)(i % 7) - 3.0f, 0.5f, (float)(i % 5) - 2.0f));
+        object->setLocalEulerAngles(Vector3(angle, angle * 0.5f, 0.0f));
+        objects[(i - 1) / BENCHMARK_FAN_OUT]->addChild(object);
+        objects.push_back(object);
+    }
+    root->getScene()->updateTransforms();
+    return root;
+}
+
+/**
+ * Moves the root every frame, so the whole hierarchy is updated, and
+ * returns the average time of Scene::updateTransforms in milliseconds.
+ */
+static double runFrames(std::shared_ptr<SceneObject> root, size_t frameCount)
+{
+    std::shared_ptr<Scene> scene = root->getScene();
+    double total = 0.0;
+    for (size_t frame = 0; frame < frameCount; ++frame)
+    {
+        root->setLocalEulerAngles(Vector3(0.0f, (float)frame * 0.01f, 0.0f));
+        auto start = std::chrono::high_resolution_clock::now();
+        scene->updateTransforms();
+        total += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    }
+    return total / (double)frameCount;
+}
+
+/**
+ * Runs Scene::updateTransforms on a large hierarchy with thread pools of
+ * 1 to N threads and checks that every world transform is the same as
+ * with the serial update.
+ *
+ * Usage: gameplay-benchmark [objects] [frames] [maxThreads]
+ *
+ * maxThreads defaults to the number of hardware threads.
+ * With "queries", "culling", "find" or "matrices" as the first argument it runs
+ * the spatial query, frustum culling, name search or matrix kernel benchmark instead.
+ */
+int main(int argc, char** argv)
+{
+    if (argc > 1 && strcmp(argv[1], "queries") == 0)
+        return runQueryBenchmark(argc - 2, argv + 2);
+    if (argc > 1 && strcmp(argv[1], "culling") == 0)
+        return runCullingBenchmark(argc - 2, argv + 2);
+    if (argc > 1 && strcmp(argv[1], "find") == 0)
+        return runFindBenchmark(argc - 2, argv + 2);
+    if (argc > 1 && strcmp(argv[1], "matrices") == 0)
+        return runMatrixBenchmark(argc - 2, argv + 2);
+
+    size_t objectCount = argc > 1 ? (size_t)std::max(atoi(argv[1]), 1) : BENCHMARK_OBJECT_COUNT;
+    size_t frameCount = argc > 2 ? (size_t)std::max(atoi(argv[2]), 1) : BENCHMARK_FRAME_COUNT;
+    size_t maxThreads = argc > 3 ? (size_t)std::max(atoi(argv[3]), 1) : std::max((size_t)std::thread::hardware_concurrency(), (size_t)1);
+
+    std::vector<std::shared_ptr<SceneObject>> objects;
+    std::shared_ptr<SceneObject> root = createHierarchy(objectCount, objects);
+
+    // The serial update gives the reference transforms.
+    double serialTime = runFrames(root, frameCount);
+    std::vector<AffineTransform> reference(objects.size());
+    for (size_t i = 0; i < objects.size(); ++i)
+    {
+        reference[i] = objects[i]->getWorldTransform();
+    }
+    printf("%zu objects, %zu frames\n", objectCount, frameCount);
+    printf("serial:     %8.3f ms\n", serialTime);
+
+    bool identical = true;
+    for (size_t threadCount = 1; threadCount <= maxThreads; ++threadCount)
+    {
+        // The same hierarchy is rebuilt so each run starts from the same state.
+        root = createHierarchy(objectCount, objects);
+        root->getScene()->setThreadPool(std::make_shared<ThreadPool>(threadCount));
+        double time = runFrames(root, frameCount);
+
+        size_t mismatches = 0;
+        for (size_t i = 0; i < objects.size(); ++i)
+        {
+            if (memcmp(objects[i]->getWorldTransform().m, reference[i].m, sizeof(reference[i].m)) != 0)
+                ++mismatches;
+        }
+        printf("%2zu threads: %8.3f ms  %5.2fx  %s\n", threadCount, time, serialTime / time, mismatches ? "MISMATCH" : "identical");
+        if (mismatches)
+        {
+            printf("            %zu of %zu world transforms differ from the serial update\n", mismatches, objects.size());
+            identical = false;
+        }
+        root->getScene()->setThreadPool(nullptr);
+    }
+    return identical ? 0 : 1;
+}
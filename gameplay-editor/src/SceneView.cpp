@@ -6,6 +6,7 @@
 
 #define SCENE_OBJECT_NAME "object"
 #define SCENE_EXT ".scene"
+#define SCENE_SELECTION_DRAG_SIZE 4.0f
 
 SceneView::SceneView(QWidget* parent) : QWidget(parent),
     _ui(new Ui::SceneView),
@@ -35,6 +36,7 @@ SceneView::SceneView(QWidget* parent) : QWidget(parent),
 
     connect(_ui->lineEditSearch, SIGNAL(textChanged(QString)), this, SLOT(onSearchTextChanged(QString)));
     connect(_sceneModel, SIGNAL(dataChanged(QModelIndex,QModelIndex)), this, SLOT(onModelDataChanged(QModelIndex, QModelIndex)));
+    connect(_sceneModel, SIGNAL(rowsAboutToBeRemoved(QModelIndex,int,int)), this, SLOT(onModelRowsAboutToBeRemoved(QModelIndex, int, int)));
     connect(_ui->treeView->selectionModel(), SIGNAL(selectionChanged(QItemSelection, QItemSelection)), this, SLOT(onModelSelectionChanged(QItemSelection, QItemSelection)));
 }
 
@@ -58,6 +60,11 @@ std::list<QStandardItem*>* SceneView::getSelectedItems() const
 
 void SceneView::onSceneChanged()
 {
+    // The items of the previous scene are removed along with their objects
+    _sceneModel->removeRows(0, _sceneModel->rowCount());
+    _selectedItems->clear();
+    _objectItems.clear();
+
     _scene = _editor->getScene();
     QStandardItem* item = createHierarchy(_scene);
     item->setEditable(false);
@@ -73,11 +80,54 @@ void SceneView::onEditorSelectionChanged()
 {
     gameplay::Vector2* selectionBegin = _editor->getSelectionBegin();
     gameplay::Vector2* selectedEnd = _editor->getSelectionEnd();
+    gameplay::Game* game = gameplay::Game::getInstance();
+    std::shared_ptr<gameplay::Camera> camera = game->getCamera();
+    if (!_scene || !camera)
+        return;
 
-    // TODO:
-    // Project the point or region against all the objects in the scene
-    // updating the selected objects list.
+    // The queries go through the spatial index of the scene,
+    // so only the objects near the point or region are tested.
+    std::vector<gameplay::SceneObject*> objects;
+    if (selectionBegin)
+    {
+        std::shared_ptr<gameplay::Scene> scene = _scene->getScene();
+        gameplay::Rectangle viewport(0.0f, 0.0f, (float)game->getWidth(), (float)game->getHeight());
+        float width = selectedEnd ? std::fabs(selectedEnd->x - selectionBegin->x) : 0.0f;
+        float height = selectedEnd ? std::fabs(selectedEnd->y - selectionBegin->y) : 0.0f;
+        if (width >= SCENE_SELECTION_DRAG_SIZE && height >= SCENE_SELECTION_DRAG_SIZE)
+        {
+            gameplay::Rectangle region(std::min(selectionBegin->x, selectedEnd->x), std::min(selectionBegin->y, selectedEnd->y), width, height);
+            gameplay::Frustum frustum;
+            camera->pickFrustum(viewport, region, &frustum);
+            scene->queryObjects(frustum, objects);
+        }
+        else
+        {
+            gameplay::Ray ray;
+            camera->pickRay(viewport, selectionBegin->x, selectionBegin->y, &ray);
+            gameplay::SpatialIndex::Hit hit;
+            if (scene->raycast(ray, &hit))
+                objects.push_back(hit.object);
+        }
+    }
+    selectObjects(objects);
+}
 
+void SceneView::selectObjects(const std::vector<gameplay::SceneObject*>& objects)
+{
+    // The tree selection is replaced at once, which updates the selected items.
+    // The objects hidden by the search filter are left out.
+    QItemSelection selection;
+    for (gameplay::SceneObject* object : objects)
+    {
+        auto itr = _objectItems.find(object);
+        if (itr == _objectItems.end())
+            continue;
+        QModelIndex index = _sortFilter->mapFromSource(itr->second->index());
+        if (index.isValid())
+            selection.select(index, index);
+    }
+    _ui->treeView->selectionModel()->select(selection, QItemSelectionModel::ClearAndSelect);
 }
 
 void SceneView::onModelSelectionChanged(const QItemSelection& selected, const QItemSelection& deselected)
@@ -108,6 +158,17 @@ void SceneView::onModelDataChanged(const QModelIndex& topLeft, const QModelIndex
     emit selectionChanged();
 }
 
+void SceneView::onModelRowsAboutToBeRemoved(const QModelIndex& parent, int first, int last)
+{
+    QStandardItem* parentItem = parent.isValid() ? _sceneModel->itemFromIndex(parent) : _sceneModel->invisibleRootItem();
+    for (int row = first; row <= last; ++row)
+    {
+        QStandardItem* item = parentItem->child(row);
+        if (item)
+            eraseItems(item);
+    }
+}
+
 QStandardItem* SceneView::createItem(std::shared_ptr<gameplay::SceneObject> object)
 {
     QString text;
@@ -121,6 +182,7 @@ QStandardItem* SceneView::createItem(std::shared_ptr<gameplay::SceneObject> obje
     item->setEditable(true);
     // Associate the object to the item
     item->setData(QVariant::fromValue((qlonglong)object.get()), Qt::UserRole + 1);
+    _objectItems[object.get()] = item;
 
     return item;
 }
@@ -137,7 +199,7 @@ QStandardItem* SceneView::createHierarchy(std::shared_ptr<gameplay::SceneObject>
 
 void SceneView::visitorAddItem(std::shared_ptr<gameplay::SceneObject> parent, QStandardItem* parentItem)
 {
-    auto children = parent->getChildren();
+    const auto& children = parent->getChildren();
     for (auto object : children)
     {
         QStandardItem* item = createHierarchy(object);
@@ -145,6 +207,15 @@ void SceneView::visitorAddItem(std::shared_ptr<gameplay::SceneObject> parent, QS
     }
 }
 
+void SceneView::eraseItems(QStandardItem* item)
+{
+    // Forget the objects of the item and its children so the map doesn't keep stale pointers
+    _objectItems.erase((gameplay::SceneObject*)item->data(Qt::UserRole + 1).toLongLong());
+    _selectedItems->remove(item);
+    for (int row = 0; row < item->rowCount(); ++row)
+        eraseItems(item->child(row));
+}
+
 void SceneView::addToHiearchy(std::shared_ptr<gameplay::SceneObject> object, QStandardItem* item)
 {
     // If there is no object selected the just add to the scene
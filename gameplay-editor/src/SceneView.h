@@ -56,6 +56,9 @@ public slots:
 
     /**
      * Handler for when the editor selection points change.
+     *
+     * A click selects the nearest object under the point and a drag selects
+     * the objects within the rectangle, both through the spatial queries of the scene.
      */
     void onEditorSelectionChanged();
 
@@ -69,6 +72,11 @@ public slots:
      */
     void onModelDataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight);
 
+    /**
+     * @see QAbstractItemModel::rowsAboutToBeRemoved
+     */
+    void onModelRowsAboutToBeRemoved(const QModelIndex& parent, int first, int last);
+
     /**
      * Handler for when the search filter text changes.
      *
@@ -99,6 +107,8 @@ private:
     QStandardItem* createHierarchy(std::shared_ptr<gameplay::SceneObject> object);
     void visitorAddItem(std::shared_ptr<gameplay::SceneObject> parent, QStandardItem* parentItem);
     void addToHiearchy(std::shared_ptr<gameplay::SceneObject> object, QStandardItem* item);
+    void eraseItems(QStandardItem* item);
+    void selectObjects(const std::vector<gameplay::SceneObject*>& objects);
 
     Ui::SceneView* _ui;
     EditorWindow* _editor;
@@ -106,4 +116,5 @@ private:
     QStandardItemModel* _sceneModel;
     SceneSortFilterProxyModel* _sortFilter;
     std::list<QStandardItem*>* _selectedItems;
+    std::unordered_map<gameplay::SceneObject*, QStandardItem*> _objectItems;
 };
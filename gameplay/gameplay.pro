@@ -7,12 +7,15 @@ CONFIG -= qt
 CONFIG(debug, debug|release): DEFINES += _DEBUG
 
 SOURCES += \
+    src/AffineTransform.cpp \
     src/Animation.cpp \
+    src/Arena.cpp \
     src/Audio.cpp \
     src/AudioListener.cpp \
     src/AudioSource.cpp \
     src/BoundingBox.cpp \
     src/BoundingSphere.cpp \
+    src/BoundingVolumeHierarchy.cpp \
     src/Camera.cpp \
     src/Component.cpp \
     src/Curve.cpp \
@@ -28,6 +31,7 @@ SOURCES += \
     src/Material.cpp \
     src/MathUtil.cpp \
     src/Matrix.cpp \
+    src/OcclusionCuller.cpp \
     src/Physics.cpp \
     src/PhysicsCollider.cpp \
     src/PhysicsJoint.cpp \
@@ -37,23 +41,32 @@ SOURCES += \
     src/Ray.cpp \
     src/Rectangle.cpp \
     src/Renderer.cpp \
+    src/RendererLod.cpp \
+    src/Scene.cpp \
     src/SceneObject.cpp \
+    src/SceneObjectHandle.cpp \
     src/Script.cpp \
     src/Serializer.cpp \
     src/SerializerBinary.cpp \
     src/SerializerJson.cpp \
+    src/SpatialHashGrid.cpp \
+    src/SpatialIndex.cpp \
+    src/ThreadPool.cpp \
     src/Vector2.cpp \
     src/Vector3.cpp \
     src/Vector4.cpp
 
 HEADERS += \
+    src/AffineTransform.h \
     src/Animation.h \
+    src/Arena.h \
     src/Audio.h \
     src/AudioListener.h \
     src/AudioSource.h \
     src/Base.h \
     src/BoundingBox.h \
     src/BoundingSphere.h \
+    src/BoundingVolumeHierarchy.h \
     src/Camera.h \
     src/Component.h \
     src/Curve.h \
@@ -68,7 +81,12 @@ HEADERS += \
     src/Logger.h \
     src/Material.h \
     src/MathUtil.h \
+    src/MathUtilAVX.inl \
+    src/MathUtilNeon.inl \
+    src/MathUtilScalar.inl \
+    src/MathUtilSSE.inl \
     src/Matrix.h \
+    src/OcclusionCuller.h \
     src/Physics.h \
     src/PhysicsCollider.h \
     src/PhysicsJoint.h \
@@ -79,12 +97,18 @@ HEADERS += \
     src/Ray.h \
     src/Rectangle.h \
     src/Renderer.h \
+    src/RendererLod.h \
+    src/Scene.h \
     src/SceneObject.h \
+    src/SceneObjectHandle.h \
     src/Script.h \
     src/Serializer.h \
     src/SerializerBinary.h \
     src/SerializerJson.h \
+    src/SpatialHashGrid.h \
+    src/SpatialIndex.h \
     src/Stream.h \
+    src/ThreadPool.h \
     src/Vector2.h \
     src/Vector3.h \
     src/Vector4.h
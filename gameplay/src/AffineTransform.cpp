@@ -0,0 +1,254 @@
+#include "Base.h"
+#include "AffineTransform.h"
+#include "MathUtil.h"
+
+#define AFFINETRANSFORM_SIZE (sizeof(float) * 12)
+
+namespace gameplay
+{
+
+AffineTransform::AffineTransform()
+{
+    setIdentity();
+}
+
+AffineTransform::AffineTransform(const Vector3& t, const Quaternion& r, const Vector3& s)
+{
+    set(t, r, s);
+}
+
+AffineTransform::AffineTransform(const Matrix& matrix)
+{
+    set(matrix);
+}
+
+AffineTransform::AffineTransform(const AffineTransform& copy)
+{
+    std::memcpy(m, copy.m, AFFINETRANSFORM_SIZE);
+}
+
+AffineTransform::~AffineTransform()
+{
+}
+
+const AffineTransform& AffineTransform::identity()
+{
+    static AffineTransform a;
+    return a;
+}
+
+void AffineTransform::multiply(const AffineTransform& a1, const AffineTransform& a2, AffineTransform* dst)
+{
+    GP_ASSERT(dst);
+    MathUtil::multiplyAffine(a1.m, a2.m, dst->m);
+}
+
+void AffineTransform::multiply(const AffineTransform& a)
+{
+    multiply(*this, a, this);
+}
+
+bool AffineTransform::invert()
+{
+    return invert(this);
+}
+
+bool AffineTransform::invert(AffineTransform* dst) const
+{
+    GP_ASSERT(dst);
+
+    // Invert the 3x3 part with its cofactors.
+    float c0 = m[4] * m[8] - m[5] * m[7];
+    float c1 = m[2] * m[7] - m[1] * m[8];
+    float c2 = m[1] * m[5] - m[2] * m[4];
+    float det = m[0] * c0 + m[3] * c1 + m[6] * c2;
+
+    // Close to zero, can't invert.
+    if (std::fabs(det) <= GP_MATH_TOLERANCE)
+        return false;
+
+    // Everything is read before writing to support dst being this transform.
+    float invDet = 1.0f / det;
+    float i0 = c0 * invDet;
+    float i1 = c1 * invDet;
+    float i2 = c2 * invDet;
+    float i3 = (m[5] * m[6] - m[3] * m[8]) * invDet;
+    float i4 = (m[0] * m[8] - m[2] * m[6]) * invDet;
+    float i5 = (m[2] * m[3] - m[0] * m[5]) * invDet;
+    float i6 = (m[3] * m[7] - m[4] * m[6]) * invDet;
+    float i7 = (m[1] * m[6] - m[0] * m[7]) * invDet;
+    float i8 = (m[0] * m[4] - m[1] * m[3]) * invDet;
+    float tx = m[9];
+    float ty = m[10];
+    float tz = m[11];
+
+    float* d = dst->m;
+    d[0] = i0;
+    d[1] = i1;
+    d[2] = i2;
+    d[3] = i3;
+    d[4] = i4;
+    d[5] = i5;
+    d[6] = i6;
+    d[7] = i7;
+    d[8] = i8;
+
+    // The translation is the negated translation rotated by the inverse.
+    d[9]  = -(i0 * tx + i3 * ty + i6 * tz);
+    d[10] = -(i1 * tx + i4 * ty + i7 * tz);
+    d[11] = -(i2 * tx + i5 * ty + i8 * tz);
+    return true;
+}
+
+void AffineTransform::invertRigid()
+{
+    invertRigid(this);
+}
+
+void AffineTransform::invertRigid(AffineTransform* dst) const
+{
+    GP_ASSERT(dst);
+
+    // Everything is read before writing to support dst being this transform.
+    float r0 = m[0], r1 = m[1], r2 = m[2];
+    float r3 = m[3], r4 = m[4], r5 = m[5];
+    float r6 = m[6], r7 = m[7], r8 = m[8];
+    float tx = m[9];
+    float ty = m[10];
+    float tz = m[11];
+
+    // The inverse of a rotation is its transpose.
+    float* d = dst->m;
+    d[0] = r0;
+    d[1] = r3;
+    d[2] = r6;
+    d[3] = r1;
+    d[4] = r4;
+    d[5] = r7;
+    d[6] = r2;
+    d[7] = r5;
+    d[8] = r8;
+    d[9]  = -(r0 * tx + r1 * ty + r2 * tz);
+    d[10] = -(r3 * tx + r4 * ty + r5 * tz);
+    d[11] = -(r6 * tx + r7 * ty + r8 * tz);
+}
+
+void AffineTransform::set(const Vector3& t, const Quaternion& r, const Vector3& s)
+{
+    float x2 = r.x + r.x;
+    float y2 = r.y + r.y;
+    float z2 = r.z + r.z;
+    float xx = r.x * x2;
+    float xy = r.x * y2;
+    float xz = r.x * z2;
+    float yy = r.y * y2;
+    float yz = r.y * z2;
+    float zz = r.z * z2;
+    float wx = r.w * x2;
+    float wy = r.w * y2;
+    float wz = r.w * z2;
+
+    m[0] = (1 - (yy + zz)) * s.x;
+    m[1] = (xy + wz) * s.x;
+    m[2] = (xz - wy) * s.x;
+    m[3] = (xy - wz) * s.y;
+    m[4] = (1 - (xx + zz)) * s.y;
+    m[5] = (yz + wx) * s.y;
+    m[6] = (xz + wy) * s.z;
+    m[7] = (yz - wx) * s.z;
+    m[8] = (1 - (xx + yy)) * s.z;
+    m[9] = t.x;
+    m[10] = t.y;
+    m[11] = t.z;
+}
+
+void AffineTransform::set(const Matrix& matrix)
+{
+    for (size_t i = 0; i < 4; ++i)
+    {
+        m[i * 3] = matrix.m[i * 4];
+        m[i * 3 + 1] = matrix.m[i * 4 + 1];
+        m[i * 3 + 2] = matrix.m[i * 4 + 2];
+    }
+}
+
+void AffineTransform::setIdentity()
+{
+    std::memset(m, 0, AFFINETRANSFORM_SIZE);
+    m[0] = 1.0f;
+    m[4] = 1.0f;
+    m[8] = 1.0f;
+}
+
+void AffineTransform::getMatrix(Matrix* dst) const
+{
+    GP_ASSERT(dst);
+    dst->set(m[0], m[3], m[6], m[9],
+             m[1], m[4], m[7], m[10],
+             m[2], m[5], m[8], m[11],
+             0.0f, 0.0f, 0.0f, 1.0f);
+}
+
+Matrix AffineTransform::getMatrix() const
+{
+    Matrix matrix;
+    getMatrix(&matrix);
+    return matrix;
+}
+
+Vector3 AffineTransform::getTranslation() const
+{
+    return Vector3(m[9], m[10], m[11]);
+}
+
+Vector3 AffineTransform::getX() const
+{
+    return Vector3(m[0], m[1], m[2]);
+}
+
+Vector3 AffineTransform::getY() const
+{
+    return Vector3(m[3], m[4], m[5]);
+}
+
+Vector3 AffineTransform::getZ() const
+{
+    return Vector3(m[6], m[7], m[8]);
+}
+
+void AffineTransform::transformPoint(const Vector3& p, Vector3* dst) const
+{
+    GP_ASSERT(dst);
+    float x = p.x * m[0] + p.y * m[3] + p.z * m[6] + m[9];
+    float y = p.x * m[1] + p.y * m[4] + p.z * m[7] + m[10];
+    float z = p.x * m[2] + p.y * m[5] + p.z * m[8] + m[11];
+    dst->set(x, y, z);
+}
+
+void AffineTransform::transformVector(const Vector3& v, Vector3* dst) const
+{
+    GP_ASSERT(dst);
+    float x = v.x * m[0] + v.y * m[3] + v.z * m[6];
+    float y = v.x * m[1] + v.y * m[4] + v.z * m[7];
+    float z = v.x * m[2] + v.y * m[5] + v.z * m[8];
+    dst->set(x, y, z);
+}
+
+AffineTransform& AffineTransform::operator=(const AffineTransform& a)
+{
+    if (&a != this)
+        std::memcpy(m, a.m, AFFINETRANSFORM_SIZE);
+    return *this;
+}
+
+bool AffineTransform::operator==(const AffineTransform& a) const
+{
+    return std::memcmp(m, a.m, AFFINETRANSFORM_SIZE) == 0;
+}
+
+bool AffineTransform::operator!=(const AffineTransform& a) const
+{
+    return !(*this == a);
+}
+
+}
@@ -0,0 +1,232 @@
+#pragma once
+
+#include "Vector3.h"
+#include "Quaternion.h"
+#include "Matrix.h"
+
+namespace gameplay
+{
+
+/**
+ * Defines a compact 3 x 4 floating point matrix representing an affine 3D transformation.
+ *
+ * The fourth row of an affine matrix is always (0, 0, 0, 1), so it is not
+ * stored and the math skips it. This makes the transform 25% smaller than
+ * a Matrix and composing two transforms takes 36 multiplies instead of 64.
+ *
+ * The values are stored in column-major order like Matrix, with the
+ * translation in the last column:
+ *
+ *     0   3   6   9
+ *     1   4   7   10
+ *     2   5   8   11
+ *
+ * Use getMatrix to convert it to a Matrix when combining it with a projection.
+ */
+class AffineTransform
+{
+public:
+
+    /**
+     * The column major values of this 3x4 matrix.
+     */
+    float m[12];
+
+    /**
+     * Constructor.
+     *
+     * The transform is initialized to the identity.
+     */
+    AffineTransform();
+
+    /**
+     * Constructor.
+     *
+     * @param t The translation.
+     * @param r The rotation.
+     * @param s The scale.
+     */
+    AffineTransform(const Vector3& t, const Quaternion& r, const Vector3& s);
+
+    /**
+     * Constructor.
+     *
+     * The fourth row of the matrix is ignored.
+     *
+     * @param matrix The affine matrix to copy.
+     */
+    AffineTransform(const Matrix& matrix);
+
+    /**
+     * Constructor.
+     *
+     * @param copy The transform to copy.
+     */
+    AffineTransform(const AffineTransform& copy);
+
+    /**
+     * Destructor.
+     */
+    ~AffineTransform();
+
+    /**
+     * Gets the identity transform.
+     *
+     * @return The identity transform.
+     */
+    static const AffineTransform& identity();
+
+    /**
+     * Multiplies two transforms.
+     *
+     * The result applies a2 first and then a1, like Matrix::multiply.
+     *
+     * @param a1 The first transform.
+     * @param a2 The second transform.
+     * @param dst A transform to store the result in.
+     */
+    static void multiply(const AffineTransform& a1, const AffineTransform& a2, AffineTransform* dst);
+
+    /**
+     * Post-multiplies this transform by the specified one.
+     *
+     * @param a The transform to multiply by.
+     */
+    void multiply(const AffineTransform& a);
+
+    /**
+     * Inverts this transform.
+     *
+     * @return true if the transform can be inverted, false otherwise.
+     */
+    bool invert();
+
+    /**
+     * Stores the inverse of this transform in the specified transform.
+     *
+     * @param dst A transform to store the inverse of this transform in.
+     * @return true if the transform can be inverted, false otherwise.
+     */
+    bool invert(AffineTransform* dst) const;
+
+    /**
+     * Inverts this transform assuming it is rigid.
+     *
+     * A rigid transform only translates and rotates, so its inverse is the
+     * transposed rotation applied to the negated translation.
+     * The result is wrong if the transform contains a scale.
+     */
+    void invertRigid();
+
+    /**
+     * Stores the inverse of this transform in the specified transform assuming it is rigid.
+     *
+     * @param dst A transform to store the inverse of this transform in.
+     * @see invertRigid
+     */
+    void invertRigid(AffineTransform* dst) const;
+
+    /**
+     * Sets the transform from a translation, rotation and scale.
+     *
+     * @param t The translation.
+     * @param r The rotation.
+     * @param s The scale.
+     */
+    void set(const Vector3& t, const Quaternion& r, const Vector3& s);
+
+    /**
+     * Sets the transform from a matrix.
+     *
+     * The fourth row of the matrix is ignored.
+     *
+     * @param matrix The affine matrix to copy.
+     */
+    void set(const Matrix& matrix);
+
+    /**
+     * Sets this transform to the identity.
+     */
+    void setIdentity();
+
+    /**
+     * Gets the 4 x 4 matrix for this transform.
+     *
+     * @param dst A matrix to store the result in.
+     */
+    void getMatrix(Matrix* dst) const;
+
+    /**
+     * Gets the 4 x 4 matrix for this transform.
+     *
+     * @return The matrix for this transform.
+     */
+    Matrix getMatrix() const;
+
+    /**
+     * Gets the translational component of this transform.
+     *
+     * @return The translation.
+     */
+    Vector3 getTranslation() const;
+
+    /**
+     * Gets the x-axis (first column) of this transform.
+     *
+     * @return The x-axis.
+     */
+    Vector3 getX() const;
+
+    /**
+     * Gets the y-axis (second column) of this transform.
+     *
+     * @return The y-axis.
+     */
+    Vector3 getY() const;
+
+    /**
+     * Gets the z-axis (third column) of this transform.
+     *
+     * @return The z-axis.
+     */
+    Vector3 getZ() const;
+
+    /**
+     * Transforms the specified point by this transform.
+     *
+     * @param p The point to transform.
+     * @param dst A vector to store the transformed point in.
+     */
+    void transformPoint(const Vector3& p, Vector3* dst) const;
+
+    /**
+     * Transforms the specified vector by this transform, ignoring the translation.
+     *
+     * @param v The vector to transform.
+     * @param dst A vector to store the transformed vector in.
+     */
+    void transformVector(const Vector3& v, Vector3* dst) const;
+
+    /**
+     * operator =
+     */
+    AffineTransform& operator=(const AffineTransform& a);
+
+    /**
+     * Determines if this transform is equal to the given transform.
+     *
+     * @param a The transform to compare against.
+     * @return True if this transform is equal to the given transform, false otherwise.
+     */
+    bool operator==(const AffineTransform& a) const;
+
+    /**
+     * Determines if this transform is not equal to the given transform.
+     *
+     * @param a The transform to compare against.
+     * @return True if this transform is not equal to the given transform, false otherwise.
+     */
+    bool operator!=(const AffineTransform& a) const;
+};
+
+}
@@ -0,0 +1,65 @@
+#include "Base.h"
+#include "Arena.h"
+
+#define ARENA_BLOCK_SIZE (64 * 1024)
+
+namespace gameplay
+{
+
+Arena::Arena(size_t blockSize) :
+    _current(nullptr),
+    _remaining(0),
+    _blockSize(blockSize > 0 ? blockSize : ARENA_BLOCK_SIZE),
+    _size(0)
+{
+}
+
+Arena::~Arena()
+{
+    for (char* block : _blocks)
+    {
+        ::operator delete(block);
+    }
+}
+
+void* Arena::allocate(size_t size, size_t alignment)
+{
+    GP_ASSERT(alignment > 0 && (alignment & (alignment - 1)) == 0);
+    GP_ASSERT(alignment <= alignof(std::max_align_t));
+
+    // The system allocation is aligned for any type so large
+    // requests get a block of their own and leave the current one.
+    if (size + alignment > _blockSize)
+    {
+        char* block = static_cast<char*>(::operator new(size));
+        _blocks.push_back(block);
+        _size += size;
+        return block;
+    }
+
+    size_t padding = (alignment - ((size_t)_current & (alignment - 1))) & (alignment - 1);
+    if (!_current || padding + size > _remaining)
+    {
+        _current = static_cast<char*>(::operator new(_blockSize));
+        _blocks.push_back(_current);
+        _remaining = _blockSize;
+        padding = 0;
+    }
+    char* p = _current + padding;
+    _current = p + size;
+    _remaining -= padding + size;
+    _size += size;
+    return p;
+}
+
+size_t Arena::getSize() const
+{
+    return _size;
+}
+
+size_t Arena::getBlockCount() const
+{
+    return _blocks.size();
+}
+
+}
@@ -0,0 +1,172 @@
+#pragma once
+
+namespace gameplay
+{
+
+/**
+ * Defines a memory arena that hands out memory from large blocks.
+ *
+ * Allocations bump a pointer through the current block and are never
+ * freed one by one. All the blocks are freed together when the arena is
+ * destroyed, which makes it suited to the many small objects created
+ * when loading a scene. Use ArenaAllocator to create shared objects in it.
+ *
+ * The arena is not thread safe.
+ */
+class Arena
+{
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param blockSize The size in bytes of the blocks allocated from the system.
+     *        Zero uses the default size.
+     */
+    Arena(size_t blockSize = 0);
+
+    /**
+     * Destructor.
+     *
+     * Frees all the memory allocated by the arena.
+     */
+    ~Arena();
+
+    /**
+     * Allocates memory from the arena.
+     *
+     * Requests larger than the block size get a block of their own.
+     *
+     * @param size The number of bytes to allocate.
+     * @param alignment The alignment of the memory, a power of two.
+     * @return The allocated memory.
+     */
+    void* allocate(size_t size, size_t alignment);
+
+    /**
+     * Gets the number of bytes allocated from the arena.
+     *
+     * @return The number of bytes allocated from the arena.
+     */
+    size_t getSize() const;
+
+    /**
+     * Gets the number of blocks allocated from the system.
+     *
+     * @return The number of blocks allocated from the system.
+     */
+    size_t getBlockCount() const;
+
+private:
+
+    Arena(const Arena& copy);
+    Arena& operator=(const Arena& copy);
+
+    std::vector<char*> _blocks;
+    char* _current;
+    size_t _remaining;
+    size_t _blockSize;
+    size_t _size;
+};
+
+/**
+ * Defines a standard allocator that allocates from an arena.
+ *
+ * Deallocation does nothing, the memory is returned when the arena is
+ * destroyed. The allocator keeps the arena alive, so objects created with
+ * std::allocate_shared keep it alive until the last of them is released.
+ */
+template <class T>
+class ArenaAllocator
+{
+public:
+
+    typedef T value_type;
+
+    /**
+     * Constructor.
+     *
+     * @param arena The arena to allocate from.
+     */
+    ArenaAllocator(std::shared_ptr<Arena> arena);
+
+    /**
+     * Constructor from an allocator for another type.
+     *
+     * @param copy The allocator to share the arena of.
+     */
+    template <class U>
+    ArenaAllocator(const ArenaAllocator<U>& copy);
+
+    /**
+     * Allocates memory for objects from the arena.
+     *
+     * @param count The number of objects.
+     * @return The allocated memory.
+     */
+    T* allocate(size_t count);
+
+    /**
+     * Does nothing, the memory is freed with the arena.
+     *
+     * @param p The memory to deallocate.
+     * @param count The number of objects.
+     */
+    void deallocate(T* p, size_t count);
+
+    /**
+     * Gets the arena this allocator allocates from.
+     *
+     * @return The arena this allocator allocates from.
+     */
+    const std::shared_ptr<Arena>& getArena() const;
+
+private:
+
+    std::shared_ptr<Arena> _arena;
+};
+
+template <class T>
+ArenaAllocator<T>::ArenaAllocator(std::shared_ptr<Arena> arena) :
+    _arena(arena)
+{
+    GP_ASSERT(_arena);
+}
+
+template <class T>
+template <class U>
+ArenaAllocator<T>::ArenaAllocator(const ArenaAllocator<U>& copy) :
+    _arena(copy.getArena())
+{
+}
+
+template <class T>
+T* ArenaAllocator<T>::allocate(size_t count)
+{
+    return static_cast<T*>(_arena->allocate(sizeof(T) * count, alignof(T)));
+}
+
+template <class T>
+void ArenaAllocator<T>::deallocate(T*, size_t)
+{
+}
+
+template <class T>
+const std::shared_ptr<Arena>& ArenaAllocator<T>::getArena() const
+{
+    return _arena;
+}
+
+template <class T, class U>
+bool operator==(const ArenaAllocator<T>& a1, const ArenaAllocator<U>& a2)
+{
+    return a1.getArena() == a2.getArena();
+}
+
+template <class T, class U>
+bool operator!=(const ArenaAllocator<T>& a1, const ArenaAllocator<U>& a2)
+{
+    return a1.getArena() != a2.getArena();
+}
+
+}
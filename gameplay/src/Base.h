@@ -23,6 +23,7 @@
 #include <stack>
 #include <map>
 #include <unordered_map>
+#include <unordered_set>
 #include <queue>
 #include <bitset>
 #include <algorithm>
@@ -31,7 +32,11 @@
 #include <functional>
 #include <typeinfo>
 #include <thread>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
 #include <mutex>
+#include <condition_variable>
 #include <chrono>
 #include <typeindex>
 
@@ -136,6 +141,7 @@
 #define GP_GRAPHICS_BACK_BUFFERS		2
 
 #define GP_ASSET_PATH                   "./assets"
+#define GP_THREAD_COUNT                 0
 
 namespace gameplay
 {
@@ -2,6 +2,7 @@
 #include "BoundingBox.h"
 #include "BoundingSphere.h"
 #include "Plane.h"
+#include "AffineTransform.h"
 
 namespace gameplay
 {
@@ -304,13 +305,12 @@ void BoundingBox::transform(const Matrix& matrix)
     Vector3 corners[8];
     getCorners(corners);
 
-    // Transform the corners, recalculating the min and max points along the way.
-    matrix.transformPoint(&corners[0]);
+    // Transform the corners, then recalculate the min and max points.
+    matrix.transformPoints(corners, 8, corners);
     Vector3 newMin = corners[0];
     Vector3 newMax = corners[0];
     for (int i = 1; i < 8; i++)
     {
-        matrix.transformPoint(&corners[i]);
         updateMinMax(&corners[i], &newMin, &newMax);
     }
     this->min.x = newMin.x;
@@ -321,6 +321,27 @@ void BoundingBox::transform(const Matrix& matrix)
     this->max.z = newMax.z;
 }
 
+void BoundingBox::transform(const AffineTransform& transform)
+{
+    const float* m = transform.m;
+    float cx = (min.x + max.x) * 0.5f;
+    float cy = (min.y + max.y) * 0.5f;
+    float cz = (min.z + max.z) * 0.5f;
+    float ex = (max.x - min.x) * 0.5f;
+    float ey = (max.y - min.y) * 0.5f;
+    float ez = (max.z - min.z) * 0.5f;
+
+    // The extent along each world axis is the sum of the absolute projections of the box axes.
+    float x = cx * m[0] + cy * m[3] + cz * m[6] + m[9];
+    float y = cx * m[1] + cy * m[4] + cz * m[7] + m[10];
+    float z = cx * m[2] + cy * m[5] + cz * m[8] + m[11];
+    float rx = ex * std::abs(m[0]) + ey * std::abs(m[3]) + ez * std::abs(m[6]);
+    float ry = ex * std::abs(m[1]) + ey * std::abs(m[4]) + ez * std::abs(m[7]);
+    float rz = ex * std::abs(m[2]) + ey * std::abs(m[5]) + ez * std::abs(m[8]);
+    min.set(x - rx, y - ry, z - rz);
+    max.set(x + rx, y + ry, z + rz);
+}
+
 BoundingBox& BoundingBox::operator=(const BoundingBox& b)
 {
     if(&b == this)
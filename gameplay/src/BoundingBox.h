@@ -5,6 +5,8 @@
 namespace gameplay
 {
 
+class AffineTransform;
+
 /**
  * Defines a 3-dimensional axis-aligned bounding box.
  */
@@ -179,6 +181,16 @@ public:
      */
     void transform(const Matrix& matrix);
 
+    /**
+     * Transforms the bounding box by the given affine transform.
+     *
+     * The result is the box around the transformed box, computed from
+     * the center and the extents without transforming the corners.
+     *
+     * @param transform The affine transform to transform by.
+     */
+    void transform(const AffineTransform& transform);
+
     /**
      * @brief operator=
      */
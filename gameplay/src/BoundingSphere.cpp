@@ -1,6 +1,7 @@
 #include "Base.h"
 #include "BoundingSphere.h"
 #include "BoundingBox.h"
+#include "AffineTransform.h"
 
 namespace gameplay
 {
@@ -301,6 +302,18 @@ void BoundingSphere::transform(const Matrix& matrix)
     radius = r;
 }
 
+void BoundingSphere::transform(const AffineTransform& transform)
+{
+    transform.transformPoint(center, &center);
+
+    // Scale the radius by the longest axis.
+    const float* m = transform.m;
+    float sx = m[0] * m[0] + m[1] * m[1] + m[2] * m[2];
+    float sy = m[3] * m[3] + m[4] * m[4] + m[5] * m[5];
+    float sz = m[6] * m[6] + m[7] * m[7] + m[8] * m[8];
+    radius *= sqrt(std::max(sx, std::max(sy, sz)));
+}
+
 float BoundingSphere::distance(const BoundingSphere& sphere, const Vector3& point)
 {
     return sqrt((point.x - sphere.center.x) * (point.x - sphere.center.x) +
@@ -5,6 +5,8 @@
 namespace gameplay
 {
 
+class AffineTransform;
+
 /**
  * Defines a 3-dimensional bounding sphere.
  */
@@ -150,6 +152,13 @@ public:
      */
     void transform(const Matrix& matrix);
 
+    /**
+     * Transforms the bounding sphere by the given affine transform.
+     *
+     * @param transform The affine transform to transform by.
+     */
+    void transform(const AffineTransform& transform);
+
     /**
      * @brief operator=
      */
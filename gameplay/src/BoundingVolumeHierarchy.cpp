@@ -0,0 +1,806 @@
+#include "Base.h"
+#include "BoundingVolumeHierarchy.h"
+
+#define BVH_MARGIN_DEFAULT 0.1f
+#define BVH_MARGIN_SHRINK_FACTOR 4.0f
+#define BVH_MORTON_BITS 21
+
+namespace gameplay
+{
+
+static float getArea(const BoundingBox& box)
+{
+    float x = box.max.x - box.min.x;
+    float y = box.max.y - box.min.y;
+    float z = box.max.z - box.min.z;
+    return 2.0f * (x * y + y * z + z * x);
+}
+
+static void combine(const BoundingBox& a, const BoundingBox& b, BoundingBox* dst)
+{
+    dst->min.x = std::min(a.min.x, b.min.x);
+    dst->min.y = std::min(a.min.y, b.min.y);
+    dst->min.z = std::min(a.min.z, b.min.z);
+    dst->max.x = std::max(a.max.x, b.max.x);
+    dst->max.y = std::max(a.max.y, b.max.y);
+    dst->max.z = std::max(a.max.z, b.max.z);
+}
+
+static bool equals(const BoundingBox& a, const BoundingBox& b)
+{
+    return a.min.x == b.min.x && a.min.y == b.min.y && a.min.z == b.min.z &&
+           a.max.x == b.max.x && a.max.y == b.max.y && a.max.z == b.max.z;
+}
+
+static bool contains(const BoundingBox& box, const BoundingBox& inner)
+{
+    return box.min.x <= inner.min.x && box.min.y <= inner.min.y && box.min.z <= inner.min.z &&
+           box.max.x >= inner.max.x && box.max.y >= inner.max.y && box.max.z >= inner.max.z;
+}
+
+static void expand(const BoundingBox& box, float margin, BoundingBox* dst)
+{
+    Vector3 offset(margin, margin, margin);
+    dst->set(box.min - offset, box.max + offset);
+}
+
+static uint64_t spreadBits(uint64_t value)
+{
+    // Puts two zero bits between each of the low 21 bits.
+    value &= 0x1fffff;
+    value = (value | value << 32) & 0x1f00000000ffffULL;
+    value = (value | value << 16) & 0x1f0000ff0000ffULL;
+    value = (value | value << 8) & 0x100f00f00f00f00fULL;
+    value = (value | value << 4) & 0x10c30c30c30c30c3ULL;
+    value = (value | value << 2) & 0x1249249249249249ULL;
+    return value;
+}
+
+BoundingVolumeHierarchy::BoundingVolumeHierarchy() :
+    _root(PROXY_NONE),
+    _freeList(PROXY_NONE),
+    _objectCount(0),
+    _margin(BVH_MARGIN_DEFAULT)
+{
+}
+
+BoundingVolumeHierarchy::~BoundingVolumeHierarchy()
+{
+}
+
+float BoundingVolumeHierarchy::getMargin() const
+{
+    return _margin;
+}
+
+void BoundingVolumeHierarchy::setMargin(float margin)
+{
+    GP_ASSERT(margin >= 0.0f);
+    _margin = margin;
+}
+
+size_t BoundingVolumeHierarchy::insert(SceneObject* object, const BoundingBox& box, uint32_t layerMask)
+{
+    GP_ASSERT(object);
+
+    size_t leaf = allocateNode();
+    Node& node = _nodes[leaf];
+    node.object = object;
+    node.height = 0;
+    node.layerMask = layerMask;
+    setFatBounds(leaf, box);
+    insertLeaf(leaf);
+    ++_objectCount;
+    return leaf;
+}
+
+void BoundingVolumeHierarchy::insert(const std::vector<SceneObject*>& objects, const std::vector<BoundingBox>& boxes, const std::vector<uint32_t>& layerMasks,
+                                     std::vector<size_t>& proxies)
+{
+    GP_ASSERT(objects.size() == boxes.size());
+    GP_ASSERT(objects.size() == layerMasks.size());
+
+    // The leaves are only linked into the tree by the rebuild,
+    // which needs one more node per leaf.
+    _nodes.reserve(_nodes.size() + objects.size() * 2);
+    proxies.reserve(proxies.size() + objects.size());
+    for (size_t i = 0; i < objects.size(); ++i)
+    {
+        GP_ASSERT(objects[i]);
+        size_t leaf = allocateNode();
+        _nodes[leaf].object = objects[i];
+        _nodes[leaf].layerMask = layerMasks[i];
+        setFatBounds(leaf, boxes[i]);
+        proxies.push_back(leaf);
+    }
+    _objectCount += objects.size();
+    rebuild();
+}
+
+bool BoundingVolumeHierarchy::update(size_t proxy, const BoundingBox& box)
+{
+    GP_ASSERT(proxy < _nodes.size() && _nodes[proxy].height == 0);
+
+    // The leaf stays where it is while the object is inside its enlarged box
+    // and the box hasn't become much larger than the object.
+    Node& node = _nodes[proxy];
+    node.objectBox = box;
+    if (contains(node.box, box))
+    {
+        BoundingBox largest;
+        expand(box, _margin * BVH_MARGIN_SHRINK_FACTOR, &largest);
+        if (contains(largest, node.box))
+            return false;
+    }
+    removeLeaf(proxy);
+    setFatBounds(proxy, box);
+    insertLeaf(proxy);
+    return true;
+}
+
+void BoundingVolumeHierarchy::remove(size_t proxy)
+{
+    GP_ASSERT(proxy < _nodes.size() && _nodes[proxy].height == 0);
+
+    removeLeaf(proxy);
+    freeNode(proxy);
+    --_objectCount;
+}
+
+void BoundingVolumeHierarchy::setLayerMask(size_t proxy, uint32_t layerMask)
+{
+    GP_ASSERT(proxy < _nodes.size() && _nodes[proxy].height == 0);
+
+    // The union of the masks below a node stops changing at the first
+    // node where the other children still hold the same layers.
+    _nodes[proxy].layerMask = layerMask;
+    for (size_t index = _nodes[proxy].parent; index != PROXY_NONE; index = _nodes[index].parent)
+    {
+        Node& node = _nodes[index];
+        uint32_t mask = _nodes[node.child1].layerMask | _nodes[node.child2].layerMask;
+        if (mask == node.layerMask)
+            break;
+        node.layerMask = mask;
+    }
+}
+
+void BoundingVolumeHierarchy::clear()
+{
+    _nodes.clear();
+    _root = PROXY_NONE;
+    _freeList = PROXY_NONE;
+    _objectCount = 0;
+}
+
+void BoundingVolumeHierarchy::rebuild()
+{
+    // The leaves keep their nodes so the proxies stay valid,
+    // every other node is freed and used again for the new tree.
+    // The leaves are sorted once by the Morton code of their centers, so the
+    // leaves close to each other along the curve are close in space too.
+    std::vector<BuildLeaf> leaves;
+    leaves.reserve(_objectCount);
+    _freeList = PROXY_NONE;
+    BoundingBox bounds;
+    for (size_t i = _nodes.size(); i-- > 0;)
+    {
+        if (_nodes[i].height != 0)
+        {
+            freeNode(i);
+            continue;
+        }
+        if (leaves.empty())
+            bounds = _nodes[i].box;
+        else
+            combine(bounds, _nodes[i].box, &bounds);
+        BuildLeaf leaf = { 0, i };
+        leaves.push_back(leaf);
+    }
+    const float scale = (float)((1 << BVH_MORTON_BITS) - 1);
+    Vector3 size = bounds.max - bounds.min;
+    Vector3 factor(size.x > 0.0f ? scale / size.x : 0.0f, size.y > 0.0f ? scale / size.y : 0.0f, size.z > 0.0f ? scale / size.z : 0.0f);
+    for (BuildLeaf& leaf : leaves)
+    {
+        const BoundingBox& box = _nodes[leaf.leaf].box;
+        uint64_t x = (uint64_t)(((box.min.x + box.max.x) * 0.5f - bounds.min.x) * factor.x);
+        uint64_t y = (uint64_t)(((box.min.y + box.max.y) * 0.5f - bounds.min.y) * factor.y);
+        uint64_t z = (uint64_t)(((box.min.z + box.max.z) * 0.5f - bounds.min.z) * factor.z);
+        leaf.code = spreadBits(x) | spreadBits(y) << 1 | spreadBits(z) << 2;
+    }
+    std::sort(leaves.begin(), leaves.end(), [](const BuildLeaf& a, const BuildLeaf& b)
+    {
+        return a.code < b.code;
+    });
+    _root = leaves.empty() ? PROXY_NONE : build(leaves, 0, leaves.size());
+    if (_root != PROXY_NONE)
+        _nodes[_root].parent = PROXY_NONE;
+}
+
+SceneObject* BoundingVolumeHierarchy::getObject(size_t proxy) const
+{
+    GP_ASSERT(proxy < _nodes.size());
+    return _nodes[proxy].object;
+}
+
+const BoundingBox& BoundingVolumeHierarchy::getBounds(size_t proxy) const
+{
+    GP_ASSERT(proxy < _nodes.size());
+    return _nodes[proxy].objectBox;
+}
+
+const BoundingBox& BoundingVolumeHierarchy::getFatBounds(size_t proxy) const
+{
+    GP_ASSERT(proxy < _nodes.size());
+    return _nodes[proxy].box;
+}
+
+size_t BoundingVolumeHierarchy::getObjectCount() const
+{
+    return _objectCount;
+}
+
+size_t BoundingVolumeHierarchy::getHeight() const
+{
+    return _root == PROXY_NONE ? 0 : (size_t)_nodes[_root].height + 1;
+}
+
+size_t BoundingVolumeHierarchy::query(const BoundingBox& box, std::vector<SceneObject*>& objects, uint32_t layerMask)
+{
+    size_t count = objects.size();
+    if (_root == PROXY_NONE)
+        return 0;
+    _stack.clear();
+    _stack.push_back(_root);
+    while (!_stack.empty())
+    {
+        const Node& node = _nodes[_stack.back()];
+        _stack.pop_back();
+        if (!(node.layerMask & layerMask) || !node.box.intersects(box))
+            continue;
+        if (node.height == 0)
+        {
+            if (node.objectBox.intersects(box))
+                objects.push_back(node.object);
+        }
+        else
+        {
+            _stack.push_back(node.child1);
+            _stack.push_back(node.child2);
+        }
+    }
+    return objects.size() - count;
+}
+
+size_t BoundingVolumeHierarchy::query(const BoundingSphere& sphere, std::vector<SceneObject*>& objects, uint32_t layerMask)
+{
+    size_t count = objects.size();
+    if (_root == PROXY_NONE)
+        return 0;
+    _stack.clear();
+    _stack.push_back(_root);
+    while (!_stack.empty())
+    {
+        const Node& node = _nodes[_stack.back()];
+        _stack.pop_back();
+        if (!(node.layerMask & layerMask) || !sphere.intersects(node.box))
+            continue;
+        if (node.height == 0)
+        {
+            if (sphere.intersects(node.objectBox))
+                objects.push_back(node.object);
+        }
+        else
+        {
+            _stack.push_back(node.child1);
+            _stack.push_back(node.child2);
+        }
+    }
+    return objects.size() - count;
+}
+
+size_t BoundingVolumeHierarchy::query(const Frustum& frustum, std::vector<SceneObject*>& objects, uint32_t layerMask)
+{
+    size_t count = objects.size();
+    if (_root == PROXY_NONE)
+        return 0;
+
+    // Each node is tested only against the planes its parent crosses, so the
+    // subtrees entirely inside the frustum are taken without any plane tests.
+    _stack.clear();
+    _planeMasks.clear();
+    _stack.push_back(_root);
+    _planeMasks.push_back(Frustum::PLANE_ALL);
+    while (!_stack.empty())
+    {
+        size_t index = _stack.back();
+        int planeMask = _planeMasks.back();
+        _stack.pop_back();
+        _planeMasks.pop_back();
+        const Node& node = _nodes[index];
+        if (!(node.layerMask & layerMask) || !frustum.intersects(node.box, &planeMask))
+            continue;
+        if (node.height == 0)
+        {
+            if (frustum.intersects(node.objectBox, &planeMask))
+                objects.push_back(node.object);
+        }
+        else
+        {
+            _stack.push_back(node.child1);
+            _stack.push_back(node.child2);
+            _planeMasks.push_back(planeMask);
+            _planeMasks.push_back(planeMask);
+        }
+    }
+    return objects.size() - count;
+}
+
+size_t BoundingVolumeHierarchy::queryNearest(const Vector3& point, size_t count, float maxDistance, std::vector<SceneObject*>& objects, uint32_t layerMask)
+{
+    size_t found = objects.size();
+    if (_root == PROXY_NONE || count == 0 || !(_nodes[_root].layerMask & layerMask))
+        return 0;
+
+    // Best first search on the squared distances. A node is keyed by the distance
+    // to its box, which no center below it can be nearer than, and a leaf by the
+    // distance to the center of its object. So when a leaf comes out of the heap
+    // nothing left to visit is nearer.
+    const float maxDistanceSquared = maxDistance * maxDistance;
+    std::greater<std::pair<float, size_t>> compare;
+    _heap.clear();
+    _heap.push_back(std::make_pair(getDistanceSquared(_root, point), _root));
+    while (!_heap.empty() && objects.size() - found < count)
+    {
+        std::pop_heap(_heap.begin(), _heap.end(), compare);
+        float distanceSquared = _heap.back().first;
+        const Node& node = _nodes[_heap.back().second];
+        _heap.pop_back();
+        if (distanceSquared > maxDistanceSquared)
+            break;
+        if (node.height == 0)
+        {
+            objects.push_back(node.object);
+            continue;
+        }
+        if (_nodes[node.child1].layerMask & layerMask)
+        {
+            _heap.push_back(std::make_pair(getDistanceSquared(node.child1, point), node.child1));
+            std::push_heap(_heap.begin(), _heap.end(), compare);
+        }
+        if (_nodes[node.child2].layerMask & layerMask)
+        {
+            _heap.push_back(std::make_pair(getDistanceSquared(node.child2, point), node.child2));
+            std::push_heap(_heap.begin(), _heap.end(), compare);
+        }
+    }
+    return objects.size() - found;
+}
+
+bool BoundingVolumeHierarchy::raycast(const Ray& ray, float maxDistance, Hit* hit, uint32_t layerMask)
+{
+    GP_ASSERT(hit);
+
+    if (_root == PROXY_NONE)
+        return false;
+    const Vector3& origin = ray.getOrigin();
+    Vector3 inverseDirection = getInverseDirection(ray);
+    float nearest = maxDistance;
+    SceneObject* object = nullptr;
+    float distance;
+    _stack.clear();
+    if ((_nodes[_root].layerMask & layerMask) && intersectRay(_nodes[_root].box, origin, inverseDirection, nearest, &distance))
+        _stack.push_back(_root);
+    while (!_stack.empty())
+    {
+        const Node& node = _nodes[_stack.back()];
+        _stack.pop_back();
+
+        // The node may have been pushed before a nearer hit was found.
+        if (!intersectRay(node.box, origin, inverseDirection, nearest, &distance))
+            continue;
+        if (node.height == 0)
+        {
+            if (intersectRay(node.objectBox, origin, inverseDirection, nearest, &distance))
+            {
+                nearest = distance;
+                object = node.object;
+            }
+            continue;
+        }
+
+        // The nearer child is pushed last so it is visited first.
+        float distance1;
+        float distance2;
+        const Node& child1 = _nodes[node.child1];
+        const Node& child2 = _nodes[node.child2];
+        bool hit1 = (child1.layerMask & layerMask) && intersectRay(child1.box, origin, inverseDirection, nearest, &distance1);
+        bool hit2 = (child2.layerMask & layerMask) && intersectRay(child2.box, origin, inverseDirection, nearest, &distance2);
+        if (hit1 && hit2)
+        {
+            if (distance1 < distance2)
+            {
+                _stack.push_back(node.child2);
+                _stack.push_back(node.child1);
+            }
+            else
+            {
+                _stack.push_back(node.child1);
+                _stack.push_back(node.child2);
+            }
+        }
+        else if (hit1)
+        {
+            _stack.push_back(node.child1);
+        }
+        else if (hit2)
+        {
+            _stack.push_back(node.child2);
+        }
+    }
+    if (!object)
+        return false;
+    hit->object = object;
+    hit->distance = nearest;
+    return true;
+}
+
+size_t BoundingVolumeHierarchy::raycastAll(const Ray& ray, float maxDistance, std::vector<Hit>& hits, uint32_t layerMask)
+{
+    size_t count = hits.size();
+    if (_root == PROXY_NONE)
+        return 0;
+    const Vector3& origin = ray.getOrigin();
+    Vector3 inverseDirection = getInverseDirection(ray);
+    float distance;
+    _stack.clear();
+    _stack.push_back(_root);
+    while (!_stack.empty())
+    {
+        const Node& node = _nodes[_stack.back()];
+        _stack.pop_back();
+        if (!(node.layerMask & layerMask) || !intersectRay(node.box, origin, inverseDirection, maxDistance, &distance))
+            continue;
+        if (node.height == 0)
+        {
+            if (intersectRay(node.objectBox, origin, inverseDirection, maxDistance, &distance))
+            {
+                Hit hit = { node.object, distance };
+                hits.push_back(hit);
+            }
+        }
+        else
+        {
+            _stack.push_back(node.child1);
+            _stack.push_back(node.child2);
+        }
+    }
+    sortHits(hits, count);
+    return hits.size() - count;
+}
+
+size_t BoundingVolumeHierarchy::allocateNode()
+{
+    // Freed nodes are chained through their parent index.
+    size_t index;
+    if (_freeList == PROXY_NONE)
+    {
+        index = _nodes.size();
+        _nodes.emplace_back();
+    }
+    else
+    {
+        index = _freeList;
+        _freeList = _nodes[index].parent;
+    }
+    Node& node = _nodes[index];
+    node.object = nullptr;
+    node.parent = PROXY_NONE;
+    node.child1 = PROXY_NONE;
+    node.child2 = PROXY_NONE;
+    node.height = 0;
+    node.layerMask = 0;
+    return index;
+}
+
+void BoundingVolumeHierarchy::freeNode(size_t index)
+{
+    Node& node = _nodes[index];
+    node.object = nullptr;
+    node.parent = _freeList;
+    node.height = -1;
+    _freeList = index;
+}
+
+void BoundingVolumeHierarchy::insertLeaf(size_t leaf)
+{
+    if (_root == PROXY_NONE)
+    {
+        _root = leaf;
+        _nodes[leaf].parent = PROXY_NONE;
+        return;
+    }
+
+    // Descend towards the sibling that grows the tree the least. Going down a
+    // level costs the growth of the node, which every node above pays too.
+    BoundingBox leafBox = _nodes[leaf].box;
+    BoundingBox combined;
+    size_t index = _root;
+    while (_nodes[index].height > 0)
+    {
+        const Node& node = _nodes[index];
+        float area = getArea(node.box);
+        combine(node.box, leafBox, &combined);
+        float combinedArea = getArea(combined);
+        float cost = 2.0f * combinedArea;
+        float inheritanceCost = 2.0f * (combinedArea - area);
+
+        const Node& child1 = _nodes[node.child1];
+        combine(child1.box, leafBox, &combined);
+        float cost1 = getArea(combined) + inheritanceCost;
+        if (child1.height > 0)
+            cost1 -= getArea(child1.box);
+
+        const Node& child2 = _nodes[node.child2];
+        combine(child2.box, leafBox, &combined);
+        float cost2 = getArea(combined) + inheritanceCost;
+        if (child2.height > 0)
+            cost2 -= getArea(child2.box);
+
+        if (cost < cost1 && cost < cost2)
+            break;
+        index = cost1 < cost2 ? node.child1 : node.child2;
+    }
+
+    // The sibling and the leaf share a new parent in place of the sibling.
+    size_t sibling = index;
+    size_t oldParent = _nodes[sibling].parent;
+    size_t newParent = allocateNode();
+    Node& parent = _nodes[newParent];
+    parent.parent = oldParent;
+    combine(leafBox, _nodes[sibling].box, &parent.box);
+    parent.height = _nodes[sibling].height + 1;
+    parent.layerMask = _nodes[sibling].layerMask | _nodes[leaf].layerMask;
+    parent.child1 = sibling;
+    parent.child2 = leaf;
+    _nodes[sibling].parent = newParent;
+    _nodes[leaf].parent = newParent;
+    if (oldParent == PROXY_NONE)
+    {
+        _root = newParent;
+    }
+    else
+    {
+        Node& old = _nodes[oldParent];
+        if (old.child1 == sibling)
+            old.child1 = newParent;
+        else
+            old.child2 = newParent;
+    }
+
+    // A leaf paired with a tall sibling leaves the new parent lopsided, so it is
+    // balanced before the nodes above are refit. Its box, height and layers are
+    // already set, so the refit would stop right away if it started there.
+    balance(newParent);
+    refit(oldParent);
+}
+
+void BoundingVolumeHierarchy::removeLeaf(size_t leaf)
+{
+    if (leaf == _root)
+    {
+        _root = PROXY_NONE;
+        return;
+    }
+
+    // The sibling takes the place of the parent, which is freed.
+    size_t parent = _nodes[leaf].parent;
+    size_t grandParent = _nodes[parent].parent;
+    size_t sibling = _nodes[parent].child1 == leaf ? _nodes[parent].child2 : _nodes[parent].child1;
+    _nodes[sibling].parent = grandParent;
+    freeNode(parent);
+    if (grandParent == PROXY_NONE)
+    {
+        _root = sibling;
+        return;
+    }
+    Node& node = _nodes[grandParent];
+    if (node.child1 == parent)
+        node.child1 = sibling;
+    else
+        node.child2 = sibling;
+    refit(grandParent);
+}
+
+void BoundingVolumeHierarchy::refit(size_t index)
+{
+    // Walk up rebalancing and enclosing the children again. A rotation keeps
+    // the same leaves below the node, so once a node ends up with the same box,
+    // height and layers as before nothing above it changes and the walk stops.
+    while (index != PROXY_NONE)
+    {
+        BoundingBox box = _nodes[index].box;
+        int height = _nodes[index].height;
+        uint32_t layerMask = _nodes[index].layerMask;
+        index = balance(index);
+        Node& node = _nodes[index];
+        const Node& child1 = _nodes[node.child1];
+        const Node& child2 = _nodes[node.child2];
+        node.height = 1 + std::max(child1.height, child2.height);
+        node.layerMask = child1.layerMask | child2.layerMask;
+        combine(child1.box, child2.box, &node.box);
+        if (node.height == height && node.layerMask == layerMask && equals(node.box, box))
+            break;
+        index = node.parent;
+    }
+}
+
+size_t BoundingVolumeHierarchy::balance(size_t indexA)
+{
+    // Rotates the taller child up when the heights of the children differ
+    // by more than one, and returns the node that took the place of A.
+    Node& a = _nodes[indexA];
+    if (a.height < 2)
+        return indexA;
+
+    size_t indexB = a.child1;
+    size_t indexC = a.child2;
+    Node& b = _nodes[indexB];
+    Node& c = _nodes[indexC];
+    int difference = c.height - b.height;
+    if (difference > 1)
+    {
+        // C goes up, A takes the shorter child of C.
+        size_t indexF = c.child1;
+        size_t indexG = c.child2;
+        Node& f = _nodes[indexF];
+        Node& g = _nodes[indexG];
+        c.child1 = indexA;
+        c.parent = a.parent;
+        a.parent = indexC;
+        if (c.parent == PROXY_NONE)
+            _root = indexC;
+        else if (_nodes[c.parent].child1 == indexA)
+            _nodes[c.parent].child1 = indexC;
+        else
+            _nodes[c.parent].child2 = indexC;
+
+        if (f.height > g.height)
+        {
+            c.child2 = indexF;
+            a.child2 = indexG;
+            g.parent = indexA;
+            combine(b.box, g.box, &a.box);
+            combine(a.box, f.box, &c.box);
+            a.height = 1 + std::max(b.height, g.height);
+            c.height = 1 + std::max(a.height, f.height);
+            a.layerMask = b.layerMask | g.layerMask;
+            c.layerMask = a.layerMask | f.layerMask;
+        }
+        else
+        {
+            c.child2 = indexG;
+            a.child2 = indexF;
+            f.parent = indexA;
+            combine(b.box, f.box, &a.box);
+            combine(a.box, g.box, &c.box);
+            a.height = 1 + std::max(b.height, f.height);
+            c.height = 1 + std::max(a.height, g.height);
+            a.layerMask = b.layerMask | f.layerMask;
+            c.layerMask = a.layerMask | g.layerMask;
+        }
+        return indexC;
+    }
+    if (difference < -1)
+    {
+        // B goes up, A takes the shorter child of B.
+        size_t indexD = b.child1;
+        size_t indexE = b.child2;
+        Node& d = _nodes[indexD];
+        Node& e = _nodes[indexE];
+        b.child1 = indexA;
+        b.parent = a.parent;
+        a.parent = indexB;
+        if (b.parent == PROXY_NONE)
+            _root = indexB;
+        else if (_nodes[b.parent].child1 == indexA)
+            _nodes[b.parent].child1 = indexB;
+        else
+            _nodes[b.parent].child2 = indexB;
+
+        if (d.height > e.height)
+        {
+            b.child2 = indexD;
+            a.child1 = indexE;
+            e.parent = indexA;
+            combine(c.box, e.box, &a.box);
+            combine(a.box, d.box, &b.box);
+            a.height = 1 + std::max(c.height, e.height);
+            b.height = 1 + std::max(a.height, d.height);
+            a.layerMask = c.layerMask | e.layerMask;
+            b.layerMask = a.layerMask | d.layerMask;
+        }
+        else
+        {
+            b.child2 = indexE;
+            a.child1 = indexD;
+            d.parent = indexA;
+            combine(c.box, d.box, &a.box);
+            combine(a.box, e.box, &b.box);
+            a.height = 1 + std::max(c.height, d.height);
+            b.height = 1 + std::max(a.height, e.height);
+            a.layerMask = c.layerMask | d.layerMask;
+            b.layerMask = a.layerMask | e.layerMask;
+        }
+        return indexB;
+    }
+    return indexA;
+}
+
+size_t BoundingVolumeHierarchy::build(std::vector<BuildLeaf>& leaves, size_t begin, size_t end)
+{
+    if (end - begin == 1)
+        return leaves[begin].leaf;
+
+    // Split where the highest bit that differs in the range changes, which is
+    // a plane through the middle of the octree cell that holds the leaves.
+    // Leaves with the same code are split in halves.
+    uint64_t first = leaves[begin].code;
+    uint64_t last = leaves[end - 1].code;
+    size_t middle = begin + (end - begin) / 2;
+    if (first != last)
+    {
+        uint64_t bit = (uint64_t)1 << 63;
+        while (!((first ^ last) & bit))
+            bit >>= 1;
+        size_t low = begin;
+        size_t high = end - 1;
+        while (low + 1 < high)
+        {
+            size_t mid = low + (high - low) / 2;
+            if (leaves[mid].code & bit)
+                high = mid;
+            else
+                low = mid;
+        }
+        middle = high;
+    }
+    size_t child1 = build(leaves, begin, middle);
+    size_t child2 = build(leaves, middle, end);
+    size_t index = allocateNode();
+    Node& node = _nodes[index];
+    node.child1 = child1;
+    node.child2 = child2;
+    node.height = 1 + std::max(_nodes[child1].height, _nodes[child2].height);
+    node.layerMask = _nodes[child1].layerMask | _nodes[child2].layerMask;
+    combine(_nodes[child1].box, _nodes[child2].box, &node.box);
+    _nodes[child1].parent = index;
+    _nodes[child2].parent = index;
+    return index;
+}
+
+float BoundingVolumeHierarchy::getDistanceSquared(size_t index, const Vector3& point) const
+{
+    const Node& node = _nodes[index];
+    if (node.height == 0)
+    {
+        const BoundingBox& box = node.objectBox;
+        float x = (box.min.x + box.max.x) * 0.5f - point.x;
+        float y = (box.min.y + box.max.y) * 0.5f - point.y;
+        float z = (box.min.z + box.max.z) * 0.5f - point.z;
+        return x * x + y * y + z * z;
+    }
+    const BoundingBox& box = node.box;
+    float x = std::max(std::max(box.min.x - point.x, point.x - box.max.x), 0.0f);
+    float y = std::max(std::max(box.min.y - point.y, point.y - box.max.y), 0.0f);
+    float z = std::max(std::max(box.min.z - point.z, point.z - box.max.z), 0.0f);
+    return x * x + y * y + z * z;
+}
+
+void BoundingVolumeHierarchy::setFatBounds(size_t leaf, const BoundingBox& box)
+{
+    Node& node = _nodes[leaf];
+    node.objectBox = box;
+    expand(box, _margin, &node.box);
+}
+
+}
@@ -0,0 +1,221 @@
+#pragma once
+
+#include "SpatialIndex.h"
+
+namespace gameplay
+{
+
+/**
+ * Defines a dynamic tree of axis aligned bounding boxes over scene objects.
+ *
+ * Each object is a leaf of a binary tree whose nodes enclose their
+ * children, so a query only descends into the nodes it overlaps.
+ * The leaves store the box of the object enlarged by a margin. While the
+ * object stays inside its enlarged box only its own box is updated.
+ * Once it leaves, the leaf is reinserted next to the node that grows
+ * the least and the nodes above it are refit and rebalanced with
+ * rotations, so the tree stays shallow as objects move. The proxy of
+ * an object is the node of its leaf.
+ *
+ * Each node also holds the union of the layer masks below it, so the
+ * queries skip the subtrees with none of the layers searched.
+ */
+class BoundingVolumeHierarchy : public SpatialIndex
+{
+public:
+
+    /**
+     * Constructor.
+     */
+    BoundingVolumeHierarchy();
+
+    /**
+     * Destructor.
+     */
+    ~BoundingVolumeHierarchy();
+
+    /**
+     * Gets the margin that the boxes of the leaves are enlarged by.
+     *
+     * @return The margin that the boxes of the leaves are enlarged by.
+     */
+    float getMargin() const;
+
+    /**
+     * Sets the margin that the boxes of the leaves are enlarged by.
+     *
+     * A larger margin means fewer reinsertions for moving objects and
+     * more overlap between the nodes. It applies to the leaves that are
+     * inserted or reinserted afterwards.
+     *
+     * @param margin The margin in world units.
+     */
+    void setMargin(float margin);
+
+    /**
+     * Gets the enlarged box of a leaf.
+     *
+     * @param proxy The proxy of the leaf.
+     * @return The enlarged box of the leaf.
+     */
+    const BoundingBox& getFatBounds(size_t proxy) const;
+
+    /**
+     * Gets the height of the tree.
+     *
+     * @return The number of nodes on the longest path from the root to a leaf.
+     */
+    size_t getHeight() const;
+
+    /**
+     * Rebuilds the tree from the top down.
+     *
+     * The leaves are sorted along a space filling curve through their
+     * centers and split in halves. The proxies stay valid. This restores
+     * the quality of a tree whose objects have moved a lot since they
+     * were inserted.
+     */
+    void rebuild();
+
+    /**
+     * @see SpatialIndex::insert
+     */
+    size_t insert(SceneObject* object, const BoundingBox& box, uint32_t layerMask);
+
+    /**
+     * Inserts many objects into the tree at once.
+     *
+     * The tree is rebuilt from the top down afterwards, which is much
+     * faster than inserting the objects one at a time.
+     *
+     * @see SpatialIndex::insert
+     */
+    void insert(const std::vector<SceneObject*>& objects, const std::vector<BoundingBox>& boxes, const std::vector<uint32_t>& layerMasks,
+                std::vector<size_t>& proxies);
+
+    /**
+     * Updates the bounds of an object in the tree.
+     *
+     * The leaf is reinserted when the object leaves its enlarged box.
+     *
+     * @see SpatialIndex::update
+     */
+    bool update(size_t proxy, const BoundingBox& box);
+
+    /**
+     * @see SpatialIndex::remove
+     */
+    void remove(size_t proxy);
+
+    /**
+     * @see SpatialIndex::setLayerMask
+     */
+    void setLayerMask(size_t proxy, uint32_t layerMask);
+
+    /**
+     * @see SpatialIndex::clear
+     */
+    void clear();
+
+    /**
+     * @see SpatialIndex::getObject
+     */
+    SceneObject* getObject(size_t proxy) const;
+
+    /**
+     * @see SpatialIndex::getBounds
+     */
+    const BoundingBox& getBounds(size_t proxy) const;
+
+    /**
+     * @see SpatialIndex::getObjectCount
+     */
+    size_t getObjectCount() const;
+
+    /**
+     * @see SpatialIndex::query
+     */
+    size_t query(const BoundingBox& box, std::vector<SceneObject*>& objects, uint32_t layerMask);
+
+    /**
+     * @see SpatialIndex::query
+     */
+    size_t query(const BoundingSphere& sphere, std::vector<SceneObject*>& objects, uint32_t layerMask);
+
+    /**
+     * Finds the objects whose bounds intersect a frustum.
+     *
+     * The nodes are tested only against the planes that their parent crosses.
+     *
+     * @see SpatialIndex::query
+     */
+    size_t query(const Frustum& frustum, std::vector<SceneObject*>& objects, uint32_t layerMask);
+
+    /**
+     * Finds the objects nearest to a point.
+     *
+     * The nodes are visited nearest first, so the search stops as soon
+     * as the next node is farther than the objects found.
+     *
+     * @see SpatialIndex::queryNearest
+     */
+    size_t queryNearest(const Vector3& point, size_t count, float maxDistance, std::vector<SceneObject*>& objects, uint32_t layerMask);
+
+    /**
+     * Finds the nearest object whose bounds are hit by a ray.
+     *
+     * The nodes are visited nearest first and the ones beyond the
+     * closest hit so far are skipped.
+     *
+     * @see SpatialIndex::raycast
+     */
+    bool raycast(const Ray& ray, float maxDistance, Hit* hit, uint32_t layerMask);
+
+    /**
+     * @see SpatialIndex::raycastAll
+     */
+    size_t raycastAll(const Ray& ray, float maxDistance, std::vector<Hit>& hits, uint32_t layerMask);
+
+private:
+
+    struct Node
+    {
+        BoundingBox box;
+        BoundingBox objectBox;
+        SceneObject* object;
+        size_t parent;
+        size_t child1;
+        size_t child2;
+        int height;
+        uint32_t layerMask;
+    };
+
+    struct BuildLeaf
+    {
+        uint64_t code;
+        size_t leaf;
+    };
+
+    BoundingVolumeHierarchy(const BoundingVolumeHierarchy& copy);
+    BoundingVolumeHierarchy& operator=(const BoundingVolumeHierarchy& copy);
+    size_t allocateNode();
+    void freeNode(size_t index);
+    void insertLeaf(size_t leaf);
+    void removeLeaf(size_t leaf);
+    void refit(size_t index);
+    size_t balance(size_t index);
+    void setFatBounds(size_t leaf, const BoundingBox& box);
+    size_t build(std::vector<BuildLeaf>& leaves, size_t begin, size_t end);
+    float getDistanceSquared(size_t index, const Vector3& point) const;
+
+    std::vector<Node> _nodes;
+    std::vector<size_t> _stack;
+    std::vector<int> _planeMasks;
+    std::vector<std::pair<float, size_t>> _heap;
+    size_t _root;
+    size_t _freeList;
+    size_t _objectCount;
+    float _margin;
+};
+
+}
@@ -13,17 +13,22 @@
 #define CAMERA_SIZE 5.0f
 #define CAMERA_CLIP_PLANE_NEAR 0.1f
 #define CAMERA_CLIP_PLANE_FAR 1000.f
+#define CAMERA_CULLING_MASK Scene::LAYER_ALL
 
 namespace gameplay
 {
 
+const Component::TypeId Camera::TYPEID = Component::TYPEID_CAMERA;
+
 Camera::Camera() : Component(),
     _mode(MODE_PERSPECTIVE),
     _fieldOfView(CAMERA_FIELD_OF_VIEW),
     _size(CAMERA_SIZE),
     _clipPlaneNear(CAMERA_CLIP_PLANE_NEAR),
     _clipPlaneFar(CAMERA_CLIP_PLANE_FAR),
-    _dirtyBits(CAMERA_DIRTY_ALL)
+    _cullingMask(CAMERA_CULLING_MASK),
+    _dirtyBits(CAMERA_DIRTY_ALL),
+    _transformVersion(0)
 {
 }
 
@@ -94,12 +99,14 @@ void Camera::reset(Camera::Mode mode)
 
 const Matrix& Camera::getViewMatrix() const
 {
+    checkTransformVersion();
     if (_dirtyBits & CAMERA_DIRTY_VIEW)
     {
-        if (_object.lock())
+        SceneObject* object = _object.get();
+        if (object)
         {
-            // The view matrix is the inverse of our transform matrix.
-            _object.lock()->getWorldToLocalMatrix().invert(&_viewMatrix);
+            // The view matrix is the inverse of our world matrix.
+            _viewMatrix = object->getWorldToLocalMatrix();
         }
         else
         {
@@ -113,9 +120,14 @@ const Matrix& Camera::getViewMatrix() const
 
 const Matrix& Camera::getInverseViewMatrix() const
 {
+    checkTransformVersion();
     if (_dirtyBits & CAMERA_DIRTY_INV_VIEW)
     {
-        getViewMatrix().invert(&_inverseViewMatrix);
+        SceneObject* object = _object.get();
+        if (object)
+            _inverseViewMatrix = object->getWorldMatrix();
+        else
+            _inverseViewMatrix.setIdentity();
 
         _dirtyBits &= ~CAMERA_DIRTY_INV_VIEW;
     }
@@ -150,6 +162,7 @@ void Camera::setProjectionMatrix(const Matrix& matrix)
 
 const Matrix& Camera::getViewProjectionMatrix() const
 {
+    checkTransformVersion();
     if (_dirtyBits & CAMERA_DIRTY_VIEW_PROJ)
     {
         Matrix::multiply(getProjectionMatrix(), getViewMatrix(), &_viewProjectionMatrix);
@@ -160,6 +173,7 @@ const Matrix& Camera::getViewProjectionMatrix() const
 
 const Matrix& Camera::getInverseViewProjectionMatrix() const
 {
+    checkTransformVersion();
     if (_dirtyBits & CAMERA_DIRTY_INV_VIEW_PROJ)
     {
         getViewProjectionMatrix().invert(&_inverseViewProjectionMatrix);
@@ -170,6 +184,7 @@ const Matrix& Camera::getInverseViewProjectionMatrix() const
 
 const Frustum& Camera::getFrustum() const
 {
+    checkTransformVersion();
     if (_dirtyBits & CAMERA_DIRTY_BOUNDS)
     {
         // Update our bounding frustum from our view projection matrix.
@@ -180,6 +195,24 @@ const Frustum& Camera::getFrustum() const
     return _bounds;
 }
 
+uint32_t Camera::getCullingMask() const
+{
+    return _cullingMask;
+}
+
+void Camera::setCullingMask(uint32_t cullingMask)
+{
+    _cullingMask = cullingMask;
+}
+
+size_t Camera::queryObjects(std::vector<SceneObject*>& objects) const
+{
+    SceneObject* object = _object.get();
+    if (!object)
+        return 0;
+    return object->getScene()->queryObjects(getFrustum(), objects, _cullingMask);
+}
+
 void Camera::project(const Rectangle& viewport, const Vector3& position, float* x, float* y, float* depth) const
 {
     GP_ASSERT(x);
@@ -266,9 +299,52 @@ void Camera::pickRay(const Rectangle& viewport, float x, float y, Ray* dst) cons
     dst->set(nearPoint, direction);
 }
 
+void Camera::pickFrustum(const Rectangle& viewport, const Rectangle& region, Frustum* dst) const
+{
+    GP_ASSERT(dst);
+    GP_ASSERT(viewport.width != 0.0f && viewport.height != 0.0f);
+    GP_ASSERT(region.width > 0.0f && region.height > 0.0f);
+
+    // Get the region in NDC, with y flipped since the viewport y goes down.
+    float left = (region.x - viewport.x) / viewport.width * 2.0f - 1.0f;
+    float right = (region.x + region.width - viewport.x) / viewport.width * 2.0f - 1.0f;
+    float top = 1.0f - (region.y - viewport.y) / viewport.height * 2.0f;
+    float bottom = 1.0f - (region.y + region.height - viewport.y) / viewport.height * 2.0f;
+
+    // Scale and offset the clip space so the region covers all of it.
+    // The offset is multiplied by w, so it holds after the divide.
+    float scaleX = 2.0f / (right - left);
+    float scaleY = 2.0f / (top - bottom);
+    Matrix pick;
+    Matrix::createScale(Vector3(scaleX, scaleY, 1.0f), &pick);
+    pick.m[12] = -scaleX * (left + right) * 0.5f;
+    pick.m[13] = -scaleY * (top + bottom) * 0.5f;
+
+    Matrix viewProjection;
+    Matrix::multiply(pick, getViewProjectionMatrix(), &viewProjection);
+    dst->set(viewProjection);
+}
+
 Component::TypeId Camera::getTypeId()
 {
-    return Component::TYPEID_CAMERA;
+    return TYPEID;
+}
+
+std::shared_ptr<Component> Camera::clone()
+{
+    // A custom projection is copied, the other matrices are recomputed when used.
+    std::shared_ptr<Camera> camera = Serializer::getActivator()->createShared<Camera>();
+    camera->_enabled = _enabled;
+    camera->_mode = _mode;
+    camera->_fieldOfView = _fieldOfView;
+    camera->_size = _size;
+    camera->_clipPlaneNear = _clipPlaneNear;
+    camera->_clipPlaneFar = _clipPlaneFar;
+    camera->_aspectRatio = _aspectRatio;
+    camera->_cullingMask = _cullingMask;
+    camera->_projectionMatrix = _projectionMatrix;
+    camera->_dirtyBits = _dirtyBits | CAMERA_DIRTY_ALL;
+    return camera;
 }
 
 std::string Camera::getClassName()
@@ -285,6 +361,7 @@ void Camera::onSerialize(Serializer* serializer)
         serializer->writeFloat("size", _size, CAMERA_SIZE);
     serializer->writeFloat("clipPlaneNear", _clipPlaneNear, CAMERA_CLIP_PLANE_NEAR);
     serializer->writeFloat("clipPlaneFar", _clipPlaneFar, CAMERA_CLIP_PLANE_FAR);
+    serializer->writeInt("cullingMask", (int)_cullingMask, (int)CAMERA_CULLING_MASK);
 
 
 }
@@ -298,11 +375,12 @@ void Camera::onDeserialize(Serializer* serializer)
         _size = serializer->readFloat("size", CAMERA_SIZE);
     _clipPlaneNear = serializer->readFloat("clipPlaneNear", CAMERA_CLIP_PLANE_NEAR);
     _clipPlaneFar = serializer->readFloat("clipPlaneFar", CAMERA_CLIP_PLANE_FAR);
+    _cullingMask = (uint32_t)serializer->readInt("cullingMask", (int)CAMERA_CULLING_MASK);
 }
 
 std::shared_ptr<Serializable> Camera::createObject()
 {
-    return std::static_pointer_cast<Serializable>(std::make_shared<Camera>());
+    return std::static_pointer_cast<Serializable>(Serializer::getActivator()->createShared<Camera>());
 }
 
 std::string Camera::enumToString(const std::string& enumName, int value)
@@ -338,6 +416,20 @@ void Camera::setObject(std::shared_ptr<SceneObject> object)
 {
     Component::setObject(object);
     _dirtyBits |= CAMERA_DIRTY_VIEW | CAMERA_DIRTY_VIEW_PROJ | CAMERA_DIRTY_INV_VIEW | CAMERA_DIRTY_INV_VIEW_PROJ | CAMERA_DIRTY_BOUNDS;
+    if (object)
+        _transformVersion = object->getTransformVersion();
+}
+
+void Camera::checkTransformVersion() const
+{
+    // The view follows the world transform of the object, which
+    // moves without telling the camera. Its version says if it did.
+    SceneObject* object = _object.get();
+    if (object && object->getTransformVersion() != _transformVersion)
+    {
+        _transformVersion = object->getTransformVersion();
+        _dirtyBits |= CAMERA_DIRTY_VIEW | CAMERA_DIRTY_VIEW_PROJ | CAMERA_DIRTY_INV_VIEW | CAMERA_DIRTY_INV_VIEW_PROJ | CAMERA_DIRTY_BOUNDS;
+    }
 }
 
 }
@@ -178,6 +178,34 @@ public:
      */
     const Frustum& getFrustum() const;
 
+    /**
+     * Gets the layers that the camera sees.
+     *
+     * @return The layers as a bit mask, Scene::LAYER_ALL unless set.
+     */
+    uint32_t getCullingMask() const;
+
+    /**
+     * Sets the layers that the camera sees.
+     *
+     * The objects on none of the layers are culled, such as the editor
+     * objects from a game camera or the world from a user interface camera.
+     *
+     * @param cullingMask The layers as a bit mask.
+     */
+    void setCullingMask(uint32_t cullingMask);
+
+    /**
+     * Finds the objects that the camera sees.
+     *
+     * These are the objects of the scene of the camera whose world bounds
+     * intersect its frustum and that are on a layer of its culling mask.
+     *
+     * @param objects A vector that the objects found are appended to.
+     * @return The number of objects found.
+     */
+    size_t queryObjects(std::vector<SceneObject*>& objects) const;
+
     /**
      * Projects the specified world position into the viewport coordinates.
      *
@@ -233,11 +261,32 @@ public:
      */
     void pickRay(const Rectangle& viewport, float x, float y, Ray* dst) const;
 
+    /**
+     * Picks a frustum that can be used for selecting the objects within a region of the viewport.
+     *
+     * The frustum is the part of the frustum of the camera seen through the region.
+     *
+     * @param viewport The viewport rectangle to use.
+     * @param region The region of the viewport, in viewport coordinates. It must not be empty.
+     * @param dst The computed pick frustum.
+     */
+    void pickFrustum(const Rectangle& viewport, const Rectangle& region, Frustum* dst) const;
+
+    /**
+     * The component type identifier of this class.
+     */
+    static const Component::TypeId TYPEID;
+
     /**
      * @see Component::getTypeId
      */
     Component::TypeId getTypeId();
 
+    /**
+     * @see Component::clone
+     */
+    std::shared_ptr<Component> clone();
+
     /**
      * @see Serializable::getClassName
 	 */
@@ -274,12 +323,15 @@ protected:
 
 private:
 
+    void checkTransformVersion() const;
+
     Camera::Mode _mode;
     float _fieldOfView;
     float _size;
     float _clipPlaneNear;
     float _clipPlaneFar;
     float _aspectRatio;
+    uint32_t _cullingMask;
     mutable Matrix _viewMatrix;
     mutable Matrix _projectionMatrix;
     mutable Matrix _viewProjectionMatrix;
@@ -287,6 +339,7 @@ private:
     mutable Matrix _inverseViewProjectionMatrix;
     mutable Frustum _bounds;
     mutable int _dirtyBits;
+    mutable uint32_t _transformVersion;
 };
 
 }
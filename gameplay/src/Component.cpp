@@ -1,11 +1,17 @@
 #include "Base.h"
 #include "Component.h"
+#include "SceneObject.h"
 
 namespace gameplay
 {
 
+static std::atomic<int> __nextTypeId(Component::TYPEID_USER);
+
+const size_t Component::TYPEID_MAX;
+
 Component::Component() :
-    _enabled(true)
+    _enabled(true),
+    _poolIndex(0)
 {
 }
 
@@ -13,6 +19,16 @@ Component::~Component()
 {
 }
 
+Component::TypeId Component::registerTypeId()
+{
+    int typeId = __nextTypeId++;
+    if (typeId >= (int)TYPEID_MAX)
+    {
+        GP_ERROR("Too many component types registered (max %d).", (int)TYPEID_MAX);
+    }
+    return (Component::TypeId)typeId;
+}
+
 bool Component::isEnabled() const
 {
     return _enabled;
@@ -28,9 +44,27 @@ std::shared_ptr<SceneObject> Component::getObject() const
     return _object.lock();
 }
 
+std::shared_ptr<Component> Component::clone()
+{
+    GP_WARN("Component can't be cloned: %s", getClassName().c_str());
+    return nullptr;
+}
+
+bool Component::getBounds(BoundingBox*)
+{
+    return false;
+}
+
 void Component::setObject(std::shared_ptr<SceneObject> object)
 {
-    _object = object;
+    _object = object ? object->getHandle() : SceneObjectHandle();
+}
+
+void Component::setBoundsDirty()
+{
+    SceneObject* object = _object.get();
+    if (object)
+        object->setBoundsDirty();
 }
 
 }
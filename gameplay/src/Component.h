@@ -1,24 +1,32 @@
 #pragma once
 
 #include "Serializable.h"
+#include "SceneObjectHandle.h"
 
 namespace gameplay
 {
 
+class BoundingBox;
+
 /**
  * Defines a component
  */
 class Component : public std::enable_shared_from_this<Component>, public Serializable
 {
     friend class SceneObject;
+    friend class Scene;
     friend class Serializer::Activator;
 
 public:
 
     /**
      * Defines the component type identifier.
+     *
+     * Component types that are not part of the engine get their
+     * identifier from registerTypeId, starting at TYPEID_USER. The
+     * underlying type is fixed so those identifiers are valid values.
      */
-    enum TypeId
+    enum TypeId : int
     {
         TYPEID_SCRIPT,
         TYPEID_CAMERA,
@@ -28,9 +36,31 @@ public:
         TYPEID_PHYSICS_COLLIDER,
         TYPEID_PHYSICS_RIGIDBODY,
         TYPEID_PHYSICS_JOINT,
-        TYPEID_RENDERER_MESH
+        TYPEID_RENDERER_MESH,
+        TYPEID_RENDERER_LOD,
+        TYPEID_USER
     };
 
+    /**
+     * The maximum number of component types including the user types.
+     */
+    static const size_t TYPEID_MAX = 64;
+
+    /**
+     * Registers a new component type and returns its identifier.
+     *
+     * Call this once per user component type and keep the identifier in
+     * a static TYPEID member of the class, returning it from getTypeId, so
+     * that SceneObject::getComponent<T> can find the type:
+     *
+     * @code
+     * const Component::TypeId MyComponent::TYPEID = Component::registerTypeId();
+     * @endcode
+     *
+     * @return The identifier for the new type.
+     */
+    static Component::TypeId registerTypeId();
+
     /**
      * Constructor
      */
@@ -84,6 +114,30 @@ public:
      */
     std::shared_ptr<SceneObject> getObject() const;
 
+    /**
+     * Creates a copy of this component that is not attached to any object.
+     *
+     * Used by SceneObject::clone and Scene::instantiate. Components that
+     * hold large immutable data should share it with the copy rather than
+     * duplicate it. The copy should be created with
+     * Serializer::Activator::createShared so it comes from the arena of
+     * the instantiation.
+     *
+     * @return The copy or nullptr if the component can't be cloned.
+     */
+    virtual std::shared_ptr<Component> clone();
+
+    /**
+     * Gets the bounds of the component in the local space of its object.
+     *
+     * The bounds of an object are the union of the bounds of its components.
+     * Components without a spatial extent don't override this.
+     *
+     * @param bounds The box to store the bounds in.
+     * @return true if the component has bounds, false if not.
+     */
+    virtual bool getBounds(BoundingBox* bounds);
+
 protected:
 
     /**
@@ -93,9 +147,18 @@ protected:
      */
     virtual void setObject(std::shared_ptr<SceneObject> object);
 
-    std::weak_ptr<SceneObject> _object;
+    /**
+     * Notifies the object that the bounds of this component changed.
+     */
+    void setBoundsDirty();
+
+    SceneObjectHandle _object;
     bool _enabled;
 
+private:
+
+    size_t _poolIndex;
+
 };
 
 }
@@ -2,10 +2,19 @@
 #include "Frustum.h"
 #include "BoundingSphere.h"
 #include "BoundingBox.h"
+#include "MathUtil.h"
 
 namespace gameplay
 {
 
+const int Frustum::PLANE_NEAR;
+const int Frustum::PLANE_FAR;
+const int Frustum::PLANE_LEFT;
+const int Frustum::PLANE_RIGHT;
+const int Frustum::PLANE_BOTTOM;
+const int Frustum::PLANE_TOP;
+const int Frustum::PLANE_ALL;
+
 Frustum::Frustum()
 {
     set(Matrix::identity());
@@ -130,6 +139,47 @@ bool Frustum::intersects(const BoundingBox& box) const
     return box.intersects(*this);
 }
 
+bool Frustum::intersects(const BoundingBox& box, int* planeMask) const
+{
+    GP_ASSERT(planeMask);
+
+    const Plane* planes[6] = { &_near, &_far, &_left, &_right, &_bottom, &_top };
+    for (int i = 0; i < 6; ++i)
+    {
+        int plane = 1 << i;
+        if (!(*planeMask & plane))
+            continue;
+        float intersection = box.intersects(*planes[i]);
+        if (intersection == Plane::INTERSECTS_BACK)
+            return false;
+        if (intersection == Plane::INTERSECTS_FRONT)
+            *planeMask &= ~plane;
+    }
+    return true;
+}
+
+size_t Frustum::cullSpheres(const float* centerX, const float* centerY, const float* centerZ, const float* radius, size_t count,
+                            uint32_t* visibility, unsigned char* coherency, int planeMask) const
+{
+    GP_ASSERT((centerX && centerY && centerZ && radius && visibility) || count == 0);
+
+    float planes[24];
+    getPlanes(planes);
+    const float* spheres[4] = { centerX, centerY, centerZ, radius };
+    return MathUtil::cullSpheres(planes, planeMask, spheres, count, visibility, coherency);
+}
+
+size_t Frustum::cullBoxes(const float* minX, const float* minY, const float* minZ, const float* maxX, const float* maxY, const float* maxZ, size_t count,
+                          uint32_t* visibility, unsigned char* coherency, int planeMask) const
+{
+    GP_ASSERT((minX && minY && minZ && maxX && maxY && maxZ && visibility) || count == 0);
+
+    float planes[24];
+    getPlanes(planes);
+    const float* boxes[6] = { minX, minY, minZ, maxX, maxY, maxZ };
+    return MathUtil::cullBoxes(planes, planeMask, boxes, count, visibility, coherency);
+}
+
 void Frustum::set(const Frustum& frustum)
 {
     _near = frustum._near;
@@ -151,6 +201,20 @@ void Frustum::updatePlanes()
     _right.set(Vector3(_matrix.m[3] - _matrix.m[0], _matrix.m[7] - _matrix.m[4], _matrix.m[11] - _matrix.m[8]), _matrix.m[15] - _matrix.m[12]);
 }
 
+void Frustum::getPlanes(float* planes) const
+{
+    // In the order of the PLANE_* bits.
+    const Plane* source[6] = { &_near, &_far, &_left, &_right, &_bottom, &_top };
+    for (size_t i = 0; i < 6; ++i)
+    {
+        const Vector3& normal = source[i]->getNormal();
+        planes[i * 4] = normal.x;
+        planes[i * 4 + 1] = normal.y;
+        planes[i * 4 + 2] = normal.z;
+        planes[i * 4 + 3] = source[i]->getDistance();
+    }
+}
+
 void Frustum::set(const Matrix& matrix)
 {
     _matrix.set(matrix);
@@ -28,6 +28,41 @@ class Frustum
 {
 public:
 
+    /**
+     * The bit of the near plane in a plane mask.
+     */
+    static const int PLANE_NEAR = 1;
+
+    /**
+     * The bit of the far plane in a plane mask.
+     */
+    static const int PLANE_FAR = 2;
+
+    /**
+     * The bit of the left plane in a plane mask.
+     */
+    static const int PLANE_LEFT = 4;
+
+    /**
+     * The bit of the right plane in a plane mask.
+     */
+    static const int PLANE_RIGHT = 8;
+
+    /**
+     * The bit of the bottom plane in a plane mask.
+     */
+    static const int PLANE_BOTTOM = 16;
+
+    /**
+     * The bit of the top plane in a plane mask.
+     */
+    static const int PLANE_TOP = 32;
+
+    /**
+     * The plane mask of all six planes.
+     */
+    static const int PLANE_ALL = 63;
+
     /**
      * Constructor.
      */
@@ -189,6 +224,74 @@ public:
      */
     bool intersects(const BoundingBox& box) const;
 
+    /**
+     * Tests whether this frustum intersects the specified bounding box
+     * against some of its planes.
+     *
+     * The planes that the box is entirely in front of are cleared from the
+     * mask. Anything inside the box is in front of them too, so it only has
+     * to be tested against the planes left in the mask. A mask of zero means
+     * the box is entirely inside the frustum.
+     *
+     * @param box The bounding box to test intersection with.
+     * @param planeMask The planes to test, a combination of the PLANE_* bits.
+     *  It is set to the planes that the box crosses.
+     * @return true if the specified bounding box intersects the planes tested; false otherwise.
+     */
+    bool intersects(const BoundingBox& box, int* planeMask) const;
+
+    /**
+     * Culls an array of bounding spheres against this frustum.
+     *
+     * The spheres are given as one array per component and are tested
+     * several at a time with the SIMD instructions of the cpu. A sphere
+     * is visible where intersects(const BoundingSphere&) returns true.
+     *
+     * The spheres are culled in blocks of 32, one word of the bitset. The
+     * coherency array keeps for each block the plane that culled all of its
+     * spheres, which is tested alone first on the next call. Objects culled
+     * by a plane one frame are usually culled by it again the next, so such
+     * a block mostly takes a single plane test.
+     *
+     * @param centerX The x coordinate of the center of each sphere.
+     * @param centerY The y coordinate of the center of each sphere.
+     * @param centerZ The z coordinate of the center of each sphere.
+     * @param radius The radius of each sphere.
+     * @param count The number of spheres.
+     * @param visibility The bitset to store the results in, with bit i % 32 of word i / 32
+     *  set if sphere i is visible. It must hold (count + 31) / 32 words.
+     * @param coherency The array kept between calls for the blocks of spheres, or nullptr.
+     *  It must hold (count + 31) / 32 bytes that are zero before the first call.
+     * @param planeMask The planes to test, a combination of the PLANE_* bits. The planes
+     *  that all the spheres are known to be in front of can be left out.
+     * @return The number of visible spheres.
+     */
+    size_t cullSpheres(const float* centerX, const float* centerY, const float* centerZ, const float* radius, size_t count,
+                       uint32_t* visibility, unsigned char* coherency = nullptr, int planeMask = PLANE_ALL) const;
+
+    /**
+     * Culls an array of bounding boxes against this frustum.
+     *
+     * A box is visible where intersects(const BoundingBox&) returns true.
+     *
+     * @param minX The minimum x coordinate of each box.
+     * @param minY The minimum y coordinate of each box.
+     * @param minZ The minimum z coordinate of each box.
+     * @param maxX The maximum x coordinate of each box.
+     * @param maxY The maximum y coordinate of each box.
+     * @param maxZ The maximum z coordinate of each box.
+     * @param count The number of boxes.
+     * @param visibility The bitset to store the results in, with bit i % 32 of word i / 32
+     *  set if box i is visible. It must hold (count + 31) / 32 words.
+     * @param coherency The array kept between calls for the blocks of boxes, or nullptr.
+     *  It must hold (count + 31) / 32 bytes that are zero before the first call.
+     * @param planeMask The planes to test, a combination of the PLANE_* bits.
+     * @return The number of visible boxes.
+     * @see cullSpheres
+     */
+    size_t cullBoxes(const float* minX, const float* minY, const float* minZ, const float* maxX, const float* maxY, const float* maxZ, size_t count,
+                     uint32_t* visibility, unsigned char* coherency = nullptr, int planeMask = PLANE_ALL) const;
+
     /**
      * Sets this frustum to the specified frustum.
      *
@@ -211,6 +314,7 @@ public:
 private:
 
     void updatePlanes();
+    void getPlanes(float* planes) const;
 
     Plane _near;
     Plane _far;
@@ -27,7 +27,8 @@ Game::Game() :
 	_frameRate(0),
     _sceneLoading(nullptr),
 	_scene(nullptr),
-    _camera(nullptr)
+    _camera(nullptr),
+    _threadPool(nullptr)
 {
 	__gameInstance = this;
 }
@@ -132,27 +133,66 @@ std::shared_ptr<SceneObject> Game::getLoadingScene() const
 
 void Game::loadScene(const std::string& url, bool showLoading)
 {
-    // Unload any previous scene
+    // Unload any previous scene, which releases it and its arena too
     if (_scene.get() && (_scene != _sceneLoading) && (_scene != _sceneLoadingDefault))
-        _scene->unload();
+        unloadScene(_scene);
 
     // Set the loading scene and change states
     _scene = _sceneLoading;
     _state = Game::STATE_LOADING;
 
-    // 
-	//_scene = dynamic_cast<SceneObject*>(loadAsset(_config->sceneUrl.c_str()));
+    // Allocate the scene objects from an arena so that loading is a few large
+    // allocations and the memory is released together with the scene.
+    Serializer::Activator* activator = Serializer::getActivator();
+    std::shared_ptr<Arena> activatorArena = activator->getArena();
+    activator->setArena(std::make_shared<Arena>());
+    Serializer* reader = Serializer::createReader(url);
+    if (reader)
+    {
+        std::shared_ptr<SceneObject> scene = std::dynamic_pointer_cast<SceneObject>(reader->readObject(nullptr));
+        reader->close();
+        GP_SAFE_DELETE(reader);
+        if (scene)
+        {
+            _scenesLoaded[url] = scene;
+            scene->load();
+
+            // Objects are static unless the scene data says otherwise, so
+            // everything not marked as moving is baked here.
+            scene->getScene()->bake();
+
+            // The loading state runs until the current scene is loaded.
+            setScene(scene);
+        }
+    }
+    activator->setArena(activatorArena);
 	//_scene->onInitialize();
-	
 }
 
 void Game::unloadScene(std::shared_ptr<SceneObject> scene)
 {
+    if (!scene)
+        return;
+    scene->unload();
+
+    // Dropping the references releases the scene objects. The arena
+    // they were loaded into is freed with the last of them.
+    for (auto itr = _scenesLoaded.begin(); itr != _scenesLoaded.end();)
+    {
+        if (itr->second == scene)
+            itr = _scenesLoaded.erase(itr);
+        else
+            ++itr;
+    }
+    if (_scene == scene)
+        _scene = nullptr;
 }
 
 void Game::setScene(std::shared_ptr<SceneObject> scene)
 {
     _scene = scene;
+    if (_scene.get())
+        _scene->getScene()->setThreadPool(_threadPool);
 }
 
 std::shared_ptr<SceneObject> Game::getScene() const
@@ -174,6 +214,9 @@ void Game::onInitialize()
 {
 	_config = getConfig();
 	FileSystem::setAssetPath(_config->assetsPath);
+    _threadPool = std::make_shared<ThreadPool>(_config->threadCount);
+    if (_scene.get())
+        _scene->getScene()->setThreadPool(_threadPool);
 	
     // Splash screens
 
@@ -280,6 +323,8 @@ void Game::onFrame()
 		case Game::STATE_RUNNING:
 		{
 			onUpdate(elapsedTime);
+            if (_scene.get())
+                _scene->getScene()->updateTransforms();
 			onRender(elapsedTime);
             lastFrameTime = updateFrameRate();
 			break;
@@ -343,6 +388,11 @@ std::shared_ptr<Game::Config> Game::getConfig()
     return _config;
 }
 
+std::shared_ptr<ThreadPool> Game::getThreadPool() const
+{
+    return _threadPool;
+}
+
 Game::Config::Config() :
     title(""),
 	graphics(GP_GRAPHICS),
@@ -355,6 +405,7 @@ Game::Config::Config() :
 	touchSupport(false),
 	accelerometerSupport(false),
 	assetsPath(GP_ASSET_PATH),
+    threadCount(GP_THREAD_COUNT),
     loadingScene("loading.scene"),
 	mainScene("main.scene")
 {
@@ -387,6 +438,7 @@ void Game::Config::onSerialize(Serializer* serializer)
 	serializer->writeBool("touchSupport", touchSupport, false);
 	serializer->writeBool("accelerometerSupport", accelerometerSupport, false);
 	serializer->writeString("assetsPath", assetsPath.c_str(), "./");
+    serializer->writeInt("threadCount", (unsigned int)threadCount, GP_THREAD_COUNT);
     serializer->writeStringList("splashScreens", splashScreens.size());
     for (size_t i = 0; i < splashScreens.size(); i++)
     {
@@ -410,6 +462,9 @@ void Game::Config::onDeserialize(Serializer* serializer)
 	touchSupport = serializer->readBool("touchSupport", false);
 	accelerometerSupport = serializer->readBool("accelerometerSupport", false);
 	serializer->readString("assetsPath", assetsPath, "");
+    // A negative thread count is taken as 0, the number of hardware threads.
+    int threadCountValue = serializer->readInt("threadCount", GP_THREAD_COUNT);
+    threadCount = threadCountValue > 0 ? (size_t)threadCountValue : 0;
     size_t splashScreensCount = serializer->readStringList("splashScreens");
     for (size_t i = 0; i < splashScreensCount; i++)
     {
@@ -357,6 +357,7 @@ public:
 		bool touchSupport;
 		bool accelerometerSupport;
 		std::string assetsPath;
+        size_t threadCount;
         std::vector<SplashScreen> splashScreens;
         std::string loadingScene;
 		std::string mainScene;
@@ -369,6 +370,13 @@ public:
      */
     std::shared_ptr<Game::Config> getConfig();
 
+    /**
+     * Gets the thread pool used to split engine work across cores.
+     *
+     * @return The thread pool.
+     */
+    std::shared_ptr<ThreadPool> getThreadPool() const;
+
 private:
 
     Game(const Game& copy);
@@ -397,6 +405,7 @@ private:
     std::shared_ptr<SceneObject> _sceneLoading;
 	std::shared_ptr<SceneObject> _scene;
     std::shared_ptr<Camera> _camera;
+    std::shared_ptr<ThreadPool> _threadPool;
 };
 
 }
@@ -12,4 +12,14 @@ Geometry::~Geometry()
 {
 }
 
+const BoundingBox& Geometry::getBounds() const
+{
+    return _bounds;
+}
+
+void Geometry::setBounds(const BoundingBox& bounds)
+{
+    _bounds = bounds;
+}
+
 }
\ No newline at end of file
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "BoundingBox.h"
+
 namespace gameplay
 {
 
@@ -20,6 +22,24 @@ public:
      * Destructor.
      */
     ~Geometry();
+
+    /**
+     * Gets the bounds of the geometry.
+     *
+     * @return The bounds of the geometry.
+     */
+    const BoundingBox& getBounds() const;
+
+    /**
+     * Sets the bounds of the geometry.
+     *
+     * @param bounds The bounds of the geometry.
+     */
+    void setBounds(const BoundingBox& bounds);
+
+private:
+
+    BoundingBox _bounds;
 };
 
 }
@@ -8,6 +8,9 @@
 
 namespace gameplay
 {
+
+const Component::TypeId Light::TYPEID = Component::TYPEID_LIGHT;
+
 Light::Light() : Component(),
     _type(Light::TYPE_DIRECTIONAL),
     _color(LIGHT_COLOR),
@@ -128,7 +131,22 @@ void Light::reset(Light::Type type)
 
 Component::TypeId Light::getTypeId()
 {
-    return Component::TYPEID_LIGHT;
+    return TYPEID;
+}
+
+std::shared_ptr<Component> Light::clone()
+{
+    std::shared_ptr<Light> light = Serializer::getActivator()->createShared<Light>();
+    light->_enabled = _enabled;
+    light->_type = _type;
+    light->_color = _color;
+    light->_intensity = _intensity;
+    light->_range = _range;
+    light->_angle = _angle;
+    light->_angleCos = _angleCos;
+    light->_lighting = _lighting;
+    light->_shadows = _shadows;
+    return light;
 }
 
 std::string Light::getClassName()
@@ -194,7 +212,7 @@ void Light::onDeserialize(Serializer* serializer)
 
 std::shared_ptr<Serializable> Light::createObject()
 {
-    return std::static_pointer_cast<Serializable>(std::make_shared<Light>());
+    return std::static_pointer_cast<Serializable>(Serializer::getActivator()->createShared<Light>());
 }
 
 std::string Light::enumToString(const std::string& enumName, int value)
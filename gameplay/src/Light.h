@@ -178,11 +178,21 @@ public:
      */
     void reset(Light::Type type);
 
+    /**
+     * The component type identifier of this class.
+     */
+    static const Component::TypeId TYPEID;
+
     /**
      * @see Component::getTypeId
      */
     Component::TypeId getTypeId();
 
+    /**
+     * @see Component::clone
+     */
+    std::shared_ptr<Component> clone();
+
     /**
      * @see Serializable::getClassName
      */
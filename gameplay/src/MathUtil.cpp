@@ -1,9 +1,154 @@
 #include "Base.h"
 #include "MathUtil.h"
 
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define MATHUTIL_X86
+#elif defined(__aarch64__) || defined(_M_ARM64) || defined(__ARM_NEON)
+#define MATHUTIL_NEON
+#endif
+
+#include "MathUtilScalar.inl"
+#if defined(MATHUTIL_X86)
+#include "MathUtilSSE.inl"
+#include "MathUtilAVX.inl"
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#elif defined(MATHUTIL_NEON)
+#include "MathUtilNeon.inl"
+#endif
+
 namespace gameplay
 {
 
+// The kernels start out scalar so they are usable during static initialization
+// and are replaced below once the cpu features are known.
+void (*MathUtil::multiplyMatrix)(const float* m1, const float* m2, float* dst) = multiplyMatrixScalar;
+bool (*MathUtil::invertMatrix)(const float* m, float* dst) = invertMatrixScalar;
+void (*MathUtil::multiplyAffine)(const float* a1, const float* a2, float* dst) = multiplyAffineScalar;
+void (*MathUtil::transformVector3s)(const float* m, const float* v, size_t stride, size_t count, float w, float* dst, size_t dstStride) = transformVector3sScalar;
+void (*MathUtil::transformVector4s)(const float* m, const float* v, size_t stride, size_t count, float* dst, size_t dstStride) = transformVector4sScalar;
+size_t (*MathUtil::cullSpheres)(const float* planes, int planeMask, const float* const* spheres, size_t count, uint32_t* visibility, unsigned char* coherency) = cullSpheresScalar;
+size_t (*MathUtil::cullBoxes)(const float* planes, int planeMask, const float* const* boxes, size_t count, uint32_t* visibility, unsigned char* coherency) = cullBoxesScalar;
+void (*MathUtil::rasterizeTriangle)(const float* setup, float* depth, size_t stride, size_t width, size_t height) = rasterizeTriangleScalar;
+const char* MathUtil::_instructionSet = "scalar";
+
+#if defined(MATHUTIL_X86)
+static bool hasSSE4()
+{
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] & (1 << 19)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse4.1");
+#endif
+}
+
+static bool hasAVX2()
+{
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    bool fma = (info[2] & (1 << 12)) != 0;
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    if (!fma || !osxsave || (_xgetbv(0) & 6) != 6)
+        return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+}
+#endif
+
+bool MathUtil::initialize()
+{
+#if defined(MATHUTIL_X86)
+    return setInstructionSet(hasAVX2() ? "avx2" : hasSSE4() ? "sse4" : "scalar");
+#elif defined(MATHUTIL_NEON)
+    return setInstructionSet("neon");
+#else
+    return true;
+#endif
+}
+
+bool MathUtil::setInstructionSet(const char* instructionSet)
+{
+    GP_ASSERT(instructionSet);
+
+    std::string name(instructionSet);
+    bool supported = name == "scalar";
+#if defined(MATHUTIL_X86)
+    supported = supported || (name == "sse4" && hasSSE4()) || (name == "avx2" && hasAVX2());
+#elif defined(MATHUTIL_NEON)
+    supported = supported || name == "neon";
+#endif
+    if (!supported)
+        return false;
+
+    // Each instruction set starts from the kernels of the one below,
+    // so the kernels it doesn't have keep those.
+    multiplyMatrix = multiplyMatrixScalar;
+    invertMatrix = invertMatrixScalar;
+    multiplyAffine = multiplyAffineScalar;
+    transformVector3s = transformVector3sScalar;
+    transformVector4s = transformVector4sScalar;
+    cullSpheres = cullSpheresScalar;
+    cullBoxes = cullBoxesScalar;
+    rasterizeTriangle = rasterizeTriangleScalar;
+    _instructionSet = "scalar";
+#if defined(MATHUTIL_X86)
+    if (name == "sse4" || name == "avx2")
+    {
+        multiplyMatrix = multiplyMatrixSSE;
+        invertMatrix = invertMatrixSSE;
+        multiplyAffine = multiplyAffineSSE;
+        transformVector3s = transformVector3sSSE;
+        transformVector4s = transformVector4sSSE;
+        cullSpheres = cullSpheresSSE;
+        cullBoxes = cullBoxesSSE;
+        rasterizeTriangle = rasterizeTriangleSSE;
+        _instructionSet = "sse4";
+    }
+    if (name == "avx2")
+    {
+        // invertMatrix keeps the SSE kernel. Its division and the shuffles between
+        // the 128-bit lanes left a 256-bit version of it no faster.
+        multiplyMatrix = multiplyMatrixAVX;
+        multiplyAffine = multiplyAffineAVX;
+        transformVector3s = transformVector3sAVX;
+        transformVector4s = transformVector4sAVX;
+        cullSpheres = cullSpheresAVX;
+        cullBoxes = cullBoxesAVX;
+        rasterizeTriangle = rasterizeTriangleAVX;
+        _instructionSet = "avx2";
+    }
+#elif defined(MATHUTIL_NEON)
+    if (name == "neon")
+    {
+        multiplyMatrix = multiplyMatrixNeon;
+        multiplyAffine = multiplyAffineNeon;
+        transformVector3s = transformVector3sNeon;
+        transformVector4s = transformVector4sNeon;
+        cullSpheres = cullSpheresNeon;
+        cullBoxes = cullBoxesNeon;
+        rasterizeTriangle = rasterizeTriangleNeon;
+        _instructionSet = "neon";
+    }
+#endif
+    return true;
+}
+
+bool MathUtil::_initialized = MathUtil::initialize();
+
+const char* MathUtil::getInstructionSet()
+{
+    return _instructionSet;
+}
+
 void MathUtil::smooth(float* x, float target, float elapsedTime, float responseTime)
 {
     GP_ASSERT(x);
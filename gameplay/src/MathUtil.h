@@ -11,7 +11,10 @@ namespace gameplay
 class MathUtil
 {
     friend class Matrix;
+    friend class AffineTransform;
     friend class Vector3;
+    friend class Frustum;
+    friend class OcclusionCuller;
 
 public:
 
@@ -73,9 +76,43 @@ public:
 	* @param fallTime response time for falling slope (in the same units as elapsedTime).
 	*/
 	static void smooth(float* x, float target, float elapsedTime, float riseTime, float fallTime);
+
+    /**
+     * Gets the name of the instruction set the math kernels use.
+     *
+     * The kernels are selected at startup by detecting the cpu features.
+     *
+     * @return The instruction set name ("scalar", "sse4", "avx2" or "neon").
+     */
+    static const char* getInstructionSet();
+
+    /**
+     * Selects the math kernels of an instruction set.
+     *
+     * The fastest instruction set of the cpu is selected at startup. This selects
+     * a slower one instead, to compare the kernels or to measure them. The kernels
+     * are swapped without synchronization, so no other thread may use them meanwhile.
+     *
+     * @param instructionSet The instruction set name ("scalar", "sse4", "avx2" or "neon").
+     * @return true if the kernels were selected, false if the cpu doesn't support the instruction set.
+     */
+    static bool setInstructionSet(const char* instructionSet);
+
 private:
 
     MathUtil();
+    static bool initialize();
+
+    static void (*multiplyMatrix)(const float* m1, const float* m2, float* dst);
+    static bool (*invertMatrix)(const float* m, float* dst);
+    static void (*multiplyAffine)(const float* a1, const float* a2, float* dst);
+    static void (*transformVector3s)(const float* m, const float* v, size_t stride, size_t count, float w, float* dst, size_t dstStride);
+    static void (*transformVector4s)(const float* m, const float* v, size_t stride, size_t count, float* dst, size_t dstStride);
+    static size_t (*cullSpheres)(const float* planes, int planeMask, const float* const* spheres, size_t count, uint32_t* visibility, unsigned char* coherency);
+    static size_t (*cullBoxes)(const float* planes, int planeMask, const float* const* boxes, size_t count, uint32_t* visibility, unsigned char* coherency);
+    static void (*rasterizeTriangle)(const float* setup, float* depth, size_t stride, size_t width, size_t height);
+    static const char* _instructionSet;
+    static bool _initialized;
 };
 
 }
@@ -0,0 +1,258 @@
+#include <immintrin.h>
+
+#if defined(_MSC_VER)
+#define MATHUTIL_TARGET_AVX
+#define MATHUTIL_TARGET_AVX_EXACT
+#else
+#define MATHUTIL_TARGET_AVX __attribute__((target("avx2,fma")))
+// Without fma so the compiler cannot fuse the multiplies and adds that must round like the scalar code.
+#define MATHUTIL_TARGET_AVX_EXACT __attribute__((target("avx2")))
+#endif
+
+namespace gameplay
+{
+
+MATHUTIL_TARGET_AVX
+static void multiplyMatrixAVX(const float* m1, const float* m2, float* dst)
+{
+    // Both 128-bit lanes hold the same column of m1 and each lane
+    // computes one column of the product, so two columns per step.
+    __m256 c0 = _mm256_broadcast_ps((const __m128*)&m1[0]);
+    __m256 c1 = _mm256_broadcast_ps((const __m128*)&m1[4]);
+    __m256 c2 = _mm256_broadcast_ps((const __m128*)&m1[8]);
+    __m256 c3 = _mm256_broadcast_ps((const __m128*)&m1[12]);
+    __m256 b01 = _mm256_loadu_ps(&m2[0]);
+    __m256 b23 = _mm256_loadu_ps(&m2[8]);
+
+    __m256 r01 = _mm256_mul_ps(c0, _mm256_shuffle_ps(b01, b01, 0x00));
+    r01 = _mm256_fmadd_ps(c1, _mm256_shuffle_ps(b01, b01, 0x55), r01);
+    r01 = _mm256_fmadd_ps(c2, _mm256_shuffle_ps(b01, b01, 0xAA), r01);
+    r01 = _mm256_fmadd_ps(c3, _mm256_shuffle_ps(b01, b01, 0xFF), r01);
+
+    __m256 r23 = _mm256_mul_ps(c0, _mm256_shuffle_ps(b23, b23, 0x00));
+    r23 = _mm256_fmadd_ps(c1, _mm256_shuffle_ps(b23, b23, 0x55), r23);
+    r23 = _mm256_fmadd_ps(c2, _mm256_shuffle_ps(b23, b23, 0xAA), r23);
+    r23 = _mm256_fmadd_ps(c3, _mm256_shuffle_ps(b23, b23, 0xFF), r23);
+
+    _mm256_storeu_ps(&dst[0], r01);
+    _mm256_storeu_ps(&dst[8], r23);
+}
+
+MATHUTIL_TARGET_AVX
+static void multiplyAffineAVX(const float* a1, const float* a2, float* dst)
+{
+    // The 3x4 matrices are packed without padding. Two overlapping loads of
+    // eight floats cover each one and the columns are permuted out of them.
+    __m256 l1 = _mm256_loadu_ps(&a1[0]);
+    __m256 h1 = _mm256_loadu_ps(&a1[4]);
+    __m256 c0 = _mm256_permutevar8x32_ps(l1, _mm256_setr_epi32(0, 1, 2, 2, 0, 1, 2, 2));
+    __m256 c1 = _mm256_permutevar8x32_ps(l1, _mm256_setr_epi32(3, 4, 5, 5, 3, 4, 5, 5));
+    __m256 c2 = _mm256_permutevar8x32_ps(h1, _mm256_setr_epi32(2, 3, 4, 4, 2, 3, 4, 4));
+    __m256 c3 = _mm256_permutevar8x32_ps(h1, _mm256_setr_epi32(0, 0, 0, 0, 5, 6, 7, 7));
+
+    // Each 128-bit lane of b01 and b23 holds one column of a2.
+    __m256 b01 = _mm256_permutevar8x32_ps(_mm256_loadu_ps(&a2[0]), _mm256_setr_epi32(0, 1, 2, 2, 3, 4, 5, 5));
+    __m256 b23 = _mm256_permutevar8x32_ps(_mm256_loadu_ps(&a2[4]), _mm256_setr_epi32(2, 3, 4, 4, 5, 6, 7, 7));
+
+    __m256 r01 = _mm256_mul_ps(c0, _mm256_permute_ps(b01, 0x00));
+    r01 = _mm256_fmadd_ps(c1, _mm256_permute_ps(b01, 0x55), r01);
+    r01 = _mm256_fmadd_ps(c2, _mm256_permute_ps(b01, 0xAA), r01);
+
+    // Only the last column adds the translation of a1.
+    __m256 r23 = _mm256_fmadd_ps(c0, _mm256_permute_ps(b23, 0x00), _mm256_blend_ps(_mm256_setzero_ps(), c3, 0xF0));
+    r23 = _mm256_fmadd_ps(c1, _mm256_permute_ps(b23, 0x55), r23);
+    r23 = _mm256_fmadd_ps(c2, _mm256_permute_ps(b23, 0xAA), r23);
+
+    // Everything is loaded before storing to support dst being the same array as a1 or a2.
+    __m256 p0 = _mm256_permutevar8x32_ps(r01, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 6, 6));
+    __m256 p1 = _mm256_permutevar8x32_ps(r23, _mm256_setr_epi32(0, 0, 0, 0, 0, 0, 0, 1));
+    __m256 p2 = _mm256_permutevar8x32_ps(r23, _mm256_setr_epi32(2, 4, 5, 6, 6, 6, 6, 6));
+    _mm256_storeu_ps(&dst[0], _mm256_blend_ps(p0, p1, 0xC0));
+    _mm_storeu_ps(&dst[8], _mm256_castps256_ps128(p2));
+}
+
+
+MATHUTIL_TARGET_AVX
+static __m256 transformPairAVX(__m256 c0, __m256 c1, __m256 c2, __m256 c3, __m256 p)
+{
+    // Each 128-bit lane of p holds one vector.
+    __m256 r = _mm256_fmadd_ps(c0, _mm256_shuffle_ps(p, p, 0x00), c3);
+    r = _mm256_fmadd_ps(c1, _mm256_shuffle_ps(p, p, 0x55), r);
+    return _mm256_fmadd_ps(c2, _mm256_shuffle_ps(p, p, 0xAA), r);
+}
+
+MATHUTIL_TARGET_AVX
+static void transformVector3sAVX(const float* m, const float* v, size_t stride, size_t count, float w, float* dst, size_t dstStride)
+{
+    __m256 c0 = _mm256_broadcast_ps((const __m128*)&m[0]);
+    __m256 c1 = _mm256_broadcast_ps((const __m128*)&m[4]);
+    __m256 c2 = _mm256_broadcast_ps((const __m128*)&m[8]);
+    __m256 t = _mm256_mul_ps(_mm256_broadcast_ps((const __m128*)&m[12]), _mm256_set1_ps(w));
+    const char* src = (const char*)v;
+    char* out = (char*)dst;
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2, src += stride * 2, out += dstStride * 2)
+    {
+        __m128 p0 = loadVector3SSE((const float*)src);
+        __m128 p1 = loadVector3SSE((const float*)(src + stride));
+        __m256 r = transformPairAVX(c0, c1, c2, t, _mm256_insertf128_ps(_mm256_castps128_ps256(p0), p1, 1));
+        storeVector3SSE((float*)out, _mm256_castps256_ps128(r));
+        storeVector3SSE((float*)(out + dstStride), _mm256_extractf128_ps(r, 1));
+    }
+    if (i < count)
+    {
+        __m128 p = loadVector3SSE((const float*)src);
+        __m256 r = transformPairAVX(c0, c1, c2, t, _mm256_castps128_ps256(p));
+        storeVector3SSE((float*)out, _mm256_castps256_ps128(r));
+    }
+}
+
+MATHUTIL_TARGET_AVX
+static void transformVector4sAVX(const float* m, const float* v, size_t stride, size_t count, float* dst, size_t dstStride)
+{
+    __m256 c0 = _mm256_broadcast_ps((const __m128*)&m[0]);
+    __m256 c1 = _mm256_broadcast_ps((const __m128*)&m[4]);
+    __m256 c2 = _mm256_broadcast_ps((const __m128*)&m[8]);
+    __m256 c3 = _mm256_broadcast_ps((const __m128*)&m[12]);
+    const char* src = (const char*)v;
+    char* out = (char*)dst;
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2, src += stride * 2, out += dstStride * 2)
+    {
+        __m256 p = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps((const float*)src)),
+                                        _mm_loadu_ps((const float*)(src + stride)), 1);
+        __m256 r = _mm256_mul_ps(c3, _mm256_shuffle_ps(p, p, 0xFF));
+        r = transformPairAVX(c0, c1, c2, r, p);
+        _mm_storeu_ps((float*)out, _mm256_castps256_ps128(r));
+        _mm_storeu_ps((float*)(out + dstStride), _mm256_extractf128_ps(r, 1));
+    }
+    if (i < count)
+    {
+        __m128 p = _mm_loadu_ps((const float*)src);
+        __m128 r = _mm_mul_ps(_mm256_castps256_ps128(c3), _mm_shuffle_ps(p, p, 0xFF));
+        r = _mm_fmadd_ps(_mm256_castps256_ps128(c0), _mm_shuffle_ps(p, p, 0x00), r);
+        r = _mm_fmadd_ps(_mm256_castps256_ps128(c1), _mm_shuffle_ps(p, p, 0x55), r);
+        r = _mm_fmadd_ps(_mm256_castps256_ps128(c2), _mm_shuffle_ps(p, p, 0xAA), r);
+        _mm_storeu_ps((float*)out, r);
+    }
+}
+
+MATHUTIL_TARGET_AVX_EXACT
+static unsigned int cullRowAVX(const float* row, bool boxes, __m256 x, __m256 y, __m256 z, __m256 ex, __m256 ey, __m256 ez)
+{
+    const __m256 sign = _mm256_set1_ps(-0.0f);
+    __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(row[0]), x), _mm256_mul_ps(_mm256_set1_ps(row[1]), y)),
+                                                  _mm256_mul_ps(_mm256_set1_ps(row[2]), z)), _mm256_set1_ps(row[3]));
+    __m256 radius = ex;
+    if (boxes)
+    {
+        radius = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(ex, _mm256_set1_ps(row[4])), _mm256_mul_ps(ey, _mm256_set1_ps(row[5]))),
+                               _mm256_mul_ps(ez, _mm256_set1_ps(row[6])));
+    }
+    return (unsigned int)_mm256_movemask_ps(_mm256_cmp_ps(distance, _mm256_xor_ps(radius, sign), _CMP_LT_OQ));
+}
+
+MATHUTIL_TARGET_AVX_EXACT
+static uint32_t cullBlockAVX(const float* rows, size_t rowCount, const float* const* arrays, bool boxes,
+                             size_t begin, size_t end, unsigned int* wholeRows)
+{
+    // Each group is one register, see cullBlockScalar.
+    const __m256 half = _mm256_set1_ps(0.5f);
+    const __m256 sign = _mm256_set1_ps(-0.0f);
+    const float* group[6];
+    float tail[6][8];
+    __m256 x, y, z, ex, ey, ez;
+    unsigned int culledAll[6] = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+    uint32_t bits = 0;
+    for (size_t first = begin, shift = 0; first < end; first += 8, shift += 8)
+    {
+        unsigned int lanes = loadCullGroup(arrays, boxes ? 6 : 4, first, end, group, tail);
+        if (boxes)
+        {
+            __m256 minX = _mm256_loadu_ps(group[0]);
+            __m256 minY = _mm256_loadu_ps(group[1]);
+            __m256 minZ = _mm256_loadu_ps(group[2]);
+            __m256 maxX = _mm256_loadu_ps(group[3]);
+            __m256 maxY = _mm256_loadu_ps(group[4]);
+            __m256 maxZ = _mm256_loadu_ps(group[5]);
+            x = _mm256_mul_ps(_mm256_add_ps(minX, maxX), half);
+            y = _mm256_mul_ps(_mm256_add_ps(minY, maxY), half);
+            z = _mm256_mul_ps(_mm256_add_ps(minZ, maxZ), half);
+            ex = _mm256_andnot_ps(sign, _mm256_mul_ps(_mm256_sub_ps(maxX, minX), half));
+            ey = _mm256_andnot_ps(sign, _mm256_mul_ps(_mm256_sub_ps(maxY, minY), half));
+            ez = _mm256_andnot_ps(sign, _mm256_mul_ps(_mm256_sub_ps(maxZ, minZ), half));
+        }
+        else
+        {
+            x = _mm256_loadu_ps(group[0]);
+            y = _mm256_loadu_ps(group[1]);
+            z = _mm256_loadu_ps(group[2]);
+            ex = _mm256_loadu_ps(group[3]);
+            ey = _mm256_setzero_ps();
+            ez = _mm256_setzero_ps();
+        }
+
+        unsigned int padding = ~lanes & 0xFF;
+        unsigned int outside = padding;
+        for (size_t i = 0; i < rowCount; ++i)
+        {
+            unsigned int rowOutside = cullRowAVX(&rows[i * 8], boxes, x, y, z, ex, ey, ez) | padding;
+            outside |= rowOutside;
+            culledAll[i] &= rowOutside;
+        }
+        bits |= (uint32_t)(~outside & 0xFF) << shift;
+    }
+    *wholeRows = 0;
+    for (size_t i = 0; i < rowCount; ++i)
+    {
+        *wholeRows |= (unsigned int)(culledAll[i] == 0xFF) << i;
+    }
+    return bits;
+}
+
+MATHUTIL_TARGET_AVX_EXACT
+static size_t cullSpheresAVX(const float* planes, int planeMask, const float* const* spheres, size_t count, uint32_t* visibility, unsigned char* coherency)
+{
+    return cullBlocks(planes, planeMask, spheres, false, count, visibility, coherency, cullBlockAVX);
+}
+
+MATHUTIL_TARGET_AVX_EXACT
+static size_t cullBoxesAVX(const float* planes, int planeMask, const float* const* boxes, size_t count, uint32_t* visibility, unsigned char* coherency)
+{
+    return cullBlocks(planes, planeMask, boxes, true, count, visibility, coherency, cullBlockAVX);
+}
+
+MATHUTIL_TARGET_AVX_EXACT
+static void rasterizeTriangleAVX(const float* setup, float* depth, size_t stride, size_t width, size_t height)
+{
+    // Eight pixels of a row per step, the width is a multiple of eight.
+    __m256 a0 = _mm256_set1_ps(setup[0]);
+    __m256 a1 = _mm256_set1_ps(setup[1]);
+    __m256 a2 = _mm256_set1_ps(setup[2]);
+    __m256 dzdx = _mm256_set1_ps(setup[10]);
+    __m256 zmax = _mm256_set1_ps(setup[12]);
+    __m256 zero = _mm256_setzero_ps();
+    __m256 eight = _mm256_set1_ps(8.0f);
+    for (size_t y = 0; y < height; ++y, depth += stride)
+    {
+        float row = (float)y;
+        __m256 e0 = _mm256_set1_ps(setup[6] + setup[3] * row);
+        __m256 e1 = _mm256_set1_ps(setup[7] + setup[4] * row);
+        __m256 e2 = _mm256_set1_ps(setup[8] + setup[5] * row);
+        __m256 z = _mm256_set1_ps(setup[9] + setup[11] * row);
+        __m256 column = _mm256_set_ps(7.0f, 6.0f, 5.0f, 4.0f, 3.0f, 2.0f, 1.0f, 0.0f);
+        for (size_t x = 0; x < width; x += 8, column = _mm256_add_ps(column, eight))
+        {
+            __m256 inside = _mm256_and_ps(_mm256_cmp_ps(_mm256_add_ps(e0, _mm256_mul_ps(a0, column)), zero, _CMP_GE_OQ),
+                                          _mm256_cmp_ps(_mm256_add_ps(e1, _mm256_mul_ps(a1, column)), zero, _CMP_GE_OQ));
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_add_ps(e2, _mm256_mul_ps(a2, column)), zero, _CMP_GE_OQ));
+            if (_mm256_movemask_ps(inside) == 0)
+                continue;
+            __m256 pixel = _mm256_min_ps(_mm256_add_ps(z, _mm256_mul_ps(dzdx, column)), zmax);
+            __m256 d = _mm256_loadu_ps(&depth[x]);
+            _mm256_storeu_ps(&depth[x], _mm256_blendv_ps(d, _mm256_min_ps(d, pixel), inside));
+        }
+    }
+}
+
+}
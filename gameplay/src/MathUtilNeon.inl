@@ -0,0 +1,232 @@
+#include <arm_neon.h>
+
+namespace gameplay
+{
+
+static float32x4_t multiplyColumnNeon(float32x4_t c0, float32x4_t c1, float32x4_t c2, float32x4_t c3, float32x4_t b)
+{
+    float32x4_t r = vmulq_lane_f32(c0, vget_low_f32(b), 0);
+    r = vmlaq_lane_f32(r, c1, vget_low_f32(b), 1);
+    r = vmlaq_lane_f32(r, c2, vget_high_f32(b), 0);
+    return vmlaq_lane_f32(r, c3, vget_high_f32(b), 1);
+}
+
+static void multiplyMatrixNeon(const float* m1, const float* m2, float* dst)
+{
+    float32x4_t c0 = vld1q_f32(&m1[0]);
+    float32x4_t c1 = vld1q_f32(&m1[4]);
+    float32x4_t c2 = vld1q_f32(&m1[8]);
+    float32x4_t c3 = vld1q_f32(&m1[12]);
+
+    // Load everything before storing to support dst being the same array as m1 or m2.
+    float32x4_t b0 = vld1q_f32(&m2[0]);
+    float32x4_t b1 = vld1q_f32(&m2[4]);
+    float32x4_t b2 = vld1q_f32(&m2[8]);
+    float32x4_t b3 = vld1q_f32(&m2[12]);
+
+    vst1q_f32(&dst[0], multiplyColumnNeon(c0, c1, c2, c3, b0));
+    vst1q_f32(&dst[4], multiplyColumnNeon(c0, c1, c2, c3, b1));
+    vst1q_f32(&dst[8], multiplyColumnNeon(c0, c1, c2, c3, b2));
+    vst1q_f32(&dst[12], multiplyColumnNeon(c0, c1, c2, c3, b3));
+}
+
+
+static float32x4_t multiplyAffineColumnNeon(float32x4_t c0, float32x4_t c1, float32x4_t c2, float32x4_t b)
+{
+    float32x4_t r = vmulq_lane_f32(c0, vget_low_f32(b), 0);
+    r = vmlaq_lane_f32(r, c1, vget_low_f32(b), 1);
+    return vmlaq_lane_f32(r, c2, vget_high_f32(b), 0);
+}
+
+static void multiplyAffineNeon(const float* a1, const float* a2, float* dst)
+{
+    // The 3x4 matrices are packed without padding. They are read and written
+    // as three blocks of four floats and the columns are shifted out of them.
+    float32x4_t l0 = vld1q_f32(&a1[0]);
+    float32x4_t l1 = vld1q_f32(&a1[4]);
+    float32x4_t l2 = vld1q_f32(&a1[8]);
+    float32x4_t c0 = l0;
+    float32x4_t c1 = vextq_f32(l0, l1, 3);
+    float32x4_t c2 = vextq_f32(l1, l2, 2);
+    float32x4_t c3 = vextq_f32(l2, l2, 1);
+
+    // Load everything before storing to support dst being the same array as a1 or a2.
+    float32x4_t r0 = vld1q_f32(&a2[0]);
+    float32x4_t r1 = vld1q_f32(&a2[4]);
+    float32x4_t r2 = vld1q_f32(&a2[8]);
+    float32x4_t b0 = r0;
+    float32x4_t b1 = vextq_f32(r0, r1, 3);
+    float32x4_t b2 = vextq_f32(r1, r2, 2);
+    float32x4_t b3 = vextq_f32(r2, r2, 1);
+
+    float32x4_t p0 = multiplyAffineColumnNeon(c0, c1, c2, b0);
+    float32x4_t p1 = multiplyAffineColumnNeon(c0, c1, c2, b1);
+    float32x4_t p2 = multiplyAffineColumnNeon(c0, c1, c2, b2);
+    float32x4_t p3 = vaddq_f32(multiplyAffineColumnNeon(c0, c1, c2, b3), c3);
+
+    vst1q_f32(&dst[0], vsetq_lane_f32(vgetq_lane_f32(p1, 0), p0, 3));
+    vst1q_f32(&dst[4], vcombine_f32(vget_low_f32(vextq_f32(p1, p1, 1)), vget_low_f32(p2)));
+    vst1q_f32(&dst[8], vsetq_lane_f32(vgetq_lane_f32(p2, 2), vextq_f32(p3, p3, 3), 0));
+}
+
+static void transformVector3sNeon(const float* m, const float* v, size_t stride, size_t count, float w, float* dst, size_t dstStride)
+{
+    float32x4_t c0 = vld1q_f32(&m[0]);
+    float32x4_t c1 = vld1q_f32(&m[4]);
+    float32x4_t c2 = vld1q_f32(&m[8]);
+    float32x4_t t = vmulq_n_f32(vld1q_f32(&m[12]), w);
+    const char* src = (const char*)v;
+    char* out = (char*)dst;
+    for (size_t i = 0; i < count; ++i, src += stride, out += dstStride)
+    {
+        const float* p = (const float*)src;
+        float* d = (float*)out;
+        float32x4_t r = vmlaq_n_f32(t, c0, p[0]);
+        r = vmlaq_n_f32(r, c1, p[1]);
+        r = vmlaq_n_f32(r, c2, p[2]);
+        vst1_f32(d, vget_low_f32(r));
+        vst1q_lane_f32(&d[2], r, 2);
+    }
+}
+
+static void transformVector4sNeon(const float* m, const float* v, size_t stride, size_t count, float* dst, size_t dstStride)
+{
+    float32x4_t c0 = vld1q_f32(&m[0]);
+    float32x4_t c1 = vld1q_f32(&m[4]);
+    float32x4_t c2 = vld1q_f32(&m[8]);
+    float32x4_t c3 = vld1q_f32(&m[12]);
+    const char* src = (const char*)v;
+    char* out = (char*)dst;
+    for (size_t i = 0; i < count; ++i, src += stride, out += dstStride)
+    {
+        vst1q_f32((float*)out, multiplyColumnNeon(c0, c1, c2, c3, vld1q_f32((const float*)src)));
+    }
+}
+
+static unsigned int cullRowNeon(const float* row, bool boxes, const float32x4_t* x, const float32x4_t* y, const float32x4_t* z,
+                                const float32x4_t* ex, const float32x4_t* ey, const float32x4_t* ez)
+{
+    const uint32_t weightValues[4] = { 1, 2, 4, 8 };
+    const uint32x4_t weights = vld1q_u32(weightValues);
+    unsigned int outside = 0;
+    for (size_t i = 0; i < 2; ++i)
+    {
+        // Separate multiplies and adds rather than vmlaq so the rounding matches the scalar tests.
+        float32x4_t distance = vaddq_f32(vaddq_f32(vaddq_f32(vmulq_n_f32(x[i], row[0]), vmulq_n_f32(y[i], row[1])), vmulq_n_f32(z[i], row[2])),
+                                         vdupq_n_f32(row[3]));
+        float32x4_t radius = ex[i];
+        if (boxes)
+        {
+            radius = vaddq_f32(vaddq_f32(vmulq_n_f32(ex[i], row[4]), vmulq_n_f32(ey[i], row[5])), vmulq_n_f32(ez[i], row[6]));
+        }
+        uint32x4_t lanes = vandq_u32(vcltq_f32(distance, vnegq_f32(radius)), weights);
+        uint32x2_t sum = vpadd_u32(vget_low_u32(lanes), vget_high_u32(lanes));
+        sum = vpadd_u32(sum, sum);
+        outside |= vget_lane_u32(sum, 0) << (i * 4);
+    }
+    return outside;
+}
+
+static uint32_t cullBlockNeon(const float* rows, size_t rowCount, const float* const* arrays, bool boxes,
+                              size_t begin, size_t end, unsigned int* wholeRows)
+{
+    // Each group is two halves of four, see cullBlockScalar.
+    const float* group[6];
+    float tail[6][8];
+    float32x4_t x[2], y[2], z[2], ex[2], ey[2], ez[2];
+    unsigned int culledAll[6] = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+    uint32_t bits = 0;
+    for (size_t first = begin, shift = 0; first < end; first += 8, shift += 8)
+    {
+        unsigned int lanes = loadCullGroup(arrays, boxes ? 6 : 4, first, end, group, tail);
+        for (size_t i = 0; i < 2; ++i)
+        {
+            if (boxes)
+            {
+                float32x4_t minX = vld1q_f32(group[0] + i * 4);
+                float32x4_t minY = vld1q_f32(group[1] + i * 4);
+                float32x4_t minZ = vld1q_f32(group[2] + i * 4);
+                float32x4_t maxX = vld1q_f32(group[3] + i * 4);
+                float32x4_t maxY = vld1q_f32(group[4] + i * 4);
+                float32x4_t maxZ = vld1q_f32(group[5] + i * 4);
+                x[i] = vmulq_n_f32(vaddq_f32(minX, maxX), 0.5f);
+                y[i] = vmulq_n_f32(vaddq_f32(minY, maxY), 0.5f);
+                z[i] = vmulq_n_f32(vaddq_f32(minZ, maxZ), 0.5f);
+                ex[i] = vabsq_f32(vmulq_n_f32(vsubq_f32(maxX, minX), 0.5f));
+                ey[i] = vabsq_f32(vmulq_n_f32(vsubq_f32(maxY, minY), 0.5f));
+                ez[i] = vabsq_f32(vmulq_n_f32(vsubq_f32(maxZ, minZ), 0.5f));
+            }
+            else
+            {
+                x[i] = vld1q_f32(group[0] + i * 4);
+                y[i] = vld1q_f32(group[1] + i * 4);
+                z[i] = vld1q_f32(group[2] + i * 4);
+                ex[i] = vld1q_f32(group[3] + i * 4);
+                ey[i] = vdupq_n_f32(0.0f);
+                ez[i] = vdupq_n_f32(0.0f);
+            }
+        }
+
+        unsigned int padding = ~lanes & 0xFF;
+        unsigned int outside = padding;
+        for (size_t i = 0; i < rowCount; ++i)
+        {
+            unsigned int rowOutside = cullRowNeon(&rows[i * 8], boxes, x, y, z, ex, ey, ez) | padding;
+            outside |= rowOutside;
+            culledAll[i] &= rowOutside;
+        }
+        bits |= (uint32_t)(~outside & 0xFF) << shift;
+    }
+    *wholeRows = 0;
+    for (size_t i = 0; i < rowCount; ++i)
+    {
+        *wholeRows |= (unsigned int)(culledAll[i] == 0xFF) << i;
+    }
+    return bits;
+}
+
+static size_t cullSpheresNeon(const float* planes, int planeMask, const float* const* spheres, size_t count, uint32_t* visibility, unsigned char* coherency)
+{
+    return cullBlocks(planes, planeMask, spheres, false, count, visibility, coherency, cullBlockNeon);
+}
+
+static size_t cullBoxesNeon(const float* planes, int planeMask, const float* const* boxes, size_t count, uint32_t* visibility, unsigned char* coherency)
+{
+    return cullBlocks(planes, planeMask, boxes, true, count, visibility, coherency, cullBlockNeon);
+}
+
+static void rasterizeTriangleNeon(const float* setup, float* depth, size_t stride, size_t width, size_t height)
+{
+    // Four pixels of a row per step, the width is a multiple of eight.
+    static const float columns[4] = { 0.0f, 1.0f, 2.0f, 3.0f };
+    float32x4_t a0 = vdupq_n_f32(setup[0]);
+    float32x4_t a1 = vdupq_n_f32(setup[1]);
+    float32x4_t a2 = vdupq_n_f32(setup[2]);
+    float32x4_t dzdx = vdupq_n_f32(setup[10]);
+    float32x4_t zmax = vdupq_n_f32(setup[12]);
+    float32x4_t zero = vdupq_n_f32(0.0f);
+    float32x4_t four = vdupq_n_f32(4.0f);
+    for (size_t y = 0; y < height; ++y, depth += stride)
+    {
+        float row = (float)y;
+        float32x4_t e0 = vdupq_n_f32(setup[6] + setup[3] * row);
+        float32x4_t e1 = vdupq_n_f32(setup[7] + setup[4] * row);
+        float32x4_t e2 = vdupq_n_f32(setup[8] + setup[5] * row);
+        float32x4_t z = vdupq_n_f32(setup[9] + setup[11] * row);
+        float32x4_t column = vld1q_f32(columns);
+        for (size_t x = 0; x < width; x += 4, column = vaddq_f32(column, four))
+        {
+            uint32x4_t inside = vandq_u32(vcgeq_f32(vaddq_f32(e0, vmulq_f32(a0, column)), zero),
+                                          vcgeq_f32(vaddq_f32(e1, vmulq_f32(a1, column)), zero));
+            inside = vandq_u32(inside, vcgeq_f32(vaddq_f32(e2, vmulq_f32(a2, column)), zero));
+            uint32x2_t any = vorr_u32(vget_low_u32(inside), vget_high_u32(inside));
+            if ((vget_lane_u32(any, 0) | vget_lane_u32(any, 1)) == 0)
+                continue;
+            float32x4_t pixel = vminq_f32(vaddq_f32(z, vmulq_f32(dzdx, column)), zmax);
+            float32x4_t d = vld1q_f32(&depth[x]);
+            vst1q_f32(&depth[x], vbslq_f32(inside, vminq_f32(d, pixel), d));
+        }
+    }
+}
+
+}
@@ -0,0 +1,344 @@
+#include <immintrin.h>
+
+#if defined(_MSC_VER)
+#define MATHUTIL_TARGET_SSE
+#else
+#define MATHUTIL_TARGET_SSE __attribute__((target("sse4.1")))
+#endif
+
+#define MATHUTIL_SHUFFLE(v1, v2, x, y, z, w) _mm_shuffle_ps(v1, v2, _MM_SHUFFLE(w, z, y, x))
+#define MATHUTIL_SWIZZLE(v, x, y, z, w) MATHUTIL_SHUFFLE(v, v, x, y, z, w)
+
+namespace gameplay
+{
+
+MATHUTIL_TARGET_SSE
+static __m128 multiplyColumnSSE(__m128 c0, __m128 c1, __m128 c2, __m128 c3, __m128 b)
+{
+    return _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, MATHUTIL_SWIZZLE(b, 0, 0, 0, 0)),
+                                 _mm_mul_ps(c1, MATHUTIL_SWIZZLE(b, 1, 1, 1, 1))),
+                      _mm_add_ps(_mm_mul_ps(c2, MATHUTIL_SWIZZLE(b, 2, 2, 2, 2)),
+                                 _mm_mul_ps(c3, MATHUTIL_SWIZZLE(b, 3, 3, 3, 3))));
+}
+
+MATHUTIL_TARGET_SSE
+static void multiplyMatrixSSE(const float* m1, const float* m2, float* dst)
+{
+    __m128 c0 = _mm_loadu_ps(&m1[0]);
+    __m128 c1 = _mm_loadu_ps(&m1[4]);
+    __m128 c2 = _mm_loadu_ps(&m1[8]);
+    __m128 c3 = _mm_loadu_ps(&m1[12]);
+
+    // Load everything before storing to support dst being the same array as m1 or m2.
+    __m128 b0 = _mm_loadu_ps(&m2[0]);
+    __m128 b1 = _mm_loadu_ps(&m2[4]);
+    __m128 b2 = _mm_loadu_ps(&m2[8]);
+    __m128 b3 = _mm_loadu_ps(&m2[12]);
+
+    _mm_storeu_ps(&dst[0], multiplyColumnSSE(c0, c1, c2, c3, b0));
+    _mm_storeu_ps(&dst[4], multiplyColumnSSE(c0, c1, c2, c3, b1));
+    _mm_storeu_ps(&dst[8], multiplyColumnSSE(c0, c1, c2, c3, b2));
+    _mm_storeu_ps(&dst[12], multiplyColumnSSE(c0, c1, c2, c3, b3));
+}
+
+MATHUTIL_TARGET_SSE
+static __m128 multiplyAffineColumnSSE(__m128 c0, __m128 c1, __m128 c2, __m128 b)
+{
+    return _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, MATHUTIL_SWIZZLE(b, 0, 0, 0, 0)),
+                                 _mm_mul_ps(c1, MATHUTIL_SWIZZLE(b, 1, 1, 1, 1))),
+                      _mm_mul_ps(c2, MATHUTIL_SWIZZLE(b, 2, 2, 2, 2)));
+}
+
+MATHUTIL_TARGET_SSE
+static void multiplyAffineSSE(const float* a1, const float* a2, float* dst)
+{
+    // The 3x4 matrices are packed without padding. They are read and written
+    // as three aligned blocks of four floats and the columns are shifted out
+    // of them, which keeps the loads clear of partially overlapping stores.
+    __m128i l0 = _mm_castps_si128(_mm_loadu_ps(&a1[0]));
+    __m128i l1 = _mm_castps_si128(_mm_loadu_ps(&a1[4]));
+    __m128i l2 = _mm_castps_si128(_mm_loadu_ps(&a1[8]));
+    __m128 c0 = _mm_castsi128_ps(l0);
+    __m128 c1 = _mm_castsi128_ps(_mm_alignr_epi8(l1, l0, 12));
+    __m128 c2 = _mm_castsi128_ps(_mm_alignr_epi8(l2, l1, 8));
+    __m128 c3 = _mm_castsi128_ps(_mm_srli_si128(l2, 4));
+
+    // Load everything before storing to support dst being the same array as a1 or a2.
+    __m128i r0 = _mm_castps_si128(_mm_loadu_ps(&a2[0]));
+    __m128i r1 = _mm_castps_si128(_mm_loadu_ps(&a2[4]));
+    __m128i r2 = _mm_castps_si128(_mm_loadu_ps(&a2[8]));
+    __m128 b0 = _mm_castsi128_ps(r0);
+    __m128 b1 = _mm_castsi128_ps(_mm_alignr_epi8(r1, r0, 12));
+    __m128 b2 = _mm_castsi128_ps(_mm_alignr_epi8(r2, r1, 8));
+    __m128 b3 = _mm_castsi128_ps(_mm_srli_si128(r2, 4));
+
+    __m128 p0 = multiplyAffineColumnSSE(c0, c1, c2, b0);
+    __m128 p1 = multiplyAffineColumnSSE(c0, c1, c2, b1);
+    __m128 p2 = multiplyAffineColumnSSE(c0, c1, c2, b2);
+    __m128 p3 = _mm_add_ps(multiplyAffineColumnSSE(c0, c1, c2, b3), c3);
+
+    _mm_storeu_ps(&dst[0], _mm_blend_ps(p0, MATHUTIL_SWIZZLE(p1, 0, 0, 0, 0), 8));
+    _mm_storeu_ps(&dst[4], MATHUTIL_SHUFFLE(p1, p2, 1, 2, 0, 1));
+    _mm_storeu_ps(&dst[8], _mm_blend_ps(MATHUTIL_SWIZZLE(p3, 0, 0, 1, 2), MATHUTIL_SWIZZLE(p2, 2, 2, 2, 2), 1));
+}
+
+// 2x2 matrix helpers for the block inverse. The 2x2 matrices are packed as (m00, m01, m10, m11).
+
+MATHUTIL_TARGET_SSE
+static __m128 multiply2x2SSE(__m128 a, __m128 b)
+{
+    return _mm_add_ps(_mm_mul_ps(a, MATHUTIL_SWIZZLE(b, 0, 3, 0, 3)),
+                      _mm_mul_ps(MATHUTIL_SWIZZLE(a, 1, 0, 3, 2), MATHUTIL_SWIZZLE(b, 2, 1, 2, 1)));
+}
+
+MATHUTIL_TARGET_SSE
+static __m128 multiplyAdjugate2x2SSE(__m128 a, __m128 b)
+{
+    // adjugate(a) * b
+    return _mm_sub_ps(_mm_mul_ps(MATHUTIL_SWIZZLE(a, 3, 3, 0, 0), b),
+                      _mm_mul_ps(MATHUTIL_SWIZZLE(a, 1, 1, 2, 2), MATHUTIL_SWIZZLE(b, 2, 3, 0, 1)));
+}
+
+MATHUTIL_TARGET_SSE
+static __m128 multiply2x2AdjugateSSE(__m128 a, __m128 b)
+{
+    // a * adjugate(b)
+    return _mm_sub_ps(_mm_mul_ps(a, MATHUTIL_SWIZZLE(b, 3, 0, 3, 0)),
+                      _mm_mul_ps(MATHUTIL_SWIZZLE(a, 1, 0, 3, 2), MATHUTIL_SWIZZLE(b, 2, 1, 2, 1)));
+}
+
+MATHUTIL_TARGET_SSE
+static bool invertMatrixSSE(const float* m, float* dst)
+{
+    // Block inverse over the 2x2 sub matrices | A B |
+    //                                         | C D |
+    // Inverting the transpose gives the transpose of the inverse,
+    // so the same steps work on the column major storage.
+    __m128 c0 = _mm_loadu_ps(&m[0]);
+    __m128 c1 = _mm_loadu_ps(&m[4]);
+    __m128 c2 = _mm_loadu_ps(&m[8]);
+    __m128 c3 = _mm_loadu_ps(&m[12]);
+
+    __m128 a = _mm_movelh_ps(c0, c1);
+    __m128 b = _mm_movehl_ps(c1, c0);
+    __m128 c = _mm_movelh_ps(c2, c3);
+    __m128 d = _mm_movehl_ps(c3, c2);
+
+    // The determinants of the sub matrices as (|A|, |B|, |C|, |D|).
+    __m128 detSub = _mm_sub_ps(_mm_mul_ps(MATHUTIL_SHUFFLE(c0, c2, 0, 2, 0, 2), MATHUTIL_SHUFFLE(c1, c3, 1, 3, 1, 3)),
+                               _mm_mul_ps(MATHUTIL_SHUFFLE(c0, c2, 1, 3, 1, 3), MATHUTIL_SHUFFLE(c1, c3, 0, 2, 0, 2)));
+    __m128 detA = MATHUTIL_SWIZZLE(detSub, 0, 0, 0, 0);
+    __m128 detB = MATHUTIL_SWIZZLE(detSub, 1, 1, 1, 1);
+    __m128 detC = MATHUTIL_SWIZZLE(detSub, 2, 2, 2, 2);
+    __m128 detD = MATHUTIL_SWIZZLE(detSub, 3, 3, 3, 3);
+
+    __m128 dc = multiplyAdjugate2x2SSE(d, c);
+    __m128 ab = multiplyAdjugate2x2SSE(a, b);
+    __m128 x = _mm_sub_ps(_mm_mul_ps(detD, a), multiply2x2SSE(b, dc));
+    __m128 w = _mm_sub_ps(_mm_mul_ps(detA, d), multiply2x2SSE(c, ab));
+    __m128 y = _mm_sub_ps(_mm_mul_ps(detB, c), multiply2x2AdjugateSSE(d, ab));
+    __m128 z = _mm_sub_ps(_mm_mul_ps(detC, b), multiply2x2AdjugateSSE(a, dc));
+
+    // |M| = |A||D| + |B||C| - trace((A#B)(D#C))
+    __m128 trace = _mm_mul_ps(ab, MATHUTIL_SWIZZLE(dc, 0, 2, 1, 3));
+    trace = _mm_hadd_ps(trace, trace);
+    trace = _mm_hadd_ps(trace, trace);
+    __m128 det = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC)), trace);
+
+    // Close to zero, can't invert.
+    if (std::fabs(_mm_cvtss_f32(det)) <= GP_MATH_TOLERANCE)
+        return false;
+
+    __m128 invDet = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), det);
+    x = _mm_mul_ps(x, invDet);
+    y = _mm_mul_ps(y, invDet);
+    z = _mm_mul_ps(z, invDet);
+    w = _mm_mul_ps(w, invDet);
+
+    // Apply the adjugate of each block while storing.
+    _mm_storeu_ps(&dst[0], MATHUTIL_SHUFFLE(x, y, 3, 1, 3, 1));
+    _mm_storeu_ps(&dst[4], MATHUTIL_SHUFFLE(x, y, 2, 0, 2, 0));
+    _mm_storeu_ps(&dst[8], MATHUTIL_SHUFFLE(z, w, 3, 1, 3, 1));
+    _mm_storeu_ps(&dst[12], MATHUTIL_SHUFFLE(z, w, 2, 0, 2, 0));
+    return true;
+}
+
+
+MATHUTIL_TARGET_SSE
+static __m128 loadVector3SSE(const float* v)
+{
+    // Only reads three floats so the last element of an array is safe to load.
+    // The first two go through the 64 bit integer load, which allows any alignment.
+    __m128 xy = _mm_castsi128_ps(_mm_loadl_epi64((const __m128i*)v));
+    return _mm_movelh_ps(xy, _mm_load_ss(&v[2]));
+}
+
+MATHUTIL_TARGET_SSE
+static void storeVector3SSE(float* dst, __m128 v)
+{
+    _mm_storel_epi64((__m128i*)dst, _mm_castps_si128(v));
+    _mm_store_ss(&dst[2], _mm_movehl_ps(v, v));
+}
+
+MATHUTIL_TARGET_SSE
+static void transformVector3sSSE(const float* m, const float* v, size_t stride, size_t count, float w, float* dst, size_t dstStride)
+{
+    __m128 c0 = _mm_loadu_ps(&m[0]);
+    __m128 c1 = _mm_loadu_ps(&m[4]);
+    __m128 c2 = _mm_loadu_ps(&m[8]);
+    __m128 t = _mm_mul_ps(_mm_loadu_ps(&m[12]), _mm_set1_ps(w));
+    const char* src = (const char*)v;
+    char* out = (char*)dst;
+    for (size_t i = 0; i < count; ++i, src += stride, out += dstStride)
+    {
+        __m128 p = loadVector3SSE((const float*)src);
+        __m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, MATHUTIL_SWIZZLE(p, 0, 0, 0, 0)),
+                                         _mm_mul_ps(c1, MATHUTIL_SWIZZLE(p, 1, 1, 1, 1))),
+                              _mm_add_ps(_mm_mul_ps(c2, MATHUTIL_SWIZZLE(p, 2, 2, 2, 2)), t));
+        storeVector3SSE((float*)out, r);
+    }
+}
+
+MATHUTIL_TARGET_SSE
+static void transformVector4sSSE(const float* m, const float* v, size_t stride, size_t count, float* dst, size_t dstStride)
+{
+    __m128 c0 = _mm_loadu_ps(&m[0]);
+    __m128 c1 = _mm_loadu_ps(&m[4]);
+    __m128 c2 = _mm_loadu_ps(&m[8]);
+    __m128 c3 = _mm_loadu_ps(&m[12]);
+    const char* src = (const char*)v;
+    char* out = (char*)dst;
+    for (size_t i = 0; i < count; ++i, src += stride, out += dstStride)
+    {
+        __m128 p = _mm_loadu_ps((const float*)src);
+        _mm_storeu_ps((float*)out, multiplyColumnSSE(c0, c1, c2, c3, p));
+    }
+}
+
+MATHUTIL_TARGET_SSE
+static unsigned int cullRowSSE(const float* row, bool boxes, const __m128* x, const __m128* y, const __m128* z, const __m128* ex, const __m128* ey, const __m128* ez)
+{
+    const __m128 sign = _mm_set1_ps(-0.0f);
+    unsigned int outside = 0;
+    for (size_t i = 0; i < 2; ++i)
+    {
+        __m128 distance = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(row[0]), x[i]), _mm_mul_ps(_mm_set1_ps(row[1]), y[i])),
+                                                _mm_mul_ps(_mm_set1_ps(row[2]), z[i])), _mm_set1_ps(row[3]));
+        __m128 radius = ex[i];
+        if (boxes)
+        {
+            radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ex[i], _mm_set1_ps(row[4])), _mm_mul_ps(ey[i], _mm_set1_ps(row[5]))),
+                                _mm_mul_ps(ez[i], _mm_set1_ps(row[6])));
+        }
+        outside |= (unsigned int)_mm_movemask_ps(_mm_cmplt_ps(distance, _mm_xor_ps(radius, sign))) << (i * 4);
+    }
+    return outside;
+}
+
+MATHUTIL_TARGET_SSE
+static uint32_t cullBlockSSE(const float* rows, size_t rowCount, const float* const* arrays, bool boxes,
+                             size_t begin, size_t end, unsigned int* wholeRows)
+{
+    // Each group is two halves of four, see cullBlockScalar.
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 sign = _mm_set1_ps(-0.0f);
+    const float* group[6];
+    float tail[6][8];
+    __m128 x[2], y[2], z[2], ex[2], ey[2], ez[2];
+    unsigned int culledAll[6] = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+    uint32_t bits = 0;
+    for (size_t first = begin, shift = 0; first < end; first += 8, shift += 8)
+    {
+        unsigned int lanes = loadCullGroup(arrays, boxes ? 6 : 4, first, end, group, tail);
+        for (size_t i = 0; i < 2; ++i)
+        {
+            if (boxes)
+            {
+                __m128 minX = _mm_loadu_ps(group[0] + i * 4);
+                __m128 minY = _mm_loadu_ps(group[1] + i * 4);
+                __m128 minZ = _mm_loadu_ps(group[2] + i * 4);
+                __m128 maxX = _mm_loadu_ps(group[3] + i * 4);
+                __m128 maxY = _mm_loadu_ps(group[4] + i * 4);
+                __m128 maxZ = _mm_loadu_ps(group[5] + i * 4);
+                x[i] = _mm_mul_ps(_mm_add_ps(minX, maxX), half);
+                y[i] = _mm_mul_ps(_mm_add_ps(minY, maxY), half);
+                z[i] = _mm_mul_ps(_mm_add_ps(minZ, maxZ), half);
+                ex[i] = _mm_andnot_ps(sign, _mm_mul_ps(_mm_sub_ps(maxX, minX), half));
+                ey[i] = _mm_andnot_ps(sign, _mm_mul_ps(_mm_sub_ps(maxY, minY), half));
+                ez[i] = _mm_andnot_ps(sign, _mm_mul_ps(_mm_sub_ps(maxZ, minZ), half));
+            }
+            else
+            {
+                x[i] = _mm_loadu_ps(group[0] + i * 4);
+                y[i] = _mm_loadu_ps(group[1] + i * 4);
+                z[i] = _mm_loadu_ps(group[2] + i * 4);
+                ex[i] = _mm_loadu_ps(group[3] + i * 4);
+                ey[i] = _mm_setzero_ps();
+                ez[i] = _mm_setzero_ps();
+            }
+        }
+
+        unsigned int padding = ~lanes & 0xFF;
+        unsigned int outside = padding;
+        for (size_t i = 0; i < rowCount; ++i)
+        {
+            unsigned int rowOutside = cullRowSSE(&rows[i * 8], boxes, x, y, z, ex, ey, ez) | padding;
+            outside |= rowOutside;
+            culledAll[i] &= rowOutside;
+        }
+        bits |= (uint32_t)(~outside & 0xFF) << shift;
+    }
+    *wholeRows = 0;
+    for (size_t i = 0; i < rowCount; ++i)
+    {
+        *wholeRows |= (unsigned int)(culledAll[i] == 0xFF) << i;
+    }
+    return bits;
+}
+
+MATHUTIL_TARGET_SSE
+static size_t cullSpheresSSE(const float* planes, int planeMask, const float* const* spheres, size_t count, uint32_t* visibility, unsigned char* coherency)
+{
+    return cullBlocks(planes, planeMask, spheres, false, count, visibility, coherency, cullBlockSSE);
+}
+
+MATHUTIL_TARGET_SSE
+static size_t cullBoxesSSE(const float* planes, int planeMask, const float* const* boxes, size_t count, uint32_t* visibility, unsigned char* coherency)
+{
+    return cullBlocks(planes, planeMask, boxes, true, count, visibility, coherency, cullBlockSSE);
+}
+
+MATHUTIL_TARGET_SSE
+static void rasterizeTriangleSSE(const float* setup, float* depth, size_t stride, size_t width, size_t height)
+{
+    // Four pixels of a row per step, the width is a multiple of eight.
+    __m128 a0 = _mm_set1_ps(setup[0]);
+    __m128 a1 = _mm_set1_ps(setup[1]);
+    __m128 a2 = _mm_set1_ps(setup[2]);
+    __m128 dzdx = _mm_set1_ps(setup[10]);
+    __m128 zmax = _mm_set1_ps(setup[12]);
+    __m128 zero = _mm_setzero_ps();
+    for (size_t y = 0; y < height; ++y, depth += stride)
+    {
+        float row = (float)y;
+        __m128 e0 = _mm_set1_ps(setup[6] + setup[3] * row);
+        __m128 e1 = _mm_set1_ps(setup[7] + setup[4] * row);
+        __m128 e2 = _mm_set1_ps(setup[8] + setup[5] * row);
+        __m128 z = _mm_set1_ps(setup[9] + setup[11] * row);
+        __m128 column = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+        __m128 four = _mm_set1_ps(4.0f);
+        for (size_t x = 0; x < width; x += 4, column = _mm_add_ps(column, four))
+        {
+            __m128 inside = _mm_and_ps(_mm_cmpge_ps(_mm_add_ps(e0, _mm_mul_ps(a0, column)), zero),
+                                       _mm_cmpge_ps(_mm_add_ps(e1, _mm_mul_ps(a1, column)), zero));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(e2, _mm_mul_ps(a2, column)), zero));
+            if (_mm_movemask_ps(inside) == 0)
+                continue;
+            __m128 pixel = _mm_min_ps(_mm_add_ps(z, _mm_mul_ps(dzdx, column)), zmax);
+            __m128 d = _mm_loadu_ps(&depth[x]);
+            _mm_storeu_ps(&depth[x], _mm_blendv_ps(d, _mm_min_ps(d, pixel), inside));
+        }
+    }
+}
+
+}
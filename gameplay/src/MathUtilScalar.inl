@@ -0,0 +1,348 @@
+namespace gameplay
+{
+
+static void multiplyMatrixScalar(const float* m1, const float* m2, float* dst)
+{
+    // Support the case where m1 or m2 is the same array as dst.
+    float product[16];
+    product[0]  = m1[0] * m2[0]  + m1[4] * m2[1] + m1[8]   * m2[2]  + m1[12] * m2[3];
+    product[1]  = m1[1] * m2[0]  + m1[5] * m2[1] + m1[9]   * m2[2]  + m1[13] * m2[3];
+    product[2]  = m1[2] * m2[0]  + m1[6] * m2[1] + m1[10]  * m2[2]  + m1[14] * m2[3];
+    product[3]  = m1[3] * m2[0]  + m1[7] * m2[1] + m1[11]  * m2[2]  + m1[15] * m2[3];
+
+    product[4]  = m1[0] * m2[4]  + m1[4] * m2[5] + m1[8]   * m2[6]  + m1[12] * m2[7];
+    product[5]  = m1[1] * m2[4]  + m1[5] * m2[5] + m1[9]   * m2[6]  + m1[13] * m2[7];
+    product[6]  = m1[2] * m2[4]  + m1[6] * m2[5] + m1[10]  * m2[6]  + m1[14] * m2[7];
+    product[7]  = m1[3] * m2[4]  + m1[7] * m2[5] + m1[11]  * m2[6]  + m1[15] * m2[7];
+
+    product[8]  = m1[0] * m2[8]  + m1[4] * m2[9] + m1[8]   * m2[10] + m1[12] * m2[11];
+    product[9]  = m1[1] * m2[8]  + m1[5] * m2[9] + m1[9]   * m2[10] + m1[13] * m2[11];
+    product[10] = m1[2] * m2[8]  + m1[6] * m2[9] + m1[10]  * m2[10] + m1[14] * m2[11];
+    product[11] = m1[3] * m2[8]  + m1[7] * m2[9] + m1[11]  * m2[10] + m1[15] * m2[11];
+
+    product[12] = m1[0] * m2[12] + m1[4] * m2[13] + m1[8]  * m2[14] + m1[12] * m2[15];
+    product[13] = m1[1] * m2[12] + m1[5] * m2[13] + m1[9]  * m2[14] + m1[13] * m2[15];
+    product[14] = m1[2] * m2[12] + m1[6] * m2[13] + m1[10] * m2[14] + m1[14] * m2[15];
+    product[15] = m1[3] * m2[12] + m1[7] * m2[13] + m1[11] * m2[14] + m1[15] * m2[15];
+
+    std::memcpy(dst, product, GP_MATH_MATRIX_SIZE);
+}
+
+static bool invertMatrixScalar(const float* m, float* dst)
+{
+    float a0 = m[0] * m[5] - m[1] * m[4];
+    float a1 = m[0] * m[6] - m[2] * m[4];
+    float a2 = m[0] * m[7] - m[3] * m[4];
+    float a3 = m[1] * m[6] - m[2] * m[5];
+    float a4 = m[1] * m[7] - m[3] * m[5];
+    float a5 = m[2] * m[7] - m[3] * m[6];
+    float b0 = m[8] * m[13] - m[9] * m[12];
+    float b1 = m[8] * m[14] - m[10] * m[12];
+    float b2 = m[8] * m[15] - m[11] * m[12];
+    float b3 = m[9] * m[14] - m[10] * m[13];
+    float b4 = m[9] * m[15] - m[11] * m[13];
+    float b5 = m[10] * m[15] - m[11] * m[14];
+
+    // Calculate the determinant.
+    float det = a0 * b5 - a1 * b4 + a2 * b3 + a3 * b2 - a4 * b1 + a5 * b0;
+
+    // Close to zero, can't invert.
+    if (std::fabs(det) <= GP_MATH_TOLERANCE)
+        return false;
+
+    // Support the case where m == dst.
+    float inverse[16];
+    inverse[0]  = m[5] * b5 - m[6] * b4 + m[7] * b3;
+    inverse[1]  = -m[1] * b5 + m[2] * b4 - m[3] * b3;
+    inverse[2]  = m[13] * a5 - m[14] * a4 + m[15] * a3;
+    inverse[3]  = -m[9] * a5 + m[10] * a4 - m[11] * a3;
+
+    inverse[4]  = -m[4] * b5 + m[6] * b2 - m[7] * b1;
+    inverse[5]  = m[0] * b5 - m[2] * b2 + m[3] * b1;
+    inverse[6]  = -m[12] * a5 + m[14] * a2 - m[15] * a1;
+    inverse[7]  = m[8] * a5 - m[10] * a2 + m[11] * a1;
+
+    inverse[8]  = m[4] * b4 - m[5] * b2 + m[7] * b0;
+    inverse[9]  = -m[0] * b4 + m[1] * b2 - m[3] * b0;
+    inverse[10] = m[12] * a4 - m[13] * a2 + m[15] * a0;
+    inverse[11] = -m[8] * a4 + m[9] * a2 - m[11] * a0;
+
+    inverse[12] = -m[4] * b3 + m[5] * b1 - m[6] * b0;
+    inverse[13] = m[0] * b3 - m[1] * b1 + m[2] * b0;
+    inverse[14] = -m[12] * a3 + m[13] * a1 - m[14] * a0;
+    inverse[15] = m[8] * a3 - m[9] * a1 + m[10] * a0;
+
+    float invDet = 1.0f / det;
+    for (size_t i = 0; i < 16; ++i)
+    {
+        dst[i] = inverse[i] * invDet;
+    }
+    return true;
+}
+
+
+static void multiplyAffineScalar(const float* a1, const float* a2, float* dst)
+{
+    // Support the case where a1 or a2 is the same array as dst.
+    float product[12];
+    product[0]  = a1[0] * a2[0]  + a1[3] * a2[1]  + a1[6] * a2[2];
+    product[1]  = a1[1] * a2[0]  + a1[4] * a2[1]  + a1[7] * a2[2];
+    product[2]  = a1[2] * a2[0]  + a1[5] * a2[1]  + a1[8] * a2[2];
+
+    product[3]  = a1[0] * a2[3]  + a1[3] * a2[4]  + a1[6] * a2[5];
+    product[4]  = a1[1] * a2[3]  + a1[4] * a2[4]  + a1[7] * a2[5];
+    product[5]  = a1[2] * a2[3]  + a1[5] * a2[4]  + a1[8] * a2[5];
+
+    product[6]  = a1[0] * a2[6]  + a1[3] * a2[7]  + a1[6] * a2[8];
+    product[7]  = a1[1] * a2[6]  + a1[4] * a2[7]  + a1[7] * a2[8];
+    product[8]  = a1[2] * a2[6]  + a1[5] * a2[7]  + a1[8] * a2[8];
+
+    product[9]  = a1[0] * a2[9]  + a1[3] * a2[10] + a1[6] * a2[11] + a1[9];
+    product[10] = a1[1] * a2[9]  + a1[4] * a2[10] + a1[7] * a2[11] + a1[10];
+    product[11] = a1[2] * a2[9]  + a1[5] * a2[10] + a1[8] * a2[11] + a1[11];
+
+    std::memcpy(dst, product, sizeof(float) * 12);
+}
+
+static void transformVector3sScalar(const float* m, const float* v, size_t stride, size_t count, float w, float* dst, size_t dstStride)
+{
+    const char* src = (const char*)v;
+    char* out = (char*)dst;
+    float tx = m[12] * w;
+    float ty = m[13] * w;
+    float tz = m[14] * w;
+    for (size_t i = 0; i < count; ++i, src += stride, out += dstStride)
+    {
+        const float* p = (const float*)src;
+        float* d = (float*)out;
+        float x = p[0] * m[0] + p[1] * m[4] + p[2] * m[8]  + tx;
+        float y = p[0] * m[1] + p[1] * m[5] + p[2] * m[9]  + ty;
+        float z = p[0] * m[2] + p[1] * m[6] + p[2] * m[10] + tz;
+        d[0] = x;
+        d[1] = y;
+        d[2] = z;
+    }
+}
+
+static void transformVector4sScalar(const float* m, const float* v, size_t stride, size_t count, float* dst, size_t dstStride)
+{
+    const char* src = (const char*)v;
+    char* out = (char*)dst;
+    for (size_t i = 0; i < count; ++i, src += stride, out += dstStride)
+    {
+        const float* p = (const float*)src;
+        float* d = (float*)out;
+        float x = p[0] * m[0] + p[1] * m[4] + p[2] * m[8]  + p[3] * m[12];
+        float y = p[0] * m[1] + p[1] * m[5] + p[2] * m[9]  + p[3] * m[13];
+        float z = p[0] * m[2] + p[1] * m[6] + p[2] * m[10] + p[3] * m[14];
+        float w = p[0] * m[3] + p[1] * m[7] + p[2] * m[11] + p[3] * m[15];
+        d[0] = x;
+        d[1] = y;
+        d[2] = z;
+        d[3] = w;
+    }
+}
+
+// The culling kernels test groups of eight objects against a list of planes,
+// in blocks of 32 objects that make one word of the visibility bitset. Each
+// plane is a row of eight floats: the normal, the distance and the absolute
+// value of the normal. The objects are four arrays for spheres (center x, y, z,
+// radius) or six for boxes (min x, y, z, max x, y, z). The tests do the same
+// arithmetic as BoundingSphere::intersects(const Plane&) and
+// BoundingBox::intersects(const Plane&) so the results match them exactly.
+
+typedef uint32_t (*CullBlockFunction)(const float* rows, size_t rowCount, const float* const* arrays, bool boxes,
+                                      size_t begin, size_t end, unsigned int* wholeRows);
+
+static unsigned int countCullBits(uint32_t bits)
+{
+    bits = bits - ((bits >> 1) & 0x55555555);
+    bits = (bits & 0x33333333) + ((bits >> 2) & 0x33333333);
+    return (((bits + (bits >> 4)) & 0x0F0F0F0F) * 0x01010101) >> 24;
+}
+
+static unsigned int loadCullTail(const float* const* arrays, size_t arrayCount, size_t begin, size_t end, const float** group, float (*tail)[8])
+{
+    size_t lanes = end - begin;
+    for (size_t i = 0; i < arrayCount; ++i)
+    {
+        std::memset(tail[i], 0, sizeof(tail[i]));
+        std::memcpy(tail[i], arrays[i] + begin, sizeof(float) * lanes);
+        group[i] = tail[i];
+    }
+    return (1u << lanes) - 1;
+}
+
+static inline unsigned int loadCullGroup(const float* const* arrays, size_t arrayCount, size_t begin, size_t end, const float** group, float (*tail)[8])
+{
+    // The full groups are read in place and the last one is copied and padded,
+    // so the kernels always load eight of each.
+    if (begin + 8 > end)
+        return loadCullTail(arrays, arrayCount, begin, end, group, tail);
+    for (size_t i = 0; i < arrayCount; ++i)
+    {
+        group[i] = arrays[i] + begin;
+    }
+    return 0xFF;
+}
+
+static size_t cullBlocks(const float* planes, int planeMask, const float* const* arrays, bool boxes, size_t count,
+                         uint32_t* visibility, unsigned char* coherency, CullBlockFunction cullBlock)
+{
+    float rows[6][8];
+    float activeRows[6][8];
+    int activePlanes[6];
+    size_t activeCount = 0;
+    for (int plane = 0; plane < 6; ++plane)
+    {
+        const float* p = &planes[plane * 4];
+        const float row[8] = { p[0], p[1], p[2], p[3], fabsf(p[0]), fabsf(p[1]), fabsf(p[2]), 0.0f };
+        std::memcpy(rows[plane], row, sizeof(row));
+        if (planeMask & (1 << plane))
+        {
+            std::memcpy(activeRows[activeCount], row, sizeof(row));
+            activePlanes[activeCount++] = plane;
+        }
+    }
+
+    // A block that one plane culled entirely is usually culled by it again,
+    // so that plane is tested alone first. This is the only branch on the
+    // results; the planes are tested against each group without any, since
+    // which of them cull an object is close to random.
+    size_t visible = 0;
+    unsigned int wholeRows;
+    for (size_t block = 0, begin = 0; begin < count; ++block, begin += 32)
+    {
+        size_t end = std::min(begin + 32, count);
+        if (coherency && coherency[block])
+        {
+            int plane = coherency[block] - 1;
+            if ((planeMask & (1 << plane)) && cullBlock(rows[plane], 1, arrays, boxes, begin, end, &wholeRows) == 0)
+            {
+                visibility[block] = 0;
+                continue;
+            }
+        }
+        uint32_t bits = cullBlock(activeRows[0], activeCount, arrays, boxes, begin, end, &wholeRows);
+        if (coherency)
+        {
+            coherency[block] = 0;
+            for (size_t i = 0; i < activeCount; ++i)
+            {
+                if (wholeRows & (1u << i))
+                {
+                    coherency[block] = (unsigned char)(activePlanes[i] + 1);
+                    break;
+                }
+            }
+        }
+        visibility[block] = bits;
+        visible += countCullBits(bits);
+    }
+    return visible;
+}
+
+static unsigned int cullRowScalar(const float* row, bool boxes, const float* x, const float* y, const float* z, const float* ex, const float* ey, const float* ez)
+{
+    unsigned int outside = 0;
+    for (size_t i = 0; i < 8; ++i)
+    {
+        float distance = row[0] * x[i] + row[1] * y[i] + row[2] * z[i] + row[3];
+        float radius = boxes ? ex[i] * row[4] + ey[i] * row[5] + ez[i] * row[6] : ex[i];
+        outside |= (unsigned int)(distance < -radius) << i;
+    }
+    return outside;
+}
+
+static uint32_t cullBlockScalar(const float* rows, size_t rowCount, const float* const* arrays, bool boxes,
+                                size_t begin, size_t end, unsigned int* wholeRows)
+{
+    const float* group[6];
+    float tail[6][8];
+    float x[8], y[8], z[8], ex[8], ey[8], ez[8];
+    unsigned int culledAll[6] = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+    uint32_t bits = 0;
+    for (size_t first = begin, shift = 0; first < end; first += 8, shift += 8)
+    {
+        unsigned int lanes = loadCullGroup(arrays, boxes ? 6 : 4, first, end, group, tail);
+        for (size_t i = 0; i < 8; ++i)
+        {
+            if (boxes)
+            {
+                x[i] = (group[0][i] + group[3][i]) * 0.5f;
+                y[i] = (group[1][i] + group[4][i]) * 0.5f;
+                z[i] = (group[2][i] + group[5][i]) * 0.5f;
+                ex[i] = fabsf((group[3][i] - group[0][i]) * 0.5f);
+                ey[i] = fabsf((group[4][i] - group[1][i]) * 0.5f);
+                ez[i] = fabsf((group[5][i] - group[2][i]) * 0.5f);
+            }
+            else
+            {
+                x[i] = group[0][i];
+                y[i] = group[1][i];
+                z[i] = group[2][i];
+                ex[i] = group[3][i];
+                ey[i] = 0.0f;
+                ez[i] = 0.0f;
+            }
+        }
+
+        // The padding lanes count as culled so a plane can still cull the whole block.
+        unsigned int padding = ~lanes & 0xFF;
+        unsigned int outside = padding;
+        for (size_t i = 0; i < rowCount; ++i)
+        {
+            unsigned int rowOutside = cullRowScalar(&rows[i * 8], boxes, x, y, z, ex, ey, ez) | padding;
+            outside |= rowOutside;
+            culledAll[i] &= rowOutside;
+        }
+        bits |= (uint32_t)(~outside & 0xFF) << shift;
+    }
+    *wholeRows = 0;
+    for (size_t i = 0; i < rowCount; ++i)
+    {
+        *wholeRows |= (unsigned int)(culledAll[i] == 0xFF) << i;
+    }
+    return bits;
+}
+
+static size_t cullSpheresScalar(const float* planes, int planeMask, const float* const* spheres, size_t count, uint32_t* visibility, unsigned char* coherency)
+{
+    return cullBlocks(planes, planeMask, spheres, false, count, visibility, coherency, cullBlockScalar);
+}
+
+static size_t cullBoxesScalar(const float* planes, int planeMask, const float* const* boxes, size_t count, uint32_t* visibility, unsigned char* coherency)
+{
+    return cullBlocks(planes, planeMask, boxes, true, count, visibility, coherency, cullBlockScalar);
+}
+
+// The rasterization kernels write a triangle into a rectangle of a depth
+// buffer, keeping the nearest depth of each pixel. The setup is thirteen
+// floats: the x and y gradients of the three edge functions, their values at
+// the center of the first pixel, the depth at that center, its x and y
+// gradients and the largest depth of the triangle. A pixel is covered when
+// its center is on the inner side of all three edges. Each value is computed
+// from the start of its row rather than accumulated, the same way in every
+// kernel, so they all write the same depths.
+static void rasterizeTriangleScalar(const float* setup, float* depth, size_t stride, size_t width, size_t height)
+{
+    for (size_t y = 0; y < height; ++y, depth += stride)
+    {
+        float row = (float)y;
+        float e0 = setup[6] + setup[3] * row;
+        float e1 = setup[7] + setup[4] * row;
+        float e2 = setup[8] + setup[5] * row;
+        float z = setup[9] + setup[11] * row;
+        for (size_t x = 0; x < width; ++x)
+        {
+            float column = (float)x;
+            if (e0 + setup[0] * column >= 0.0f && e1 + setup[1] * column >= 0.0f && e2 + setup[2] * column >= 0.0f)
+            {
+                float pixel = std::min(z + setup[10] * column, setup[12]);
+                depth[x] = std::min(depth[x], pixel);
+            }
+        }
+    }
+}
+
+}
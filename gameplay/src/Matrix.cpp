@@ -2,6 +2,7 @@
 #include "Matrix.h"
 #include "Plane.h"
 #include "Quaternion.h"
+#include "MathUtil.h"
 
 
 namespace gameplay
@@ -346,51 +347,66 @@ bool Matrix::invert()
 
 bool Matrix::invert(Matrix* dst) const
 {
-    float a0 = m[0] * m[5] - m[1] * m[4];
-    float a1 = m[0] * m[6] - m[2] * m[4];
-    float a2 = m[0] * m[7] - m[3] * m[4];
-    float a3 = m[1] * m[6] - m[2] * m[5];
-    float a4 = m[1] * m[7] - m[3] * m[5];
-    float a5 = m[2] * m[7] - m[3] * m[6];
-    float b0 = m[8] * m[13] - m[9] * m[12];
-    float b1 = m[8] * m[14] - m[10] * m[12];
-    float b2 = m[8] * m[15] - m[11] * m[12];
-    float b3 = m[9] * m[14] - m[10] * m[13];
-    float b4 = m[9] * m[15] - m[11] * m[13];
-    float b5 = m[10] * m[15] - m[11] * m[14];
+    GP_ASSERT(dst);
+    return MathUtil::invertMatrix(m, dst->m);
+}
+
+bool Matrix::invertAffine()
+{
+    return invertAffine(this);
+}
+
+bool Matrix::invertAffine(Matrix* dst) const
+{
+    GP_ASSERT(dst);
 
-    // Calculate the determinant.
-    float det = a0 * b5 - a1 * b4 + a2 * b3 + a3 * b2 - a4 * b1 + a5 * b0;
+    // Invert the upper 3x3 with its cofactors.
+    float c0 = m[5] * m[10] - m[6] * m[9];
+    float c1 = m[2] * m[9] - m[1] * m[10];
+    float c2 = m[1] * m[6] - m[2] * m[5];
+    float det = m[0] * c0 + m[4] * c1 + m[8] * c2;
 
     // Close to zero, can't invert.
     if (std::fabs(det) <= GP_MATH_TOLERANCE)
         return false;
 
-    // Support the case where m == dst.
-    Matrix inverse;
-    inverse.m[0]  = m[5] * b5 - m[6] * b4 + m[7] * b3;
-    inverse.m[1]  = -m[1] * b5 + m[2] * b4 - m[3] * b3;
-    inverse.m[2]  = m[13] * a5 - m[14] * a4 + m[15] * a3;
-    inverse.m[3]  = -m[9] * a5 + m[10] * a4 - m[11] * a3;
-
-    inverse.m[4]  = -m[4] * b5 + m[6] * b2 - m[7] * b1;
-    inverse.m[5]  = m[0] * b5 - m[2] * b2 + m[3] * b1;
-    inverse.m[6]  = -m[12] * a5 + m[14] * a2 - m[15] * a1;
-    inverse.m[7]  = m[8] * a5 - m[10] * a2 + m[11] * a1;
-
-    inverse.m[8]  = m[4] * b4 - m[5] * b2 + m[7] * b0;
-    inverse.m[9]  = -m[0] * b4 + m[1] * b2 - m[3] * b0;
-    inverse.m[10] = m[12] * a4 - m[13] * a2 + m[15] * a0;
-    inverse.m[11] = -m[8] * a4 + m[9] * a2 - m[11] * a0;
+    // Everything is read before writing to support dst being this matrix.
+    float invDet = 1.0f / det;
+    float i0 = c0 * invDet;
+    float i1 = c1 * invDet;
+    float i2 = c2 * invDet;
+    float i4 = (m[6] * m[8] - m[4] * m[10]) * invDet;
+    float i5 = (m[0] * m[10] - m[2] * m[8]) * invDet;
+    float i6 = (m[2] * m[4] - m[0] * m[6]) * invDet;
+    float i8 = (m[4] * m[9] - m[5] * m[8]) * invDet;
+    float i9 = (m[1] * m[8] - m[0] * m[9]) * invDet;
+    float i10 = (m[0] * m[5] - m[1] * m[4]) * invDet;
+    float tx = m[12];
+    float ty = m[13];
+    float tz = m[14];
+
+    // The translation is the negated translation transformed by the inverse.
+    dst->set(i0, i4, i8, -(i0 * tx + i4 * ty + i8 * tz),
+             i1, i5, i9, -(i1 * tx + i5 * ty + i9 * tz),
+             i2, i6, i10, -(i2 * tx + i6 * ty + i10 * tz),
+             0.0f, 0.0f, 0.0f, 1.0f);
+    return true;
+}
 
-    inverse.m[12] = -m[4] * b3 + m[5] * b1 - m[6] * b0;
-    inverse.m[13] = m[0] * b3 - m[1] * b1 + m[2] * b0;
-    inverse.m[14] = -m[12] * a3 + m[13] * a1 - m[14] * a0;
-    inverse.m[15] = m[8] * a3 - m[9] * a1 + m[10] * a0;
+void Matrix::invertRigid()
+{
+    invertRigid(this);
+}
 
-    multiply(inverse, 1.0f / det, dst);
+void Matrix::invertRigid(Matrix* dst) const
+{
+    GP_ASSERT(dst);
 
-    return true;
+    // The inverse of a rotation is its transpose.
+    dst->set(m[0], m[1], m[2], -(m[0] * m[12] + m[1] * m[13] + m[2] * m[14]),
+             m[4], m[5], m[6], -(m[4] * m[12] + m[5] * m[13] + m[6] * m[14]),
+             m[8], m[9], m[10], -(m[8] * m[12] + m[9] * m[13] + m[10] * m[14]),
+             0.0f, 0.0f, 0.0f, 1.0f);
 }
 
 void Matrix::multiply(float scalar)
@@ -432,25 +448,7 @@ void Matrix::multiply(const Matrix& m)
 void Matrix::multiply(const Matrix& m1, const Matrix& m2, Matrix* dst)
 {
     GP_ASSERT(dst);
-    dst->m[0] = m1.m[0] * m2.m[0] + m1.m[4] * m2.m[1] + m1.m[8] * m2.m[2] + m1.m[12] * m2.m[3];
-    dst->m[1] = m1.m[1] * m2.m[0] + m1.m[5] * m2.m[1] + m1.m[9] * m2.m[2] + m1.m[13] * m2.m[3];
-    dst->m[2] = m1.m[2] * m2.m[0] + m1.m[6] * m2.m[1] + m1.m[10] * m2.m[2] + m1.m[14] * m2.m[3];
-    dst->m[3] = m1.m[3] * m2.m[0] + m1.m[7] * m2.m[1] + m1.m[11] * m2.m[2] + m1.m[15] * m2.m[3];
-
-    dst->m[4] = m1.m[0] * m2.m[4] + m1.m[4] * m2.m[5] + m1.m[8] * m2.m[6] + m1.m[12] * m2.m[7];
-    dst->m[5] = m1.m[1] * m2.m[4] + m1.m[5] * m2.m[5] + m1.m[9] * m2.m[6] + m1.m[13] * m2.m[7];
-    dst->m[6] = m1.m[2] * m2.m[4] + m1.m[6] * m2.m[5] + m1.m[10] * m2.m[6] + m1.m[14] * m2.m[7];
-    dst->m[7] = m1.m[3] * m2.m[4] + m1.m[7] * m2.m[5] + m1.m[11] * m2.m[6] + m1.m[15] * m2.m[7];
-
-    dst->m[8] = m1.m[0] * m2.m[8] + m1.m[4] * m2.m[9] + m1.m[8] * m2.m[10] + m1.m[12] * m2.m[11];
-    dst->m[9] = m1.m[1] * m2.m[8] + m1.m[5] * m2.m[9] + m1.m[9] * m2.m[10] + m1.m[13] * m2.m[11];
-    dst->m[10] = m1.m[2] * m2.m[8] + m1.m[6] * m2.m[9] + m1.m[10] * m2.m[10] + m1.m[14] * m2.m[11];
-    dst->m[11] = m1.m[3] * m2.m[8] + m1.m[7] * m2.m[9] + m1.m[11] * m2.m[10] + m1.m[15] * m2.m[11];
-
-    dst->m[12] = m1.m[0] * m2.m[12] + m1.m[4] * m2.m[13] + m1.m[8] * m2.m[14] + m1.m[12] * m2.m[15];
-    dst->m[13] = m1.m[1] * m2.m[12] + m1.m[5] * m2.m[13] + m1.m[9] * m2.m[14] + m1.m[13] * m2.m[15];
-    dst->m[14] = m1.m[2] * m2.m[12] + m1.m[6] * m2.m[13] + m1.m[10] * m2.m[14] + m1.m[14] * m2.m[15];
-    dst->m[15] = m1.m[3] * m2.m[12] + m1.m[7] * m2.m[13] + m1.m[11] * m2.m[14] + m1.m[15] * m2.m[15];
+    MathUtil::multiplyMatrix(m1.m, m2.m, dst->m);
 }
 
 void Matrix::add(const Matrix& m1, const Matrix& m2, Matrix* dst)
@@ -717,6 +715,48 @@ void Matrix::transformVector(const Vector4& v, Vector4* dst) const
     dst->w = w;
 }
 
+void Matrix::transformPoints(const Vector3* points, size_t count, Vector3* dst) const
+{
+    GP_ASSERT(points || count == 0);
+    GP_ASSERT(dst || count == 0);
+    transformPoints(&points->x, sizeof(Vector3), count, &dst->x, sizeof(Vector3));
+}
+
+void Matrix::transformPoints(const float* points, size_t stride, size_t count, float* dst, size_t dstStride) const
+{
+    GP_ASSERT(points || count == 0);
+    GP_ASSERT(dst || count == 0);
+    MathUtil::transformVector3s(m, points, stride, count, 1.0f, dst, dstStride);
+}
+
+void Matrix::transformVectors(const Vector3* vectors, size_t count, Vector3* dst) const
+{
+    GP_ASSERT(vectors || count == 0);
+    GP_ASSERT(dst || count == 0);
+    transformVectors(&vectors->x, sizeof(Vector3), count, &dst->x, sizeof(Vector3));
+}
+
+void Matrix::transformVectors(const float* vectors, size_t stride, size_t count, float* dst, size_t dstStride) const
+{
+    GP_ASSERT(vectors || count == 0);
+    GP_ASSERT(dst || count == 0);
+    MathUtil::transformVector3s(m, vectors, stride, count, 0.0f, dst, dstStride);
+}
+
+void Matrix::transformVector4s(const Vector4* vectors, size_t count, Vector4* dst) const
+{
+    GP_ASSERT(vectors || count == 0);
+    GP_ASSERT(dst || count == 0);
+    transformVector4s(&vectors->x, sizeof(Vector4), count, &dst->x, sizeof(Vector4));
+}
+
+void Matrix::transformVector4s(const float* vectors, size_t stride, size_t count, float* dst, size_t dstStride) const
+{
+    GP_ASSERT(vectors || count == 0);
+    GP_ASSERT(dst || count == 0);
+    MathUtil::transformVector4s(m, vectors, stride, count, dst, dstStride);
+}
+
 Matrix& Matrix::operator=(const Matrix& m)
 {
     if(&m == this)
@@ -358,6 +358,42 @@ public:
      */
     bool invert(Matrix* dst) const;
 
+    /**
+     * Inverts this matrix assuming it is affine.
+     *
+     * The last row of an affine matrix is (0, 0, 0, 1), as for any combination
+     * of translation, rotation and scale, which allows a much cheaper inverse.
+     *
+     * @return true if the the matrix can be inverted, false otherwise.
+     */
+    bool invertAffine();
+
+    /**
+     * Stores the inverse of this matrix in the specified matrix assuming it is affine.
+     *
+     * @param dst A matrix to store the invert of this matrix in.
+     * @return true if the the matrix can be inverted, false otherwise.
+     * @see invertAffine
+     */
+    bool invertAffine(Matrix* dst) const;
+
+    /**
+     * Inverts this matrix assuming it is rigid.
+     *
+     * A rigid matrix only translates and rotates, so its inverse is the
+     * transposed rotation applied to the negated translation.
+     * The result is wrong if the matrix contains a scale or a projection.
+     */
+    void invertRigid();
+
+    /**
+     * Stores the inverse of this matrix in the specified matrix assuming it is rigid.
+     *
+     * @param dst A matrix to store the invert of this matrix in.
+     * @see invertRigid
+     */
+    void invertRigid(Matrix* dst) const;
+
     /**
      * Multiplies the components of this matrix by the specified scalar.
      *
@@ -599,6 +635,80 @@ public:
      */
     void transformVector(const Vector4& v, Vector4* dst) const;
 
+    /**
+     * Transforms an array of points by this matrix.
+     *
+     * The points and dst may be the same array.
+     *
+     * @param points The points to transform.
+     * @param count The number of points to transform.
+     * @param dst An array to store the transformed points in.
+     */
+    void transformPoints(const Vector3* points, size_t count, Vector3* dst) const;
+
+    /**
+     * Transforms an array of interleaved points by this matrix.
+     *
+     * Each point is three floats (x, y, z). The stride is the number of bytes
+     * from the start of one point to the next, so positions can be transformed
+     * directly inside interleaved vertex data.
+     *
+     * @param points The first point to transform.
+     * @param stride The number of bytes between consecutive points.
+     * @param count The number of points to transform.
+     * @param dst The first point to store the transformed points in.
+     * @param dstStride The number of bytes between consecutive transformed points.
+     */
+    void transformPoints(const float* points, size_t stride, size_t count, float* dst, size_t dstStride) const;
+
+    /**
+     * Transforms an array of vectors by this matrix by
+     * treating the fourth (w) coordinate as zero.
+     *
+     * The vectors and dst may be the same array.
+     *
+     * @param vectors The vectors to transform.
+     * @param count The number of vectors to transform.
+     * @param dst An array to store the transformed vectors in.
+     */
+    void transformVectors(const Vector3* vectors, size_t count, Vector3* dst) const;
+
+    /**
+     * Transforms an array of interleaved vectors by this matrix by
+     * treating the fourth (w) coordinate as zero.
+     *
+     * @param vectors The first vector to transform.
+     * @param stride The number of bytes between consecutive vectors.
+     * @param count The number of vectors to transform.
+     * @param dst The first vector to store the transformed vectors in.
+     * @param dstStride The number of bytes between consecutive transformed vectors.
+     * @see transformPoints
+     */
+    void transformVectors(const float* vectors, size_t stride, size_t count, float* dst, size_t dstStride) const;
+
+    /**
+     * Transforms an array of 4 component vectors by this matrix.
+     *
+     * The vectors and dst may be the same array.
+     *
+     * @param vectors The vectors to transform.
+     * @param count The number of vectors to transform.
+     * @param dst An array to store the transformed vectors in.
+     */
+    void transformVector4s(const Vector4* vectors, size_t count, Vector4* dst) const;
+
+    /**
+     * Transforms an array of interleaved 4 component vectors by this matrix.
+     *
+     * @param vectors The first vector to transform.
+     * @param stride The number of bytes between consecutive vectors.
+     * @param count The number of vectors to transform.
+     * @param dst The first vector to store the transformed vectors in.
+     * @param dstStride The number of bytes between consecutive transformed vectors.
+     * @see transformPoints
+     */
+    void transformVector4s(const float* vectors, size_t stride, size_t count, float* dst, size_t dstStride) const;
+
     /**
      * operator =
      */
@@ -0,0 +1,500 @@
+#include "Base.h"
+#include "OcclusionCuller.h"
+#include "SceneObject.h"
+#include "MathUtil.h"
+
+#define OCCLUSION_CULLER_WIDTH_DEFAULT 256
+#define OCCLUSION_CULLER_HEIGHT_DEFAULT 128
+#define OCCLUSION_CULLER_TILE_LEVELS 5
+#define OCCLUSION_CULLER_SPAN_ALIGNMENT 8
+#define OCCLUSION_CULLER_TEXELS_MAX 16
+#define OCCLUSION_CULLER_OUTSIDE_LEFT 1
+#define OCCLUSION_CULLER_OUTSIDE_RIGHT 2
+#define OCCLUSION_CULLER_OUTSIDE_BOTTOM 4
+#define OCCLUSION_CULLER_OUTSIDE_TOP 8
+#define OCCLUSION_CULLER_OUTSIDE_FAR 16
+#define OCCLUSION_CULLER_OUTSIDE_NEAR 32
+
+namespace gameplay
+{
+
+const size_t OcclusionCuller::TILE_SIZE;
+
+// The triangles of a box with each face counter-clockwise seen from outside,
+// for the corners in the order of BoundingBox::getCorners.
+static const uint32_t BOX_INDICES[36] =
+{
+    0, 1, 2, 0, 2, 3,
+    4, 5, 6, 4, 6, 7,
+    3, 2, 5, 3, 5, 4,
+    7, 6, 1, 7, 1, 0,
+    7, 0, 3, 7, 3, 4,
+    1, 6, 5, 1, 5, 2
+};
+
+OcclusionCuller::OcclusionCuller() :
+    _tilesX(0),
+    _tilesY(0)
+{
+    setSize(OCCLUSION_CULLER_WIDTH_DEFAULT, OCCLUSION_CULLER_HEIGHT_DEFAULT);
+}
+
+OcclusionCuller::OcclusionCuller(size_t width, size_t height) :
+    _tilesX(0),
+    _tilesY(0)
+{
+    setSize(width, height);
+}
+
+OcclusionCuller::~OcclusionCuller()
+{
+}
+
+size_t OcclusionCuller::getWidth() const
+{
+    return _levels[0].width;
+}
+
+size_t OcclusionCuller::getHeight() const
+{
+    return _levels[0].height;
+}
+
+void OcclusionCuller::setSize(size_t width, size_t height)
+{
+    GP_ASSERT(width > 0 && height > 0);
+
+    _tilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
+    _tilesY = (height + TILE_SIZE - 1) / TILE_SIZE;
+    _bins.clear();
+    _bins.resize(_tilesX * _tilesY);
+    _triangles.clear();
+
+    // Each level keeps the farthest depth of 2x2 texels of the level below,
+    // down to a single texel. The levels within a tile halve exactly.
+    _levels.clear();
+    width = _tilesX * TILE_SIZE;
+    height = _tilesY * TILE_SIZE;
+    while (true)
+    {
+        Level level;
+        level.width = width;
+        level.height = height;
+        level.depth.assign(width * height, std::numeric_limits<float>::max());
+        _levels.push_back(std::move(level));
+        if (width == 1 && height == 1)
+            break;
+        width = (width + 1) / 2;
+        height = (height + 1) / 2;
+    }
+}
+
+std::shared_ptr<ThreadPool> OcclusionCuller::getThreadPool() const
+{
+    return _threadPool;
+}
+
+void OcclusionCuller::setThreadPool(std::shared_ptr<ThreadPool> threadPool)
+{
+    _threadPool = threadPool;
+}
+
+void OcclusionCuller::begin(const Matrix& viewProjection)
+{
+    _viewProjection = viewProjection;
+    _triangles.clear();
+    for (auto& bin : _bins)
+    {
+        bin.clear();
+    }
+}
+
+void OcclusionCuller::addOccluder(const float* positions, size_t stride, size_t vertexCount,
+                                  const uint32_t* indices, size_t indexCount, const Matrix& world)
+{
+    GP_ASSERT(positions || vertexCount == 0);
+    GP_ASSERT(indices || indexCount == 0);
+    GP_ASSERT(indexCount % 3 == 0);
+
+    if (vertexCount == 0 || indexCount == 0)
+        return;
+    _vertices.resize(vertexCount);
+    const char* src = (const char*)positions;
+    for (size_t i = 0; i < vertexCount; ++i, src += stride)
+    {
+        const float* p = (const float*)src;
+        _vertices[i].set(p[0], p[1], p[2], 1.0f);
+    }
+    Matrix matrix;
+    Matrix::multiply(_viewProjection, world, &matrix);
+    matrix.transformVector4s(_vertices.data(), vertexCount, _vertices.data());
+    addTriangles(indices, indexCount, 0.0f);
+}
+
+void OcclusionCuller::addOccluder(const BoundingBox& box, const Matrix& world)
+{
+    if (box.isEmpty())
+        return;
+    Vector3 corners[8];
+    box.getCorners(corners);
+    _vertices.resize(8);
+    for (size_t i = 0; i < 8; ++i)
+    {
+        _vertices[i].set(corners[i].x, corners[i].y, corners[i].z, 1.0f);
+    }
+    Matrix matrix;
+    Matrix::multiply(_viewProjection, world, &matrix);
+    matrix.transformVector4s(_vertices.data(), 8, _vertices.data());
+
+    // The clip space of the matrices flips the depth axis, so the faces
+    // counter-clockwise in world space face the camera when the determinant
+    // is negative. They are clockwise on the buffer, whose rows go down.
+    addTriangles(BOX_INDICES, 36, matrix.determinant() < 0.0f ? -1.0f : 1.0f);
+}
+
+size_t OcclusionCuller::getTriangleCount() const
+{
+    return _triangles.size();
+}
+
+void OcclusionCuller::rasterize()
+{
+    // The tiles are numbered down the columns, so the contiguous range
+    // of tiles given to each thread is a strip across the whole height
+    // and the threads share the rows where the occluders crowd.
+    size_t tileCount = _tilesX * _tilesY;
+    if (_threadPool && _threadPool->getThreadCount() > 1)
+    {
+        _threadPool->execute(tileCount, [this](size_t first, size_t last)
+        {
+            for (size_t i = first; i < last; ++i)
+            {
+                rasterizeTile(i);
+            }
+        });
+    }
+    else
+    {
+        for (size_t i = 0; i < tileCount; ++i)
+        {
+            rasterizeTile(i);
+        }
+    }
+
+    // The levels coarser than a tile are small and built here.
+    for (size_t i = OCCLUSION_CULLER_TILE_LEVELS + 1; i < _levels.size(); ++i)
+    {
+        const Level& src = _levels[i - 1];
+        Level& dst = _levels[i];
+        for (size_t y = 0; y < dst.height; ++y)
+        {
+            const float* row0 = &src.depth[y * 2 * src.width];
+            const float* row1 = &src.depth[std::min(y * 2 + 1, src.height - 1) * src.width];
+            for (size_t x = 0; x < dst.width; ++x)
+            {
+                size_t x0 = x * 2;
+                size_t x1 = std::min(x0 + 1, src.width - 1);
+                dst.depth[y * dst.width + x] = std::max(std::max(row0[x0], row0[x1]), std::max(row1[x0], row1[x1]));
+            }
+        }
+    }
+}
+
+const float* OcclusionCuller::getDepth() const
+{
+    return _levels[0].depth.data();
+}
+
+bool OcclusionCuller::isVisible(const BoundingBox& box) const
+{
+    Vector3 corners[8];
+    box.getCorners(corners);
+    Vector4 clip[8];
+    for (size_t i = 0; i < 8; ++i)
+    {
+        clip[i].set(corners[i].x, corners[i].y, corners[i].z, 1.0f);
+    }
+    _viewProjection.transformVector4s(clip, 8, clip);
+
+    // The screen rectangle and the nearest depth of the box.
+    const Level& base = _levels[0];
+    float width = (float)base.width;
+    float height = (float)base.height;
+    float minX = std::numeric_limits<float>::max();
+    float minY = std::numeric_limits<float>::max();
+    float maxX = -std::numeric_limits<float>::max();
+    float maxY = -std::numeric_limits<float>::max();
+    float nearest = std::numeric_limits<float>::max();
+    for (size_t i = 0; i < 8; ++i)
+    {
+        if (!(clip[i].w > 0.0f) || clip[i].z < -clip[i].w)
+            return true;
+        Vector3 p;
+        project(clip[i], &p);
+        minX = std::min(minX, p.x);
+        minY = std::min(minY, p.y);
+        maxX = std::max(maxX, p.x);
+        maxY = std::max(maxY, p.y);
+        nearest = std::min(nearest, p.z);
+    }
+    if (!(maxX > 0.0f && minX < width && maxY > 0.0f && minY < height))
+        return true;
+
+    // The pixels that the rectangle touches and their neighbors, tested on
+    // the finest level where they span a few texels. The occluders only
+    // cover the centers of the pixels, so a box can show through the edge
+    // of a covered pixel next to one that is not. The box is hidden when it
+    // is nearer than none of them.
+    size_t x0 = (size_t)std::max(minX - 1.0f, 0.0f);
+    size_t y0 = (size_t)std::max(minY - 1.0f, 0.0f);
+    size_t x1 = (size_t)std::min(maxX + 1.0f, width - 1.0f);
+    size_t y1 = (size_t)std::min(maxY + 1.0f, height - 1.0f);
+    size_t level = 0;
+    while (level + 1 < _levels.size() &&
+           ((x1 >> level) - (x0 >> level) + 1) * ((y1 >> level) - (y0 >> level) + 1) > OCCLUSION_CULLER_TEXELS_MAX)
+    {
+        ++level;
+    }
+    const Level& texels = _levels[level];
+    for (size_t y = y0 >> level; y <= (y1 >> level); ++y)
+    {
+        const float* row = &texels.depth[y * texels.width];
+        for (size_t x = x0 >> level; x <= (x1 >> level); ++x)
+        {
+            if (row[x] >= nearest)
+                return true;
+        }
+    }
+    return false;
+}
+
+size_t OcclusionCuller::cullBoxes(const float* minX, const float* minY, const float* minZ, const float* maxX, const float* maxY, const float* maxZ, size_t count,
+                                  uint32_t* visibility) const
+{
+    GP_ASSERT(visibility || count == 0);
+
+    size_t visible = 0;
+    for (size_t word = 0; word * 32 < count; ++word)
+    {
+        uint32_t bits = visibility[word];
+        for (size_t bit = 0; bit < 32 && (bits >> bit) != 0; ++bit)
+        {
+            if ((bits & (1u << bit)) == 0)
+                continue;
+            size_t i = word * 32 + bit;
+            GP_ASSERT(i < count);
+            BoundingBox box(Vector3(minX[i], minY[i], minZ[i]), Vector3(maxX[i], maxY[i], maxZ[i]));
+            if (isVisible(box))
+                ++visible;
+            else
+                bits &= ~(1u << bit);
+        }
+        visibility[word] = bits;
+    }
+    return visible;
+}
+
+size_t OcclusionCuller::cullObjects(std::vector<SceneObject*>& objects) const
+{
+    size_t count = objects.size();
+    objects.erase(std::remove_if(objects.begin(), objects.end(), [this](SceneObject* object)
+    {
+        const BoundingBox& box = object->getWorldBoundingBox();
+        return !box.isEmpty() && !isVisible(box);
+    }), objects.end());
+    return count - objects.size();
+}
+
+void OcclusionCuller::addTriangles(const uint32_t* indices, size_t indexCount, float winding)
+{
+    // The sides of the clip volume that each vertex is outside of. A triangle
+    // with all its vertices outside of the same side is skipped and only the
+    // ones with a vertex behind the near plane are clipped.
+    _outcodes.resize(_vertices.size());
+    _projected.resize(_vertices.size());
+    for (size_t i = 0; i < _vertices.size(); ++i)
+    {
+        const Vector4& v = _vertices[i];
+        int outcode = 0;
+        outcode |= v.x < -v.w ? OCCLUSION_CULLER_OUTSIDE_LEFT : 0;
+        outcode |= v.x > v.w ? OCCLUSION_CULLER_OUTSIDE_RIGHT : 0;
+        outcode |= v.y < -v.w ? OCCLUSION_CULLER_OUTSIDE_BOTTOM : 0;
+        outcode |= v.y > v.w ? OCCLUSION_CULLER_OUTSIDE_TOP : 0;
+        outcode |= v.z > v.w ? OCCLUSION_CULLER_OUTSIDE_FAR : 0;
+        outcode |= v.z + v.w < 0.0f || !(v.w > 0.0f) ? OCCLUSION_CULLER_OUTSIDE_NEAR : 0;
+        _outcodes[i] = (unsigned char)outcode;
+        if ((outcode & OCCLUSION_CULLER_OUTSIDE_NEAR) == 0)
+            project(v, &_projected[i]);
+    }
+    for (size_t i = 0; i + 2 < indexCount; i += 3)
+    {
+        uint32_t i0 = indices[i];
+        uint32_t i1 = indices[i + 1];
+        uint32_t i2 = indices[i + 2];
+        GP_ASSERT(i0 < _vertices.size() && i1 < _vertices.size() && i2 < _vertices.size());
+        if ((_outcodes[i0] & _outcodes[i1] & _outcodes[i2]) != 0)
+            continue;
+        if (((_outcodes[i0] | _outcodes[i1] | _outcodes[i2]) & OCCLUSION_CULLER_OUTSIDE_NEAR) != 0)
+            clipTriangle(_vertices[i0], _vertices[i1], _vertices[i2], winding);
+        else
+            addTriangle(_projected[i0], _projected[i1], _projected[i2], winding);
+    }
+}
+
+void OcclusionCuller::clipTriangle(const Vector4& v0, const Vector4& v1, const Vector4& v2, float winding)
+{
+    // Clip to the near plane, where z + w is zero, leaving up to four
+    // vertices that are drawn as a fan of one or two triangles.
+    const Vector4* input[3] = { &v0, &v1, &v2 };
+    Vector3 polygon[4];
+    size_t vertexCount = 0;
+    for (size_t i = 0; i < 3; ++i)
+    {
+        const Vector4& a = *input[i];
+        const Vector4& b = *input[(i + 1) % 3];
+        float da = a.z + a.w;
+        float db = b.z + b.w;
+        if (da >= 0.0f)
+        {
+            if (!(a.w > 0.0f))
+                return;
+            project(a, &polygon[vertexCount++]);
+        }
+        if ((da >= 0.0f) != (db >= 0.0f))
+        {
+            Vector4 v = a + (b - a) * (da / (da - db));
+            if (!(v.w > 0.0f))
+                return;
+            project(v, &polygon[vertexCount++]);
+        }
+    }
+    for (size_t i = 2; i < vertexCount; ++i)
+    {
+        addTriangle(polygon[0], polygon[i - 1], polygon[i], winding);
+    }
+}
+
+void OcclusionCuller::addTriangle(const Vector3& p0, const Vector3& p1, const Vector3& p2, float winding)
+{
+    Triangle t;
+    t.x[0] = p0.x;
+    t.x[1] = p1.x;
+    t.x[2] = p2.x;
+    t.y[0] = p0.y;
+    t.y[1] = p1.y;
+    t.y[2] = p2.y;
+    float area = (t.x[1] - t.x[0]) * (t.y[2] - t.y[0]) - (t.x[2] - t.x[0]) * (t.y[1] - t.y[0]);
+    if (!(std::fabs(area) > 0.0f) || area * winding < 0.0f)
+        return;
+
+    // The pixels whose centers are within the bounds of the triangle.
+    const Level& base = _levels[0];
+    float width = (float)base.width;
+    float height = (float)base.height;
+    float left = std::min(std::max(std::min(std::min(t.x[0], t.x[1]), t.x[2]), 0.0f), width);
+    float right = std::min(std::max(std::max(std::max(t.x[0], t.x[1]), t.x[2]), 0.0f), width);
+    float top = std::min(std::max(std::min(std::min(t.y[0], t.y[1]), t.y[2]), 0.0f), height);
+    float bottom = std::min(std::max(std::max(std::max(t.y[0], t.y[1]), t.y[2]), 0.0f), height);
+    t.minX = (int)std::ceil(left - 0.5f);
+    t.maxX = (int)std::floor(right - 0.5f);
+    t.minY = (int)std::ceil(top - 0.5f);
+    t.maxY = (int)std::floor(bottom - 0.5f);
+    if (t.minX > t.maxX || t.minY > t.maxY)
+        return;
+
+    // The edge functions are positive inside the triangle.
+    float sign = area > 0.0f ? 1.0f : -1.0f;
+    for (size_t i = 0; i < 3; ++i)
+    {
+        size_t j = (i + 1) % 3;
+        t.a[i] = (t.y[i] - t.y[j]) * sign;
+        t.b[i] = (t.x[j] - t.x[i]) * sign;
+    }
+
+    // The depth is a plane on the screen. Adding half of its gradients
+    // gives the farthest depth over the pixel rather than at its center.
+    t.dzdx = ((p1.z - p0.z) * (t.y[2] - t.y[0]) - (p2.z - p0.z) * (t.y[1] - t.y[0])) / area;
+    t.dzdy = ((p2.z - p0.z) * (t.x[1] - t.x[0]) - (p1.z - p0.z) * (t.x[2] - t.x[0])) / area;
+    t.depth = p0.z + (std::fabs(t.dzdx) + std::fabs(t.dzdy)) * 0.5f;
+    t.maxDepth = std::max(std::max(p0.z, p1.z), p2.z);
+
+    uint32_t index = (uint32_t)_triangles.size();
+    _triangles.push_back(t);
+    for (size_t tileX = t.minX / TILE_SIZE; tileX <= t.maxX / TILE_SIZE; ++tileX)
+    {
+        for (size_t tileY = t.minY / TILE_SIZE; tileY <= t.maxY / TILE_SIZE; ++tileY)
+        {
+            _bins[tileX * _tilesY + tileY].push_back(index);
+        }
+    }
+}
+
+void OcclusionCuller::project(const Vector4& clip, Vector3* dst) const
+{
+    // The rows of the buffer go down from the top of the viewport.
+    const Level& base = _levels[0];
+    float inverseW = 1.0f / clip.w;
+    dst->x = (clip.x * inverseW * 0.5f + 0.5f) * (float)base.width;
+    dst->y = (0.5f - clip.y * inverseW * 0.5f) * (float)base.height;
+    dst->z = clip.z * inverseW;
+}
+
+void OcclusionCuller::rasterizeTile(size_t tile)
+{
+    int tileX = (int)((tile / _tilesY) * TILE_SIZE);
+    int tileY = (int)((tile % _tilesY) * TILE_SIZE);
+    Level& base = _levels[0];
+    for (int y = tileY; y < tileY + (int)TILE_SIZE; ++y)
+    {
+        float* row = &base.depth[y * base.width + tileX];
+        std::fill(row, row + TILE_SIZE, std::numeric_limits<float>::max());
+    }
+
+    // The spans are widened to whole groups of pixels for the kernels.
+    // They stay within the tile, which is aligned to the groups, and
+    // the extra pixels are only written where the triangle covers them.
+    float setup[13];
+    for (uint32_t index : _bins[tile])
+    {
+        const Triangle& t = _triangles[index];
+        int x0 = std::max(t.minX, tileX) & ~(OCCLUSION_CULLER_SPAN_ALIGNMENT - 1);
+        int x1 = (std::min(t.maxX + 1, tileX + (int)TILE_SIZE) + OCCLUSION_CULLER_SPAN_ALIGNMENT - 1) & ~(OCCLUSION_CULLER_SPAN_ALIGNMENT - 1);
+        int y0 = std::max(t.minY, tileY);
+        int y1 = std::min(t.maxY + 1, tileY + (int)TILE_SIZE);
+        float px = (float)x0 + 0.5f;
+        float py = (float)y0 + 0.5f;
+        for (size_t i = 0; i < 3; ++i)
+        {
+            setup[i] = t.a[i];
+            setup[3 + i] = t.b[i];
+            setup[6 + i] = t.a[i] * (px - t.x[i]) + t.b[i] * (py - t.y[i]);
+        }
+        setup[9] = t.depth + t.dzdx * (px - t.x[0]) + t.dzdy * (py - t.y[0]);
+        setup[10] = t.dzdx;
+        setup[11] = t.dzdy;
+        setup[12] = t.maxDepth;
+        MathUtil::rasterizeTriangle(setup, &base.depth[y0 * base.width + x0], base.width, x1 - x0, y1 - y0);
+    }
+
+    // The levels within the tile only read the pixels of the tile.
+    for (size_t i = 1; i <= OCCLUSION_CULLER_TILE_LEVELS; ++i)
+    {
+        const Level& src = _levels[i - 1];
+        Level& dst = _levels[i];
+        size_t size = TILE_SIZE >> i;
+        size_t originX = (size_t)tileX >> i;
+        size_t originY = (size_t)tileY >> i;
+        for (size_t y = originY; y < originY + size; ++y)
+        {
+            const float* row0 = &src.depth[y * 2 * src.width];
+            const float* row1 = row0 + src.width;
+            float* out = &dst.depth[y * dst.width];
+            for (size_t x = originX; x < originX + size; ++x)
+            {
+                out[x] = std::max(std::max(row0[x * 2], row0[x * 2 + 1]), std::max(row1[x * 2], row1[x * 2 + 1]));
+            }
+        }
+    }
+}
+
+}
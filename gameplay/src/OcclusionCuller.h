@@ -0,0 +1,246 @@
+#pragma once
+
+#include "Vector3.h"
+#include "Vector4.h"
+#include "Matrix.h"
+#include "BoundingBox.h"
+#include "ThreadPool.h"
+
+namespace gameplay
+{
+
+class SceneObject;
+
+/**
+ * Defines a culler that hides the objects behind occluders on the cpu.
+ *
+ * Occluders are large and simple meshes, such as walls, floors and buildings,
+ * that are rasterized into a low resolution depth buffer. The bounding boxes
+ * of the objects are then tested against a hierarchy of the farthest depths
+ * of that buffer, so an object behind the occluders is hidden after testing
+ * a few texels. It runs entirely on the cpu, without a graphics device.
+ *
+ * The buffer is split into square tiles of TILE_SIZE pixels. The triangles of
+ * the occluders are clipped to the near plane and binned into the tiles they
+ * overlap, then the tiles are rasterized in parallel on the thread pool with
+ * the SIMD instructions of the cpu. A pixel is covered when its center is
+ * inside a triangle and it keeps the farthest depth of the triangle over the
+ * pixel, so an object is only hidden where it is behind the occluders. The
+ * depths written are the same with every instruction set.
+ *
+ * Each frame, call begin() with the view projection matrix, add the occluders,
+ * call rasterize() and then test the objects. The clip space of the matrix is
+ * the one of Matrix::createPerspective and Matrix::createOrthographic, with a
+ * depth from -w on the near plane to w on the far plane.
+ */
+class OcclusionCuller
+{
+public:
+
+    /**
+     * The width and height of the tiles in pixels.
+     */
+    static const size_t TILE_SIZE = 32;
+
+    /**
+     * Constructor.
+     */
+    OcclusionCuller();
+
+    /**
+     * Constructor.
+     *
+     * @param width The width of the depth buffer in pixels.
+     * @param height The height of the depth buffer in pixels.
+     */
+    OcclusionCuller(size_t width, size_t height);
+
+    /**
+     * Destructor.
+     */
+    ~OcclusionCuller();
+
+    /**
+     * Gets the width of the depth buffer.
+     *
+     * @return The width of the depth buffer in pixels.
+     */
+    size_t getWidth() const;
+
+    /**
+     * Gets the height of the depth buffer.
+     *
+     * @return The height of the depth buffer in pixels.
+     */
+    size_t getHeight() const;
+
+    /**
+     * Sets the size of the depth buffer.
+     *
+     * The size is rounded up to whole tiles and the whole buffer covers
+     * the viewport. A quarter of the screen resolution or less is usually
+     * enough, since the occluders are large. The occluders must be added
+     * again afterwards.
+     *
+     * @param width The width of the depth buffer in pixels.
+     * @param height The height of the depth buffer in pixels.
+     */
+    void setSize(size_t width, size_t height);
+
+    /**
+     * Gets the thread pool that the tiles are rasterized on.
+     *
+     * @return The thread pool, or nullptr if the tiles are rasterized on the calling thread.
+     */
+    std::shared_ptr<ThreadPool> getThreadPool() const;
+
+    /**
+     * Sets the thread pool that the tiles are rasterized on.
+     *
+     * @param threadPool The thread pool, or nullptr to rasterize on the calling thread.
+     */
+    void setThreadPool(std::shared_ptr<ThreadPool> threadPool);
+
+    /**
+     * Begins a frame of occlusion culling and removes the occluders of the previous one.
+     *
+     * @param viewProjection The view projection matrix of the camera.
+     */
+    void begin(const Matrix& viewProjection);
+
+    /**
+     * Adds an occluder mesh.
+     *
+     * Both sides of the triangles are rasterized.
+     *
+     * @param positions The first vertex position, three floats (x, y, z) in local space.
+     * @param stride The number of bytes between consecutive positions.
+     * @param vertexCount The number of vertices.
+     * @param indices The indices of the vertices of the triangles, three per triangle.
+     * @param indexCount The number of indices.
+     * @param world The matrix that transforms the positions into world space.
+     */
+    void addOccluder(const float* positions, size_t stride, size_t vertexCount,
+                     const uint32_t* indices, size_t indexCount, const Matrix& world);
+
+    /**
+     * Adds a solid box occluder.
+     *
+     * Only the faces of the box that face the camera are rasterized.
+     *
+     * @param box The box in local space.
+     * @param world The matrix that transforms the box into world space.
+     */
+    void addOccluder(const BoundingBox& box, const Matrix& world);
+
+    /**
+     * Gets the number of occluder triangles added since begin() that cover pixels.
+     *
+     * @return The number of occluder triangles.
+     */
+    size_t getTriangleCount() const;
+
+    /**
+     * Rasterizes the occluders added since begin() and builds the depth hierarchy.
+     */
+    void rasterize();
+
+    /**
+     * Gets the depth buffer that the occluders were rasterized into.
+     *
+     * The depths are the clip space depth divided by w, row by row from the
+     * top of the viewport with getWidth() floats per row. The pixels without
+     * occluders hold the largest float.
+     *
+     * @return The depth buffer.
+     */
+    const float* getDepth() const;
+
+    /**
+     * Tests whether a box is visible past the occluders.
+     *
+     * A box that crosses the near plane or is outside of the viewport is
+     * visible, frustum culling decides about the latter.
+     *
+     * @param box The box in world space.
+     * @return false if the box is hidden behind the occluders; true otherwise.
+     */
+    bool isVisible(const BoundingBox& box) const;
+
+    /**
+     * Culls an array of boxes against the occluders.
+     *
+     * Only the boxes that are visible in the bitset are tested, so it can
+     * take the result of Frustum::cullBoxes and clear the hidden boxes.
+     *
+     * @param minX The minimum x coordinate of each box.
+     * @param minY The minimum y coordinate of each box.
+     * @param minZ The minimum z coordinate of each box.
+     * @param maxX The maximum x coordinate of each box.
+     * @param maxY The maximum y coordinate of each box.
+     * @param maxZ The maximum z coordinate of each box.
+     * @param count The number of boxes.
+     * @param visibility The bitset of the boxes to test, with bit i % 32 of word i / 32
+     *  set for box i. The bits of the hidden boxes are cleared.
+     * @return The number of visible boxes.
+     */
+    size_t cullBoxes(const float* minX, const float* minY, const float* minZ, const float* maxX, const float* maxY, const float* maxZ, size_t count,
+                     uint32_t* visibility) const;
+
+    /**
+     * Removes the objects hidden behind the occluders.
+     *
+     * The objects are tested with their world bounds and objects
+     * without bounds are kept. The order of the others is kept.
+     *
+     * @param objects The objects to cull, such as the result of Scene::queryObjects with the frustum.
+     * @return The number of objects removed.
+     */
+    size_t cullObjects(std::vector<SceneObject*>& objects) const;
+
+private:
+
+    struct Triangle
+    {
+        float x[3];
+        float y[3];
+        float a[3];
+        float b[3];
+        float depth;
+        float dzdx;
+        float dzdy;
+        float maxDepth;
+        int minX;
+        int minY;
+        int maxX;
+        int maxY;
+    };
+
+    struct Level
+    {
+        std::vector<float> depth;
+        size_t width;
+        size_t height;
+    };
+
+    OcclusionCuller(const OcclusionCuller& copy);
+    OcclusionCuller& operator=(const OcclusionCuller& copy);
+    void addTriangles(const uint32_t* indices, size_t indexCount, float winding);
+    void clipTriangle(const Vector4& v0, const Vector4& v1, const Vector4& v2, float winding);
+    void addTriangle(const Vector3& p0, const Vector3& p1, const Vector3& p2, float winding);
+    void project(const Vector4& clip, Vector3* dst) const;
+    void rasterizeTile(size_t tile);
+
+    std::vector<Level> _levels;
+    std::vector<Triangle> _triangles;
+    std::vector<std::vector<uint32_t>> _bins;
+    std::vector<Vector4> _vertices;
+    std::vector<Vector3> _projected;
+    std::vector<unsigned char> _outcodes;
+    std::shared_ptr<ThreadPool> _threadPool;
+    Matrix _viewProjection;
+    size_t _tilesX;
+    size_t _tilesY;
+};
+
+}
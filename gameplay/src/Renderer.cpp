@@ -4,7 +4,9 @@
 namespace gameplay
 {
 
-Renderer::Renderer() : Component()
+Renderer::Renderer() : Component(),
+    _geometry(std::make_shared<Geometry>()),
+    _materials(std::make_shared<std::vector<Material>>())
 {
 }
 
@@ -14,17 +16,46 @@ Renderer::~Renderer()
 
 const Geometry& Renderer::getGeometry() const
 {
-    return _geometry;
+    return *_geometry;
 }
 
 size_t Renderer::getMaterialCount() const
 {
-    return _materials.size();
+    return _materials->size();
 }
 
 const Material& Renderer::getMaterial(size_t index) const
 {
-    return _materials[index];
+    return (*_materials)[index];
+}
+
+bool Renderer::getBounds(BoundingBox* bounds)
+{
+    GP_ASSERT(bounds);
+    bounds->set(_geometry->getBounds());
+    return !bounds->isEmpty();
+}
+
+void Renderer::shareData(Renderer* renderer) const
+{
+    GP_ASSERT(renderer);
+    renderer->_geometry = _geometry;
+    renderer->_materials = _materials;
+}
+
+Geometry& Renderer::editGeometry()
+{
+    setBoundsDirty();
+    if (_geometry.use_count() > 1)
+        _geometry = std::make_shared<Geometry>(*_geometry);
+    return *_geometry;
+}
+
+std::vector<Material>& Renderer::editMaterials()
+{
+    if (_materials.use_count() > 1)
+        _materials = std::make_shared<std::vector<Material>>(*_materials);
+    return *_materials;
 }
 
 }
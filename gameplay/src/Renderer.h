@@ -51,10 +51,44 @@ public:
      */
     const Material& getMaterial(size_t index) const;
 
+    /**
+     * @see Component::getBounds
+     */
+    bool getBounds(BoundingBox* bounds);
+
 protected:
 
-    Geometry _geometry;
-    std::vector<Material> _materials;
+    /**
+     * Shares the geometry and materials with a clone of this renderer.
+     *
+     * Used by the clone of the renderer classes. The data is shared
+     * copy-on-write, so clones don't duplicate it until they change it.
+     *
+     * @param renderer The clone to share the data with.
+     */
+    void shareData(Renderer* renderer) const;
+
+    /**
+     * Gets the geometry to change it.
+     *
+     * The geometry is copied first if it is shared with other renderers.
+     * The bounds of the object are recomputed the next time they are used.
+     *
+     * @return The geometry owned by this renderer only.
+     */
+    Geometry& editGeometry();
+
+    /**
+     * Gets the materials to change them.
+     *
+     * The materials are copied first if they are shared with other renderers.
+     *
+     * @return The materials owned by this renderer only.
+     */
+    std::vector<Material>& editMaterials();
+
+    std::shared_ptr<Geometry> _geometry;
+    std::shared_ptr<std::vector<Material>> _materials;
 };
 
 }
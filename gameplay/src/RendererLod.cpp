@@ -0,0 +1,371 @@
+#include "Base.h"
+#include "RendererLod.h"
+#include "Camera.h"
+
+#define RENDERER_LOD_HYSTERESIS 0.1f
+
+namespace gameplay
+{
+
+const Component::TypeId RendererLod::TYPEID = Component::TYPEID_RENDERER_LOD;
+
+// The geometry and materials rendered when the object passes no threshold, shared by all the renderers.
+static const std::shared_ptr<Geometry>& getEmptyGeometry()
+{
+    static std::shared_ptr<Geometry> geometry = std::make_shared<Geometry>();
+    return geometry;
+}
+
+static const std::shared_ptr<std::vector<Material>>& getEmptyMaterials()
+{
+    static std::shared_ptr<std::vector<Material>> materials = std::make_shared<std::vector<Material>>();
+    return materials;
+}
+
+RendererLod::RendererLod() : Renderer(),
+    _metric(METRIC_SCREEN_SIZE),
+    _hysteresis(RENDERER_LOD_HYSTERESIS),
+    _level(0),
+    _rangeMin(-std::numeric_limits<float>::max()),
+    _rangeMax(std::numeric_limits<float>::max())
+{
+}
+
+RendererLod::~RendererLod()
+{
+}
+
+RendererLod::Metric RendererLod::getMetric() const
+{
+    return _metric;
+}
+
+void RendererLod::setMetric(RendererLod::Metric metric)
+{
+    _metric = metric;
+    updateRange();
+}
+
+float RendererLod::getHysteresis() const
+{
+    return _hysteresis;
+}
+
+void RendererLod::setHysteresis(float hysteresis)
+{
+    GP_ASSERT(hysteresis >= 0.0f && hysteresis < 1.0f);
+    _hysteresis = hysteresis;
+    updateRange();
+}
+
+void RendererLod::addLevel(std::shared_ptr<Geometry> geometry, std::shared_ptr<std::vector<Material>> materials, float threshold)
+{
+    GP_ASSERT(geometry);
+    GP_ASSERT(materials);
+    GP_ASSERT(_levels.empty() || (_metric == METRIC_SCREEN_SIZE ? threshold <= _levels.back().threshold : threshold >= _levels.back().threshold));
+
+    Level level;
+    level.geometry = geometry;
+    level.materials = materials;
+    level.threshold = threshold;
+    _levels.push_back(level);
+
+    // An object past the coarsest level renders the new one until its level is selected again.
+    if (_level == _levels.size() - 1)
+        setLevel(_level);
+    else
+        updateRange();
+    setBoundsDirty();
+}
+
+void RendererLod::clearLevels()
+{
+    _levels.clear();
+    _level = 0;
+    _geometry = std::make_shared<Geometry>();
+    _materials = std::make_shared<std::vector<Material>>();
+    updateRange();
+    setBoundsDirty();
+}
+
+size_t RendererLod::getLevelCount() const
+{
+    return _levels.size();
+}
+
+const Geometry& RendererLod::getLevelGeometry(size_t level) const
+{
+    GP_ASSERT(level < _levels.size());
+    return *_levels[level].geometry;
+}
+
+float RendererLod::getLevelThreshold(size_t level) const
+{
+    GP_ASSERT(level < _levels.size());
+    return _levels[level].threshold;
+}
+
+void RendererLod::setLevelThreshold(size_t level, float threshold)
+{
+    GP_ASSERT(level < _levels.size());
+    _levels[level].threshold = threshold;
+    updateRange();
+}
+
+size_t RendererLod::getLevel() const
+{
+    return _level;
+}
+
+void RendererLod::setLevel(size_t level)
+{
+    GP_ASSERT(level <= _levels.size());
+    _level = level;
+    if (level < _levels.size())
+    {
+        _geometry = _levels[level].geometry;
+        _materials = _levels[level].materials;
+    }
+    else
+    {
+        _geometry = getEmptyGeometry();
+        _materials = getEmptyMaterials();
+    }
+    updateRange();
+}
+
+size_t RendererLod::findLevel(float value, float hysteresis) const
+{
+    size_t count = _levels.size();
+    if (_metric == METRIC_SCREEN_SIZE)
+    {
+        float factor = 1.0f - hysteresis;
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (value >= _levels[i].threshold * factor)
+                return i;
+        }
+    }
+    else
+    {
+        float factor = 1.0f + hysteresis;
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (value <= _levels[i].threshold * factor)
+                return i;
+        }
+    }
+    return count;
+}
+
+bool RendererLod::selectLevel(float value)
+{
+    // Most objects keep their level from one frame to the next, which
+    // is decided without reading the levels.
+    if (value > _rangeMin && value < _rangeMax)
+        return false;
+
+    // The finest level passed with the thresholds moved toward the coarser
+    // levels by the hysteresis and the coarsest one passed with them moved
+    // the other way bound the levels that the current one is kept within.
+    size_t finest = findLevel(value, _hysteresis);
+    size_t coarsest = findLevel(value, -_hysteresis);
+    size_t level = std::min(std::max(_level, finest), coarsest);
+    if (level == _level)
+        return false;
+    setLevel(level);
+    return true;
+}
+
+void RendererLod::updateRange()
+{
+    // The values strictly inside the range keep the current level, the
+    // ones on its bounds or outside it go through the thresholds again.
+    _rangeMin = -std::numeric_limits<float>::max();
+    _rangeMax = std::numeric_limits<float>::max();
+    if (_levels.empty())
+        return;
+    size_t count = _levels.size();
+    if (_metric == METRIC_SCREEN_SIZE)
+    {
+        if (_level < count)
+            _rangeMin = _levels[_level].threshold * (1.0f - _hysteresis);
+        if (_level > 0)
+            _rangeMax = _levels[_level - 1].threshold * (1.0f + _hysteresis);
+    }
+    else
+    {
+        if (_level > 0)
+            _rangeMin = _levels[_level - 1].threshold * (1.0f - _hysteresis);
+        if (_level < count)
+            _rangeMax = _levels[_level].threshold * (1.0f + _hysteresis);
+    }
+}
+
+size_t RendererLod::selectLevels(const Camera& camera, const std::vector<SceneObject*>& objects, float bias)
+{
+    GP_ASSERT(bias > 0.0f);
+
+    // The screen size of a sphere is the height of its projection over the two
+    // units of normalized device coordinates, radius * m[5] / distance with a
+    // perspective projection and radius * m[5] with an orthographic one.
+    const Matrix& projection = camera.getProjectionMatrix();
+    const Matrix& world = camera.getInverseViewMatrix();
+    float eyeX = world.m[12];
+    float eyeY = world.m[13];
+    float eyeZ = world.m[14];
+    bool perspective = projection.m[11] != 0.0f;
+    float scale = projection.m[5] * bias;
+    float distanceScale = 1.0f / bias;
+
+    size_t changed = 0;
+    for (SceneObject* object : objects)
+    {
+        GP_ASSERT(object);
+        RendererLod* renderer = object->getComponent<RendererLod>();
+        if (!renderer || renderer->_levels.empty() || !renderer->isEnabled())
+            continue;
+
+        const BoundingBox& box = object->getWorldBoundingBox();
+        if (box.isEmpty())
+            continue;
+        float dx = (box.min.x + box.max.x) * 0.5f - eyeX;
+        float dy = (box.min.y + box.max.y) * 0.5f - eyeY;
+        float dz = (box.min.z + box.max.z) * 0.5f - eyeZ;
+        float distance = sqrt(dx * dx + dy * dy + dz * dz);
+
+        float value;
+        if (renderer->_metric == METRIC_DISTANCE)
+        {
+            value = distance * distanceScale;
+        }
+        else
+        {
+            float sx = box.max.x - box.min.x;
+            float sy = box.max.y - box.min.y;
+            float sz = box.max.z - box.min.z;
+            float radius = 0.5f * sqrt(sx * sx + sy * sy + sz * sz);
+            if (!perspective)
+                value = radius * scale;
+            else if (distance > radius)
+                value = radius * scale / distance;
+            else
+                value = std::numeric_limits<float>::max();
+        }
+        if (renderer->selectLevel(value))
+            ++changed;
+    }
+    return changed;
+}
+
+bool RendererLod::getBounds(BoundingBox* bounds)
+{
+    GP_ASSERT(bounds);
+    if (_levels.empty())
+        return Renderer::getBounds(bounds);
+
+    bool found = false;
+    for (const Level& level : _levels)
+    {
+        const BoundingBox& box = level.geometry->getBounds();
+        if (box.isEmpty())
+            continue;
+        if (found)
+        {
+            bounds->merge(box);
+        }
+        else
+        {
+            bounds->set(box);
+            found = true;
+        }
+    }
+    if (!found)
+        bounds->set(Vector3::zero(), Vector3::zero());
+    return found;
+}
+
+Component::TypeId RendererLod::getTypeId()
+{
+    return TYPEID;
+}
+
+std::shared_ptr<Component> RendererLod::clone()
+{
+    std::shared_ptr<RendererLod> renderer = Serializer::getActivator()->createShared<RendererLod>();
+    renderer->_enabled = _enabled;
+    shareData(renderer.get());
+    renderer->_levels = _levels;
+    renderer->_metric = _metric;
+    renderer->_hysteresis = _hysteresis;
+    renderer->_level = _level;
+    renderer->_rangeMin = _rangeMin;
+    renderer->_rangeMax = _rangeMax;
+    return renderer;
+}
+
+std::string RendererLod::getClassName()
+{
+    return "gameplay::RendererLod";
+}
+
+void RendererLod::onSerialize(Serializer* serializer)
+{
+    serializer->writeEnum("metric", "gameplay::RendererLod::Metric", _metric, -1);
+    serializer->writeFloat("hysteresis", _hysteresis, RENDERER_LOD_HYSTERESIS);
+    std::vector<float> thresholds(_levels.size());
+    for (size_t i = 0; i < _levels.size(); ++i)
+        thresholds[i] = _levels[i].threshold;
+    serializer->writeFloatArray("thresholds", thresholds.data(), thresholds.size());
+}
+
+void RendererLod::onDeserialize(Serializer* serializer)
+{
+    _metric = static_cast<RendererLod::Metric>(serializer->readEnum("metric", "gameplay::RendererLod::Metric", -1));
+    _hysteresis = serializer->readFloat("hysteresis", RENDERER_LOD_HYSTERESIS);
+
+    // The geometry and materials of the levels are not serialized, like
+    // the ones of the other renderers, so the levels start out empty.
+    float* thresholds = nullptr;
+    size_t count = serializer->readFloatArray("thresholds", &thresholds);
+    clearLevels();
+    for (size_t i = 0; i < count; ++i)
+        addLevel(std::make_shared<Geometry>(), std::make_shared<std::vector<Material>>(), thresholds[i]);
+    GP_SAFE_DELETE_ARRAY(thresholds);
+}
+
+std::shared_ptr<Serializable> RendererLod::createObject()
+{
+    return std::static_pointer_cast<Serializable>(Serializer::getActivator()->createShared<RendererLod>());
+}
+
+std::string RendererLod::enumToString(const std::string& enumName, int value)
+{
+    if (enumName.compare("gameplay::RendererLod::Metric") == 0)
+    {
+        switch (value)
+        {
+            case RendererLod::METRIC_SCREEN_SIZE:
+                return "METRIC_SCREEN_SIZE";
+            case RendererLod::METRIC_DISTANCE:
+                return "METRIC_DISTANCE";
+            default:
+                return "METRIC_SCREEN_SIZE";
+        }
+    }
+    return "";
+}
+
+int RendererLod::enumParse(const std::string& enumName, const std::string& str)
+{
+    if (enumName.compare("gameplay::RendererLod::Metric") == 0)
+    {
+        if (str.compare("METRIC_SCREEN_SIZE") == 0)
+            return RendererLod::METRIC_SCREEN_SIZE;
+        else if (str.compare("METRIC_DISTANCE") == 0)
+            return RendererLod::METRIC_DISTANCE;
+    }
+    return -1;
+}
+
+}
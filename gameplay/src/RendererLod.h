@@ -0,0 +1,255 @@
+#pragma once
+
+#include "Renderer.h"
+
+namespace gameplay
+{
+
+class Camera;
+
+/**
+ * Defines a renderer with several levels of detail.
+ *
+ * Each level has its own geometry and materials, from the most detailed
+ * one to the coarsest one, and a threshold. The level rendered is the
+ * first one whose threshold the object passes for the camera, so distant
+ * or small objects render their cheaper levels. An object that passes no
+ * threshold renders nothing.
+ *
+ * The levels of many objects are selected in one pass by selectLevels(),
+ * usually with the objects visible to the camera each frame. A level only
+ * changes once the object is past the threshold by the hysteresis, so the
+ * objects near a threshold don't switch back and forth as they move.
+ *
+ * The geometry and materials of the levels are shared, so the objects using
+ * the same model share the same levels. The bounds of the renderer enclose
+ * all the levels, so the bounds of the object don't change with the level.
+ */
+class RendererLod : public Renderer
+{
+    friend class SceneObject;
+    friend class Serializer::Activator;
+
+public:
+
+    /**
+     * Defines the metrics that the levels are selected with.
+     */
+    enum Metric
+    {
+        /**
+         * The height of the bounding sphere of the object on the screen, as
+         * a fraction of the height of the viewport. A level is rendered
+         * while the object is larger than its threshold, so the thresholds
+         * decrease from the most detailed level to the coarsest one.
+         */
+        METRIC_SCREEN_SIZE,
+
+        /**
+         * The distance from the camera to the center of the bounds of the
+         * object. A level is rendered while the object is closer than its
+         * threshold, so the thresholds increase from the most detailed level
+         * to the coarsest one.
+         */
+        METRIC_DISTANCE
+    };
+
+    /**
+     * Constructor.
+     */
+    RendererLod();
+
+    /**
+     * Destructor.
+     */
+    ~RendererLod();
+
+    /**
+     * Gets the metric that the levels are selected with.
+     *
+     * @return The metric that the levels are selected with.
+     */
+    RendererLod::Metric getMetric() const;
+
+    /**
+     * Sets the metric that the levels are selected with.
+     *
+     * @param metric The metric that the levels are selected with.
+     */
+    void setMetric(RendererLod::Metric metric);
+
+    /**
+     * Gets the hysteresis of the thresholds.
+     *
+     * @return The fraction of the thresholds that an object must be past them to change level.
+     */
+    float getHysteresis() const;
+
+    /**
+     * Sets the hysteresis of the thresholds.
+     *
+     * With a hysteresis of 0.1, an object rendered with a level changes to a
+     * coarser one at 90% of the screen size threshold or 110% of the distance
+     * threshold, and back at 110% and 90%. The default is 0.1.
+     *
+     * @param hysteresis The fraction of the thresholds that an object must be past them to change level.
+     */
+    void setHysteresis(float hysteresis);
+
+    /**
+     * Adds a level coarser than the levels already added.
+     *
+     * @param geometry The geometry of the level.
+     * @param materials The materials of the level.
+     * @param threshold The screen size or distance up to which the level is rendered.
+     */
+    void addLevel(std::shared_ptr<Geometry> geometry, std::shared_ptr<std::vector<Material>> materials, float threshold);
+
+    /**
+     * Removes all the levels.
+     */
+    void clearLevels();
+
+    /**
+     * Gets the number of levels.
+     *
+     * @return The number of levels.
+     */
+    size_t getLevelCount() const;
+
+    /**
+     * Gets the geometry of a level.
+     *
+     * @param level The level, 0 being the most detailed one.
+     * @return The geometry of the level.
+     */
+    const Geometry& getLevelGeometry(size_t level) const;
+
+    /**
+     * Gets the threshold of a level.
+     *
+     * @param level The level, 0 being the most detailed one.
+     * @return The screen size or distance up to which the level is rendered.
+     */
+    float getLevelThreshold(size_t level) const;
+
+    /**
+     * Sets the threshold of a level.
+     *
+     * @param level The level, 0 being the most detailed one.
+     * @param threshold The screen size or distance up to which the level is rendered.
+     */
+    void setLevelThreshold(size_t level, float threshold);
+
+    /**
+     * Gets the level rendered.
+     *
+     * Other systems can use it to do less work for the objects far from the
+     * camera, such as animating them at a lower rate.
+     *
+     * @return The level rendered, 0 being the most detailed one, or getLevelCount()
+     *  if the object is too small or too far to be rendered.
+     */
+    size_t getLevel() const;
+
+    /**
+     * Sets the level rendered.
+     *
+     * The level is kept until the next time it is selected.
+     *
+     * @param level The level to render, 0 being the most detailed one, or getLevelCount()
+     *  to render nothing.
+     */
+    void setLevel(size_t level);
+
+    /**
+     * Selects the level rendered by the objects for a camera.
+     *
+     * The objects without a renderer with levels of detail are skipped.
+     * The camera is only read, so its matrices are computed once for all
+     * the objects.
+     *
+     * @param camera The camera that the objects are rendered with.
+     * @param objects The objects, such as the result of Scene::queryObjects with the frustum of the camera.
+     * @param bias The factor of the level of detail. The screen sizes are multiplied by it
+     *  and the distances divided by it, so a bias below 1 selects coarser levels.
+     * @return The number of objects whose level changed.
+     */
+    static size_t selectLevels(const Camera& camera, const std::vector<SceneObject*>& objects, float bias = 1.0f);
+
+    /**
+     * Gets the bounds enclosing the geometry of all the levels.
+     *
+     * @see Component::getBounds
+     */
+    bool getBounds(BoundingBox* bounds);
+
+    /**
+     * The component type identifier of this class.
+     */
+    static const Component::TypeId TYPEID;
+
+    /**
+     * @see Component::getTypeId
+     */
+    Component::TypeId getTypeId();
+
+    /**
+     * @see Component::clone
+     */
+    std::shared_ptr<Component> clone();
+
+    /**
+     * @see Serializable::getClassName
+     */
+    std::string getClassName();
+
+    /**
+     * Serializes the metric, the hysteresis and the thresholds of the levels.
+     *
+     * @see Serializable::onSerialize
+     */
+    void onSerialize(Serializer* serializer);
+
+    /**
+     * @see Serializable::onDeserialize
+     */
+    void onDeserialize(Serializer* serializer);
+
+    /**
+     * @see Serializer::Activator::CreateObjectCallback
+     */
+    static std::shared_ptr<Serializable> createObject();
+
+    /**
+     * @see Serializer::Activator::EnumToStringCallback
+     */
+    static std::string enumToString(const std::string& enumName, int value);
+
+    /**
+     * @see Serializer::Activator::EnumParseCallback
+     */
+    static int enumParse(const std::string& enumName, const std::string& str);
+
+private:
+
+    struct Level
+    {
+        std::shared_ptr<Geometry> geometry;
+        std::shared_ptr<std::vector<Material>> materials;
+        float threshold;
+    };
+
+    size_t findLevel(float value, float hysteresis) const;
+    bool selectLevel(float value);
+    void updateRange();
+
+    std::vector<Level> _levels;
+    RendererLod::Metric _metric;
+    float _hysteresis;
+    size_t _level;
+    float _rangeMin;
+    float _rangeMax;
+};
+
+}
@@ -0,0 +1,1582 @@
+#include "Base.h"
+#include "Scene.h"
+#include "SceneObject.h"
+#include "BoundingVolumeHierarchy.h"
+
+#define SCENE_DIRTY_TRANSFORM_LOCAL 1
+#define SCENE_DIRTY_TRANSFORM_WORLD 2
+#define SCENE_DIRTY_TRANSFORM_WORLD_TO_LOCAL 8
+#define SCENE_DIRTY_ALL (SCENE_DIRTY_TRANSFORM_LOCAL | SCENE_DIRTY_TRANSFORM_WORLD | SCENE_DIRTY_TRANSFORM_WORLD_TO_LOCAL | SCENE_DIRTY_BOUNDS)
+#define SCENE_CHANGED_TRANSFORM_WORLD 4
+#define SCENE_BAKED 16
+#define SCENE_DIRTY_BOUNDS_LOCAL 32
+#define SCENE_DIRTY_BOUNDS_WORLD 64
+#define SCENE_DIRTY_BOUNDS_HIERARCHY 128
+#define SCENE_DIRTY_SPATIAL 256
+#define SCENE_DIRTY_BOUNDS (SCENE_DIRTY_BOUNDS_LOCAL | SCENE_DIRTY_BOUNDS_WORLD | SCENE_DIRTY_BOUNDS_HIERARCHY)
+#define SCENE_CHANGED_ENABLED 512
+#define SCENE_CHANGED_HIERARCHY 1024
+#define SCENE_DIRTY_EULER_ANGLES 2048
+#define SCENE_CHANGED (SCENE_CHANGED_TRANSFORM_WORLD | SCENE_CHANGED_ENABLED | SCENE_CHANGED_HIERARCHY)
+#define SCENE_PARALLEL_LEVEL_SIZE 1024
+#define SCENE_UNSORTED_RATIO 4
+#define SCENE_INSTANTIATE_ARENA_SIZE 65536
+#define SCENE_POOL_SIZE 64
+#define SCENE_POOL_OBJECT_CAPACITY 16
+
+namespace gameplay
+{
+
+const size_t Scene::INDEX_NONE;
+const uint32_t Scene::LAYER_DEFAULT;
+const uint32_t Scene::LAYER_ALL;
+
+static std::unordered_set<std::string> __names;
+static std::unordered_map<const std::string*, size_t> __nameCounts;
+static std::mutex __namesMutex;
+
+// The scenes released by detached and moved objects are kept per thread for the
+// next objects that need one. Only the small ones are kept, so their arrays don't
+// hold on to much memory, and the pool is only used until the thread exits.
+struct ScenePool
+{
+    ~ScenePool();
+    std::vector<Scene*> scenes;
+};
+static thread_local ScenePool __scenePool;
+static thread_local bool __scenePoolDestroyed = false;
+
+ScenePool::~ScenePool()
+{
+    for (Scene* scene : scenes)
+    {
+        delete scene;
+    }
+    __scenePoolDestroyed = true;
+}
+
+Scene::Listener::~Listener()
+{
+}
+
+Scene::Scene() :
+    _objectCount(0),
+    _bakedCount(0),
+    _unsortedCount(0),
+    _sorted(false),
+    _ordered(false),
+    _namesSorted(true)
+{
+}
+
+Scene::~Scene()
+{
+}
+
+std::shared_ptr<Scene> Scene::create()
+{
+    if (__scenePoolDestroyed)
+        return std::make_shared<Scene>();
+    Scene* scene;
+    if (__scenePool.scenes.empty())
+    {
+        scene = new Scene();
+    }
+    else
+    {
+        scene = __scenePool.scenes.back();
+        __scenePool.scenes.pop_back();
+    }
+    return std::shared_ptr<Scene>(scene, recycle);
+}
+
+void Scene::recycle(Scene* scene)
+{
+    if (__scenePoolDestroyed || __scenePool.scenes.size() >= SCENE_POOL_SIZE || scene->_objects.capacity() > SCENE_POOL_OBJECT_CAPACITY)
+    {
+        delete scene;
+        return;
+    }
+    scene->reset();
+    __scenePool.scenes.push_back(scene);
+}
+
+void Scene::reset()
+{
+    // The scene is only released once its objects are gone, so what is left
+    // are the dead slots and the state set on the scene itself. The arrays
+    // are cleared without giving back their memory.
+    _objects.clear();
+    _parents.clear();
+    _positions.clear();
+    _rotations.clear();
+    _eulerAngles.clear();
+    _scales.clear();
+    _layerMasks.clear();
+    _tagMasks.clear();
+    _localTransforms.clear();
+    _worldTransforms.clear();
+    _worldToLocalTransforms.clear();
+    _localBounds.clear();
+    _worldBounds.clear();
+    _hierarchyBounds.clear();
+    _dirtyBits.clear();
+    _nameSlots.clear();
+    _proxies.clear();
+    _levels.clear();
+    _childStarts.clear();
+    _journal.clear();
+    _changes.clear();
+    _listeners.clear();
+    _stack.clear();
+    _traversal.clear();
+    _boundsOrder.clear();
+    _nameIndex.clear();
+    _sortedNames.clear();
+    _matches.clear();
+    _candidates.clear();
+    _componentPools.clear();
+    _spatialIndex = nullptr;
+    _staticSpatialIndex = nullptr;
+    _spatialUpdates.clear();
+    _objectCount = 0;
+    _bakedCount = 0;
+    _unsortedCount = 0;
+    _sorted = false;
+    _ordered = false;
+    _namesSorted = true;
+    _threadPool = nullptr;
+}
+
+size_t Scene::getObjectCount() const
+{
+    return _objectCount;
+}
+
+std::shared_ptr<ThreadPool> Scene::getThreadPool() const
+{
+    return _threadPool;
+}
+
+void Scene::setThreadPool(std::shared_ptr<ThreadPool> threadPool)
+{
+    _threadPool = threadPool;
+}
+
+size_t Scene::getBakedObjectCount() const
+{
+    return _bakedCount;
+}
+
+void Scene::bake()
+{
+    if (!_sorted)
+        sort();
+
+    // Objects are visited parents first so the parent of each
+    // object is known to be baked or not when it is reached.
+    // The objects that get baked leave the dynamic spatial index.
+    updateWorldTransforms(0, _objectCount);
+    for (size_t i = 0; i < _objectCount; ++i)
+    {
+        size_t parent = _parents[i];
+        if (_objects[i]->_static && (parent == INDEX_NONE || (_dirtyBits[parent] & SCENE_BAKED)))
+        {
+            if (!(_dirtyBits[i] & SCENE_BAKED) && _proxies[i] != SpatialIndex::PROXY_NONE)
+            {
+                _spatialIndex->remove(_proxies[i]);
+                _proxies[i] = SpatialIndex::PROXY_NONE;
+            }
+            _dirtyBits[i] |= SCENE_BAKED;
+            _dirtyBits[i] &= ~(SCENE_CHANGED_TRANSFORM_WORLD | SCENE_DIRTY_SPATIAL);
+        }
+    }
+    sort();
+
+    // The hierarchy bounds of the baked objects are computed now rather than by
+    // the first query. The baked roots come first and each one is a whole subtree.
+    for (size_t i = 0; i < _bakedCount && _parents[i] == INDEX_NONE; ++i)
+    {
+        getHierarchyBounds(i);
+    }
+
+    // The baked objects don't move, so they get an index of their own that is built
+    // once with all of them and never refit. An object that is unbaked later leaves
+    // it for the dynamic index, which then only holds the objects that can move.
+    if (_staticSpatialIndex)
+    {
+        _staticSpatialIndex->clear();
+        for (size_t i = 0; i < _bakedCount; ++i)
+        {
+            _proxies[i] = SpatialIndex::PROXY_NONE;
+        }
+    }
+    else
+    {
+        _staticSpatialIndex = std::make_shared<BoundingVolumeHierarchy>();
+    }
+    populateSpatialIndex(_staticSpatialIndex.get(), true);
+}
+
+const std::vector<Scene::ChangeEntry>& Scene::updateTransforms()
+{
+    // The objects added, moved or released since the last sort are appended to the levels
+    // or left as dead slots, so the scene is only sorted again once they are a good part of it.
+    if (!_ordered || _unsortedCount > _objectCount / SCENE_UNSORTED_RATIO)
+        sort();
+
+    // Parents are always stored before their children so a single pass is enough.
+    // Dirty flags are propagated down the hierarchy when they are set, so only
+    // the dirty subtrees are recomputed here. The baked objects are stored
+    // first and skipped, the dead slots are never dirty.
+    if (_threadPool && _threadPool->getThreadCount() > 1)
+    {
+        // Objects on the same level only depend on the level above,
+        // so each level is split across the threads.
+        for (size_t level = 0; level + 1 < _levels.size(); ++level)
+        {
+            size_t begin = _levels[level];
+            size_t count = _levels[level + 1] - begin;
+            if (count < SCENE_PARALLEL_LEVEL_SIZE)
+            {
+                updateWorldTransforms(begin, begin + count);
+                continue;
+            }
+            _threadPool->execute(count, [this, begin](size_t first, size_t last)
+            {
+                updateWorldTransforms(begin + first, begin + last);
+            });
+        }
+    }
+    else
+    {
+        updateWorldTransforms(_bakedCount, _objects.size());
+    }
+
+    // The changes cleared by baking are skipped.
+    _changes.clear();
+    for (size_t index : _journal)
+    {
+        int& dirtyBits = _dirtyBits[index];
+        int changes = 0;
+        if (dirtyBits & SCENE_CHANGED_TRANSFORM_WORLD)
+            changes |= CHANGE_TRANSFORM;
+        if (dirtyBits & SCENE_CHANGED_ENABLED)
+            changes |= CHANGE_ENABLED;
+        if (dirtyBits & SCENE_CHANGED_HIERARCHY)
+            changes |= CHANGE_HIERARCHY;
+        dirtyBits &= ~SCENE_CHANGED;
+        if (changes)
+        {
+            ChangeEntry entry = { _objects[index], changes };
+            _changes.push_back(entry);
+        }
+    }
+    _journal.clear();
+    for (size_t i = 0; i < _listeners.size(); ++i)
+    {
+        _listeners[i]->onSceneChanged(this, _changes);
+    }
+    return _changes;
+}
+
+const std::vector<Scene::ChangeEntry>& Scene::getChanges() const
+{
+    return _changes;
+}
+
+void Scene::addListener(Scene::Listener* listener)
+{
+    GP_ASSERT(listener);
+    if (std::find(_listeners.begin(), _listeners.end(), listener) == _listeners.end())
+        _listeners.push_back(listener);
+}
+
+void Scene::removeListener(Scene::Listener* listener)
+{
+    auto itr = std::find(_listeners.begin(), _listeners.end(), listener);
+    if (itr != _listeners.end())
+        _listeners.erase(itr);
+}
+
+void Scene::updateWorldTransforms(size_t begin, size_t end)
+{
+    for (size_t i = begin; i < end; ++i)
+    {
+        if (_dirtyBits[i] & SCENE_DIRTY_TRANSFORM_WORLD)
+        {
+            const AffineTransform& localTransform = getLocalTransform(i);
+            size_t parent = _parents[i];
+            if (parent == INDEX_NONE)
+                _worldTransforms[i] = localTransform;
+            else
+                AffineTransform::multiply(_worldTransforms[parent], localTransform, &_worldTransforms[i]);
+            _dirtyBits[i] &= ~SCENE_DIRTY_TRANSFORM_WORLD;
+        }
+    }
+}
+
+void Scene::reserve(size_t count)
+{
+    _objects.reserve(count);
+    _parents.reserve(count);
+    _positions.reserve(count);
+    _rotations.reserve(count);
+    _eulerAngles.reserve(count);
+    _scales.reserve(count);
+    _layerMasks.reserve(count);
+    _tagMasks.reserve(count);
+    _localTransforms.reserve(count);
+    _worldTransforms.reserve(count);
+    _worldToLocalTransforms.reserve(count);
+    _localBounds.reserve(count);
+    _worldBounds.reserve(count);
+    _hierarchyBounds.reserve(count);
+    _dirtyBits.reserve(count);
+    _nameSlots.reserve(count);
+    _proxies.reserve(count);
+}
+
+size_t Scene::allocate(SceneObject* object, size_t parent)
+{
+    GP_ASSERT(object);
+
+    size_t index = _objects.size();
+    _objects.push_back(object);
+    _parents.push_back(parent);
+    _positions.push_back(Vector3::zero());
+    _rotations.push_back(Quaternion::identity());
+    _eulerAngles.push_back(Vector3::zero());
+    _scales.push_back(Vector3::one());
+    _layerMasks.push_back(LAYER_DEFAULT);
+    _tagMasks.push_back(0);
+    _localTransforms.push_back(AffineTransform::identity());
+    _worldTransforms.push_back(AffineTransform::identity());
+    _worldToLocalTransforms.push_back(AffineTransform::identity());
+    _localBounds.push_back(BoundingBox::empty());
+    _worldBounds.push_back(BoundingBox::empty());
+    _hierarchyBounds.push_back(BoundingBox::empty());
+    _dirtyBits.push_back(SCENE_DIRTY_ALL);
+    _nameSlots.push_back(0);
+    _proxies.push_back(SpatialIndex::PROXY_NONE);
+    insertName(index);
+    for (const auto& component : object->_components)
+    {
+        insertComponent(component.get());
+    }
+    setChanged(index, SCENE_CHANGED_TRANSFORM_WORLD | SCENE_CHANGED_HIERARCHY);
+    ++_objectCount;
+    _sorted = false;
+    if (_ordered)
+        appendToLevels(index, parent);
+    if (parent != INDEX_NONE)
+        setHierarchyBoundsDirty(parent);
+    setSpatialDirty(index);
+    return index;
+}
+
+void Scene::release(size_t index)
+{
+    GP_ASSERT(index < _objects.size());
+    GP_ASSERT(_objects[index]);
+
+    // The slot is left dead until the next sort reclaims it. Its data is
+    // kept for copy, without the bits that would update or report it.
+    if (_parents[index] != INDEX_NONE)
+        setHierarchyBoundsDirty(_parents[index]);
+    eraseName(index);
+    for (const auto& component : _objects[index]->_components)
+    {
+        eraseComponent(component.get());
+    }
+    if (_proxies[index] != SpatialIndex::PROXY_NONE)
+    {
+        getSpatialIndex(index)->remove(_proxies[index]);
+        _proxies[index] = SpatialIndex::PROXY_NONE;
+    }
+
+    _objects[index] = nullptr;
+    _dirtyBits[index] &= ~(SCENE_DIRTY_TRANSFORM_WORLD | SCENE_CHANGED);
+    --_objectCount;
+    ++_unsortedCount;
+    _sorted = false;
+}
+
+void Scene::copy(size_t index, const Scene& scene, size_t sceneIndex)
+{
+    _positions[index] = scene._positions[sceneIndex];
+    _rotations[index] = scene._rotations[sceneIndex];
+    _eulerAngles[index] = scene._eulerAngles[sceneIndex];
+    _scales[index] = scene._scales[sceneIndex];
+    _layerMasks[index] = scene._layerMasks[sceneIndex];
+    _tagMasks[index] = scene._tagMasks[sceneIndex];
+    _localTransforms[index] = scene._localTransforms[sceneIndex];
+    _worldTransforms[index] = scene._worldTransforms[sceneIndex];
+    _worldToLocalTransforms[index] = scene._worldToLocalTransforms[sceneIndex];
+    _localBounds[index] = scene._localBounds[sceneIndex];
+    _dirtyBits[index] = (scene._dirtyBits[sceneIndex] & ~(SCENE_BAKED | SCENE_DIRTY_SPATIAL | SCENE_CHANGED)) | (_dirtyBits[index] & SCENE_CHANGED) |
+        SCENE_DIRTY_TRANSFORM_WORLD | SCENE_DIRTY_TRANSFORM_WORLD_TO_LOCAL | SCENE_DIRTY_BOUNDS_WORLD | SCENE_DIRTY_BOUNDS_HIERARCHY;
+    setSpatialDirty(index);
+}
+
+void Scene::setParent(size_t index, size_t parent)
+{
+    // The old parents lose the subtree from their bounds.
+    if (_parents[index] != INDEX_NONE)
+        setHierarchyBoundsDirty(_parents[index]);
+    _parents[index] = parent;
+    setChanged(index, SCENE_CHANGED_HIERARCHY);
+    setDirty(index, SCENE_DIRTY_TRANSFORM_WORLD);
+    _sorted = false;
+
+    // The order still holds while the parent is on an earlier level,
+    // otherwise the subtree is moved after it.
+    if (_ordered && parent != INDEX_NONE && getLevel(parent) >= getLevel(index))
+        relocate(index);
+}
+
+SceneObject* Scene::getParent(size_t index) const
+{
+    size_t parent = _parents[index];
+    return parent == INDEX_NONE ? nullptr : _objects[parent];
+}
+
+const Vector3& Scene::getLocalPosition(size_t index) const
+{
+    return _positions[index];
+}
+
+void Scene::setLocalPosition(size_t index, const Vector3& position)
+{
+    _positions[index] = position;
+    setDirty(index, SCENE_DIRTY_TRANSFORM_LOCAL);
+}
+
+const Quaternion& Scene::getLocalRotation(size_t index) const
+{
+    return _rotations[index];
+}
+
+void Scene::setLocalRotation(size_t index, const Quaternion& rotation)
+{
+    // The euler angles are derived when they are read, most
+    // rotations are set every frame and never read as angles.
+    _rotations[index] = rotation;
+    setDirty(index, SCENE_DIRTY_TRANSFORM_LOCAL | SCENE_DIRTY_EULER_ANGLES);
+}
+
+const Vector3& Scene::getLocalEulerAngles(size_t index)
+{
+    if (_dirtyBits[index] & SCENE_DIRTY_EULER_ANGLES)
+    {
+        _rotations[index].toEulerAngles(&_eulerAngles[index]);
+        _dirtyBits[index] &= ~SCENE_DIRTY_EULER_ANGLES;
+    }
+    return _eulerAngles[index];
+}
+
+void Scene::setLocalEulerAngles(size_t index, const Vector3& eulerAngles)
+{
+    _eulerAngles[index] = eulerAngles;
+    _rotations[index].set(eulerAngles);
+    _dirtyBits[index] &= ~SCENE_DIRTY_EULER_ANGLES;
+    setDirty(index, SCENE_DIRTY_TRANSFORM_LOCAL);
+}
+
+const Vector3& Scene::getLocalScale(size_t index) const
+{
+    return _scales[index];
+}
+
+void Scene::setLocalScale(size_t index, const Vector3& scale)
+{
+    _scales[index] = scale;
+    setDirty(index, SCENE_DIRTY_TRANSFORM_LOCAL);
+}
+
+void Scene::setLocalTransform(size_t index, const Vector3* position, const Quaternion* rotation, const Vector3* scale)
+{
+    int dirtyBits = SCENE_DIRTY_TRANSFORM_LOCAL;
+    if (position)
+        _positions[index] = *position;
+    if (rotation)
+    {
+        _rotations[index] = *rotation;
+        dirtyBits |= SCENE_DIRTY_EULER_ANGLES;
+    }
+    if (scale)
+        _scales[index] = *scale;
+    setDirty(index, dirtyBits);
+}
+
+void Scene::setLocalTransforms(const std::vector<SceneObject*>& objects, const Vector3* positions, const Quaternion* rotations, const Vector3* scales)
+{
+    for (size_t i = 0; i < objects.size(); ++i)
+    {
+        SceneObject* object = objects[i];
+        GP_ASSERT(object && object->_scene.get() == this);
+        setLocalTransform(object->_index, positions ? &positions[i] : nullptr, rotations ? &rotations[i] : nullptr, scales ? &scales[i] : nullptr);
+    }
+}
+
+void Scene::setLocalTransforms(const std::vector<SceneObjectHandle>& objects, const Vector3* positions, const Quaternion* rotations, const Vector3* scales)
+{
+    for (size_t i = 0; i < objects.size(); ++i)
+    {
+        SceneObject* object = objects[i].get();
+        if (!object)
+            continue;
+        GP_ASSERT(object->_scene.get() == this);
+        setLocalTransform(object->_index, positions ? &positions[i] : nullptr, rotations ? &rotations[i] : nullptr, scales ? &scales[i] : nullptr);
+    }
+}
+
+uint32_t Scene::getLayerMask(size_t index) const
+{
+    return _layerMasks[index];
+}
+
+void Scene::setLayerMask(size_t index, uint32_t layerMask)
+{
+    // The bounds don't change, so the proxy is updated in place.
+    _layerMasks[index] = layerMask;
+    if (_proxies[index] != SpatialIndex::PROXY_NONE)
+        getSpatialIndex(index)->setLayerMask(_proxies[index], layerMask);
+}
+
+uint64_t Scene::getTagMask(size_t index) const
+{
+    return _tagMasks[index];
+}
+
+void Scene::setTagMask(size_t index, uint64_t tagMask)
+{
+    _tagMasks[index] = tagMask;
+}
+
+const AffineTransform& Scene::getLocalTransform(size_t index)
+{
+    if (_dirtyBits[index] & SCENE_DIRTY_TRANSFORM_LOCAL)
+    {
+        _localTransforms[index].set(_positions[index], _rotations[index], _scales[index]);
+        _dirtyBits[index] &= ~SCENE_DIRTY_TRANSFORM_LOCAL;
+    }
+    return _localTransforms[index];
+}
+
+const AffineTransform& Scene::getWorldTransform(size_t index)
+{
+    if (_dirtyBits[index] & SCENE_DIRTY_TRANSFORM_WORLD)
+    {
+        // Gather the dirty ancestors and update them from the top down,
+        // so deep hierarchies don't recurse.
+        _stack.clear();
+        for (size_t current = index; current != INDEX_NONE && (_dirtyBits[current] & SCENE_DIRTY_TRANSFORM_WORLD); current = _parents[current])
+        {
+            _stack.push_back(current);
+        }
+        while (!_stack.empty())
+        {
+            size_t current = _stack.back();
+            _stack.pop_back();
+            const AffineTransform& localTransform = getLocalTransform(current);
+            size_t parent = _parents[current];
+            if (parent == INDEX_NONE)
+                _worldTransforms[current] = localTransform;
+            else
+                AffineTransform::multiply(_worldTransforms[parent], localTransform, &_worldTransforms[current]);
+            _dirtyBits[current] &= ~SCENE_DIRTY_TRANSFORM_WORLD;
+        }
+    }
+    return _worldTransforms[index];
+}
+
+const AffineTransform& Scene::getWorldToLocalTransform(size_t index)
+{
+    // The inverse is only computed when asked for since most objects never need it.
+    // It stays dirty through the world updates until the world transform changes
+    // and the inverse is requested again.
+    if (_dirtyBits[index] & SCENE_DIRTY_TRANSFORM_WORLD_TO_LOCAL)
+    {
+        if (!getWorldTransform(index).invert(&_worldToLocalTransforms[index]))
+            _worldToLocalTransforms[index].setIdentity();
+        _dirtyBits[index] &= ~SCENE_DIRTY_TRANSFORM_WORLD_TO_LOCAL;
+    }
+    return _worldToLocalTransforms[index];
+}
+
+static void mergeBounds(const BoundingBox& box, BoundingBox* dst)
+{
+    // Objects without bounds have an empty box that doesn't count.
+    if (box.isEmpty())
+        return;
+    if (dst->isEmpty())
+        dst->set(box);
+    else
+        dst->merge(box);
+}
+
+const BoundingBox& Scene::getLocalBounds(size_t index)
+{
+    if (_dirtyBits[index] & SCENE_DIRTY_BOUNDS_LOCAL)
+    {
+        BoundingBox& localBounds = _localBounds[index];
+        localBounds.set(BoundingBox::empty());
+        for (const auto& component : _objects[index]->_components)
+        {
+            BoundingBox bounds;
+            if (component->getBounds(&bounds))
+                mergeBounds(bounds, &localBounds);
+        }
+        _dirtyBits[index] &= ~SCENE_DIRTY_BOUNDS_LOCAL;
+    }
+    return _localBounds[index];
+}
+
+const BoundingBox& Scene::getWorldBounds(size_t index)
+{
+    if (_dirtyBits[index] & SCENE_DIRTY_BOUNDS_WORLD)
+    {
+        BoundingBox& worldBounds = _worldBounds[index];
+        worldBounds.set(getLocalBounds(index));
+        if (!worldBounds.isEmpty())
+            worldBounds.transform(getWorldTransform(index));
+        _dirtyBits[index] &= ~SCENE_DIRTY_BOUNDS_WORLD;
+    }
+    return _worldBounds[index];
+}
+
+const BoundingBox& Scene::getHierarchyBounds(size_t index)
+{
+    if (_dirtyBits[index] & SCENE_DIRTY_BOUNDS_HIERARCHY)
+    {
+        // The ancestors of a dirty object are always dirty, so the clean objects are used as
+        // they are. Only the subtree is visited, whatever the size of the scene.
+        if (_sorted && index >= _bakedCount)
+        {
+            // The subtree is one run of objects per level, the children of the run before it.
+            // Going back up the runs each object is complete when it is merged into its parent.
+            _boundsOrder.clear();
+            for (size_t begin = index, end = index + 1; begin < end;)
+            {
+                _boundsOrder.push_back(begin);
+                _boundsOrder.push_back(end);
+                begin = _childStarts[begin];
+                end = _childStarts[end];
+            }
+            for (size_t run = _boundsOrder.size(); run > 0; run -= 2)
+            {
+                for (size_t i = _boundsOrder[run - 1]; i-- > _boundsOrder[run - 2];)
+                {
+                    if (!(_dirtyBits[i] & SCENE_DIRTY_BOUNDS_HIERARCHY))
+                        continue;
+                    BoundingBox& bounds = _hierarchyBounds[i];
+                    bounds.set(getWorldBounds(i));
+                    for (size_t child = _childStarts[i]; child < _childStarts[i + 1]; ++child)
+                        mergeBounds(_hierarchyBounds[child], &bounds);
+                    _dirtyBits[i] &= ~SCENE_DIRTY_BOUNDS_HIERARCHY;
+                }
+            }
+        }
+        else
+        {
+            // The children of a baked object are split between the baked objects and the others,
+            // and sorting here would move the arrays under the references handed out, so the
+            // dirty part of the subtree is gathered breadth first instead.
+            _boundsOrder.clear();
+            _boundsOrder.push_back(index);
+            for (size_t i = 0; i < _boundsOrder.size(); ++i)
+            {
+                for (const std::shared_ptr<SceneObject>& child : _objects[_boundsOrder[i]]->_children)
+                {
+                    if (_dirtyBits[child->_index] & SCENE_DIRTY_BOUNDS_HIERARCHY)
+                        _boundsOrder.push_back(child->_index);
+                }
+            }
+            for (size_t i = _boundsOrder.size(); i-- > 0;)
+            {
+                size_t current = _boundsOrder[i];
+                BoundingBox& bounds = _hierarchyBounds[current];
+                bounds.set(getWorldBounds(current));
+                for (const std::shared_ptr<SceneObject>& child : _objects[current]->_children)
+                    mergeBounds(_hierarchyBounds[child->_index], &bounds);
+                _dirtyBits[current] &= ~SCENE_DIRTY_BOUNDS_HIERARCHY;
+            }
+        }
+    }
+    return _hierarchyBounds[index];
+}
+
+bool Scene::isBaked(size_t index) const
+{
+    return (_dirtyBits[index] & SCENE_BAKED) != 0;
+}
+
+void Scene::setChanged(size_t index, int changedBits)
+{
+    // An object is queued once until the next update.
+    if (!(_dirtyBits[index] & SCENE_CHANGED))
+        _journal.push_back(index);
+    _dirtyBits[index] |= changedBits;
+}
+
+void Scene::setEnabledChanged(size_t index)
+{
+    setChanged(index, SCENE_CHANGED_ENABLED);
+}
+
+void Scene::setDirty(size_t index, int dirtyBits)
+{
+    // A dirty world transform invalidates the whole subtree below it. Once a node
+    // is world dirty all of its descendants are too, so those are skipped.
+    // Baked objects are never world dirty, a change to one of them unbakes its
+    // subtree and moves it back to the per frame update on the next sort.
+    // A descendant that is already world dirty hasn't been read since its
+    // transform version last changed, so it keeps that version.
+    bool propagate = (_dirtyBits[index] & SCENE_DIRTY_TRANSFORM_WORLD) == 0;
+    if (_dirtyBits[index] & SCENE_BAKED)
+        unbake(index);
+    _dirtyBits[index] |= dirtyBits | SCENE_DIRTY_TRANSFORM_WORLD | SCENE_DIRTY_TRANSFORM_WORLD_TO_LOCAL | SCENE_DIRTY_BOUNDS_WORLD;
+    ++_objects[index]->_transformVersion;
+    setChanged(index, SCENE_CHANGED_TRANSFORM_WORLD);
+    setHierarchyBoundsDirty(index);
+    setSpatialDirty(index);
+    if (!propagate || _objects[index]->_children.empty())
+        return;
+
+    _stack.clear();
+    _stack.push_back(index);
+    while (!_stack.empty())
+    {
+        size_t current = _stack.back();
+        _stack.pop_back();
+        for (const auto& child : _objects[current]->_children)
+        {
+            size_t childIndex = child->_index;
+            if (_dirtyBits[childIndex] & SCENE_DIRTY_TRANSFORM_WORLD)
+                continue;
+            if (_dirtyBits[childIndex] & SCENE_BAKED)
+                unbake(childIndex);
+            _dirtyBits[childIndex] |= SCENE_DIRTY_TRANSFORM_WORLD | SCENE_DIRTY_TRANSFORM_WORLD_TO_LOCAL | SCENE_DIRTY_BOUNDS_WORLD | SCENE_DIRTY_BOUNDS_HIERARCHY;
+            ++child->_transformVersion;
+            setChanged(childIndex, SCENE_CHANGED_TRANSFORM_WORLD);
+            setSpatialDirty(childIndex);
+            _stack.push_back(childIndex);
+        }
+    }
+}
+
+void Scene::unbake(size_t index)
+{
+    // The static index is never refit, so the object moves to the dynamic one.
+    // It is inserted there with the updates queued by setSpatialDirty.
+    _dirtyBits[index] &= ~SCENE_BAKED;
+    if (_proxies[index] != SpatialIndex::PROXY_NONE)
+    {
+        _staticSpatialIndex->remove(_proxies[index]);
+        _proxies[index] = SpatialIndex::PROXY_NONE;
+    }
+    _sorted = false;
+    _ordered = false;
+}
+
+void Scene::unbakeSubtree(size_t index)
+{
+    // Nothing moved, so the transforms and their versions are kept. The parent
+    // of a baked object is always baked, so the walk stops at the other objects.
+    if (!(_dirtyBits[index] & SCENE_BAKED))
+        return;
+    _stack.clear();
+    _stack.push_back(index);
+    while (!_stack.empty())
+    {
+        size_t current = _stack.back();
+        _stack.pop_back();
+        unbake(current);
+        setSpatialDirty(current);
+        for (const auto& child : _objects[current]->_children)
+        {
+            if (_dirtyBits[child->_index] & SCENE_BAKED)
+                _stack.push_back(child->_index);
+        }
+    }
+}
+
+void Scene::setBoundsDirty(size_t index)
+{
+    _dirtyBits[index] |= SCENE_DIRTY_BOUNDS;
+    setHierarchyBoundsDirty(index);
+    setSpatialDirty(index);
+}
+
+void Scene::setHierarchyBoundsDirty(size_t index)
+{
+    // The hierarchy bounds of the ancestors enclose this object. Once one is
+    // dirty all the ones above it are too, so the walk up stops there.
+    _dirtyBits[index] |= SCENE_DIRTY_BOUNDS_HIERARCHY;
+    for (size_t parent = _parents[index]; parent != INDEX_NONE; parent = _parents[parent])
+    {
+        if (_dirtyBits[parent] & SCENE_DIRTY_BOUNDS_HIERARCHY)
+            break;
+        _dirtyBits[parent] |= SCENE_DIRTY_BOUNDS_HIERARCHY;
+    }
+}
+
+void Scene::setSpatialDirty(size_t index)
+{
+    // Nothing is tracked until the index is built, by the first query
+    // for the dynamic one and by bake for the static one.
+    if (!getSpatialIndex(index) || (_dirtyBits[index] & SCENE_DIRTY_SPATIAL))
+        return;
+    _dirtyBits[index] |= SCENE_DIRTY_SPATIAL;
+    _spatialUpdates.push_back(_objects[index]->_handle);
+}
+
+std::shared_ptr<SpatialIndex> Scene::getSpatialIndex()
+{
+    updateSpatialIndex();
+    return _spatialIndex;
+}
+
+SpatialIndex* Scene::getSpatialIndex(size_t index) const
+{
+    return (_dirtyBits[index] & SCENE_BAKED) ? _staticSpatialIndex.get() : _spatialIndex.get();
+}
+
+void Scene::setSpatialIndex(std::shared_ptr<SpatialIndex> spatialIndex)
+{
+    if (spatialIndex == _spatialIndex)
+        return;
+    // The baked objects stay in the static index, along with their queued updates.
+    if (_spatialIndex)
+    {
+        _spatialIndex->clear();
+        for (size_t i = 0; i < _objects.size(); ++i)
+        {
+            if (_dirtyBits[i] & SCENE_BAKED)
+                continue;
+            _proxies[i] = SpatialIndex::PROXY_NONE;
+            _dirtyBits[i] &= ~SCENE_DIRTY_SPATIAL;
+        }
+    }
+    _spatialIndex = spatialIndex;
+    if (_spatialIndex)
+        populateSpatialIndex(_spatialIndex.get(), false);
+}
+
+void Scene::populateSpatialIndex(SpatialIndex* spatialIndex, bool baked)
+{
+    // Everything is inserted at once, which lets the index build itself faster.
+    std::vector<SceneObject*> objects;
+    std::vector<BoundingBox> boxes;
+    std::vector<uint32_t> layerMasks;
+    std::vector<size_t> proxies;
+    for (size_t i = 0; i < _objects.size(); ++i)
+    {
+        if (!_objects[i] || ((_dirtyBits[i] & SCENE_BAKED) != 0) != baked)
+            continue;
+        const BoundingBox& bounds = getWorldBounds(i);
+        if (!bounds.isEmpty())
+        {
+            objects.push_back(_objects[i]);
+            boxes.push_back(bounds);
+            layerMasks.push_back(_layerMasks[i]);
+        }
+    }
+    spatialIndex->insert(objects, boxes, layerMasks, proxies);
+    for (size_t i = 0; i < objects.size(); ++i)
+    {
+        _proxies[objects[i]->_index] = proxies[i];
+    }
+}
+
+void Scene::updateSpatialIndex()
+{
+    if (!_spatialIndex)
+    {
+        _spatialIndex = std::make_shared<BoundingVolumeHierarchy>();
+        populateSpatialIndex(_spatialIndex.get(), false);
+    }
+
+    // The updates are queued by handle since the indices move when the scene
+    // is sorted. Objects that were destroyed or moved to another scene since
+    // are skipped, they were removed from the index when they left. A baked
+    // object is only queued when its bounds change without it moving, the
+    // static index is updated in place for those.
+    for (const SceneObjectHandle& handle : _spatialUpdates)
+    {
+        SceneObject* object = handle.get();
+        if (!object || object->_scene.get() != this)
+            continue;
+        size_t index = object->_index;
+        if (!(_dirtyBits[index] & SCENE_DIRTY_SPATIAL))
+            continue;
+        _dirtyBits[index] &= ~SCENE_DIRTY_SPATIAL;
+        SpatialIndex* spatialIndex = getSpatialIndex(index);
+        const BoundingBox& bounds = getWorldBounds(index);
+        size_t& proxy = _proxies[index];
+        if (bounds.isEmpty())
+        {
+            if (proxy != SpatialIndex::PROXY_NONE)
+            {
+                spatialIndex->remove(proxy);
+                proxy = SpatialIndex::PROXY_NONE;
+            }
+        }
+        else if (proxy == SpatialIndex::PROXY_NONE)
+        {
+            proxy = spatialIndex->insert(object, bounds, _layerMasks[index]);
+        }
+        else
+        {
+            spatialIndex->update(proxy, bounds);
+        }
+    }
+    _spatialUpdates.clear();
+}
+
+size_t Scene::queryObjects(const BoundingBox& box, std::vector<SceneObject*>& objects, uint32_t layerMask)
+{
+    updateSpatialIndex();
+    size_t count = _spatialIndex->query(box, objects, layerMask);
+    if (_staticSpatialIndex)
+        count += _staticSpatialIndex->query(box, objects, layerMask);
+    return count;
+}
+
+size_t Scene::queryObjects(const BoundingSphere& sphere, std::vector<SceneObject*>& objects, uint32_t layerMask)
+{
+    updateSpatialIndex();
+    size_t count = _spatialIndex->query(sphere, objects, layerMask);
+    if (_staticSpatialIndex)
+        count += _staticSpatialIndex->query(sphere, objects, layerMask);
+    return count;
+}
+
+size_t Scene::queryObjects(const Frustum& frustum, std::vector<SceneObject*>& objects, uint32_t layerMask)
+{
+    updateSpatialIndex();
+    size_t count = _spatialIndex->query(frustum, objects, layerMask);
+    if (_staticSpatialIndex)
+        count += _staticSpatialIndex->query(frustum, objects, layerMask);
+    return count;
+}
+
+size_t Scene::queryNearest(const Vector3& point, size_t count, std::vector<SceneObject*>& objects, float maxDistance, uint32_t layerMask)
+{
+    updateSpatialIndex();
+    if (count == 0)
+        return 0;
+    if (!_staticSpatialIndex)
+        return _spatialIndex->queryNearest(point, count, maxDistance, objects, layerMask);
+
+    // The larger index is searched first since its objects are usually nearer. Once it
+    // found enough objects the other one only needs to look as far as the last of them.
+    // Both lists are nearest first, so they are merged and the ones beyond the count dropped.
+    SpatialIndex* first = _spatialIndex.get();
+    SpatialIndex* second = _staticSpatialIndex.get();
+    if (second->getObjectCount() > first->getObjectCount())
+        std::swap(first, second);
+    auto distanceSquared = [this, &point](SceneObject* object)
+    {
+        return getWorldBounds(object->_index).getCenter().distanceSquared(point);
+    };
+    size_t begin = objects.size();
+    size_t found = first->queryNearest(point, count, maxDistance, objects, layerMask);
+    if (found > 0 && found == count)
+        maxDistance = std::min(maxDistance, std::sqrt(distanceSquared(objects.back())));
+    size_t middle = objects.size();
+    found += second->queryNearest(point, count, maxDistance, objects, layerMask);
+    std::inplace_merge(objects.begin() + begin, objects.begin() + middle, objects.end(), [&distanceSquared](SceneObject* a, SceneObject* b)
+    {
+        return distanceSquared(a) < distanceSquared(b);
+    });
+    if (found > count)
+    {
+        objects.resize(begin + count);
+        found = count;
+    }
+    return found;
+}
+
+bool Scene::raycast(const Ray& ray, SpatialIndex::Hit* hit, float maxDistance, uint32_t layerMask)
+{
+    GP_ASSERT(hit);
+
+    updateSpatialIndex();
+    if (!_staticSpatialIndex)
+        return _spatialIndex->raycast(ray, maxDistance, hit, layerMask);
+
+    // The larger index is searched first and the other one only needs to look as far as its hit.
+    SpatialIndex* first = _spatialIndex.get();
+    SpatialIndex* second = _staticSpatialIndex.get();
+    if (second->getObjectCount() > first->getObjectCount())
+        std::swap(first, second);
+    bool found = first->raycast(ray, maxDistance, hit, layerMask);
+    SpatialIndex::Hit secondHit;
+    if (second->raycast(ray, found ? hit->distance : maxDistance, &secondHit, layerMask) && (!found || secondHit.distance < hit->distance))
+    {
+        *hit = secondHit;
+        found = true;
+    }
+    return found;
+}
+
+size_t Scene::raycastAll(const Ray& ray, std::vector<SpatialIndex::Hit>& hits, float maxDistance, uint32_t layerMask)
+{
+    updateSpatialIndex();
+    size_t begin = hits.size();
+    size_t found = _spatialIndex->raycastAll(ray, maxDistance, hits, layerMask);
+    if (!_staticSpatialIndex)
+        return found;
+
+    // Both lists are nearest first, so they are merged.
+    size_t middle = hits.size();
+    found += _staticSpatialIndex->raycastAll(ray, maxDistance, hits, layerMask);
+    std::inplace_merge(hits.begin() + begin, hits.begin() + middle, hits.end(), [](const SpatialIndex::Hit& a, const SpatialIndex::Hit& b)
+    {
+        return a.distance < b.distance;
+    });
+    return found;
+}
+
+size_t Scene::findTaggedObjects(uint64_t tagMask, std::vector<SceneObject*>& objects, uint32_t layerMask) const
+{
+    size_t count = objects.size();
+    for (size_t i = 0; i < _objects.size(); ++i)
+    {
+        if ((_layerMasks[i] & layerMask) && (_tagMasks[i] & tagMask) == tagMask && _objects[i])
+            objects.push_back(_objects[i]);
+    }
+    return objects.size() - count;
+}
+
+const std::vector<Component*>& Scene::getComponents(Component::TypeId typeId) const
+{
+    static const std::vector<Component*> empty;
+    if ((size_t)typeId >= _componentPools.size())
+        return empty;
+    return _componentPools[typeId];
+}
+
+void Scene::instantiate(std::shared_ptr<SceneObject> prefab, size_t count, std::vector<std::shared_ptr<SceneObject>>& objects)
+{
+    GP_ASSERT(prefab);
+    if (count == 0)
+        return;
+
+    // Flatten the prefab breadth first once, with the position of each parent.
+    std::vector<SceneObject*> prefabObjects;
+    std::vector<size_t> prefabParents;
+    size_t componentCount = 0;
+    prefabObjects.push_back(prefab.get());
+    prefabParents.push_back(INDEX_NONE);
+    for (size_t i = 0; i < prefabObjects.size(); ++i)
+    {
+        componentCount += prefabObjects[i]->_components.size();
+        for (const auto& child : prefabObjects[i]->_children)
+        {
+            prefabObjects.push_back(child.get());
+            prefabParents.push_back(i);
+        }
+    }
+
+    // The copies are grouped into arenas of a bounded size, each one sized for
+    // its copies, so a copy that outlives the others only keeps the memory of
+    // its own group. The components are cloned through the activator so they
+    // come from the arena too.
+    // Only their clone knows the types of the components, so the first copy is
+    // made in an arena of its own and the memory it took gives the size of a
+    // copy. With a block size of one, each of its allocations gets a block of
+    // its own of the exact size. In the other arenas the objects, their control
+    // blocks and the components are each padded at most to the alignment of any type.
+    size_t objectCount = prefabObjects.size();
+    size_t allocationCount = objectCount * 2 + componentCount;
+    size_t copySize = 0;
+    size_t arenaCopies = 1;
+    std::shared_ptr<Arena> arena = std::make_shared<Arena>(1);
+    Serializer::Activator* activator = Serializer::getActivator();
+    std::shared_ptr<Arena> activatorArena = activator->getArena();
+    activator->setArena(arena);
+
+    std::shared_ptr<Scene> scene = shared_from_this();
+    reserve(_objects.size() + count * objectCount);
+    objects.reserve(objects.size() + count);
+    std::vector<SceneObject*> clones(objectCount);
+    for (size_t n = 0; n < count; ++n)
+    {
+        if (n == 1)
+        {
+            copySize = arena->getSize() + allocationCount * alignof(std::max_align_t);
+            arenaCopies = std::max(SCENE_INSTANTIATE_ARENA_SIZE / copySize, (size_t)1);
+        }
+        if (n > 0 && (n - 1) % arenaCopies == 0)
+        {
+            arena = std::make_shared<Arena>(std::min(arenaCopies, count - n) * copySize);
+            activator->setArena(arena);
+        }
+        for (size_t i = 0; i < objectCount; ++i)
+        {
+            size_t parent = prefabParents[i];
+            std::shared_ptr<SceneObject> clone = SceneObject::createClone(*prefabObjects[i], scene, parent == INDEX_NONE ? INDEX_NONE : clones[parent]->_index, arena);
+            clones[i] = clone.get();
+            if (parent == INDEX_NONE)
+                objects.push_back(clone);
+            else
+                clones[parent]->_children.push_back(clone);
+        }
+    }
+    activator->setArena(activatorArena);
+}
+
+void Scene::insertComponent(Component* component)
+{
+    // The pools are only created for the types that are used.
+    size_t typeId = component->getTypeId();
+    if (typeId >= _componentPools.size())
+        _componentPools.resize(typeId + 1);
+    std::vector<Component*>& pool = _componentPools[typeId];
+    component->_poolIndex = pool.size();
+    pool.push_back(component);
+}
+
+void Scene::eraseComponent(Component* component)
+{
+    // Swap with the last component so the removal is constant time.
+    std::vector<Component*>& pool = _componentPools[component->getTypeId()];
+    GP_ASSERT(pool[component->_poolIndex] == component);
+    Component* last = pool.back();
+    pool[component->_poolIndex] = last;
+    last->_poolIndex = component->_poolIndex;
+    pool.pop_back();
+}
+
+void Scene::insertName(size_t index)
+{
+    SceneObject* object = _objects[index];
+    std::vector<SceneObject*>& objects = _nameIndex[object->_name];
+    if (objects.empty())
+        _namesSorted = false;
+    _nameSlots[index] = objects.size();
+    objects.push_back(object);
+}
+
+void Scene::eraseName(size_t index)
+{
+    SceneObject* object = _objects[index];
+    auto itr = _nameIndex.find(object->_name);
+    GP_ASSERT(itr != _nameIndex.end());
+
+    // Swap with the last object so the removal is constant time.
+    std::vector<SceneObject*>& objects = itr->second;
+    size_t slot = _nameSlots[index];
+    SceneObject* last = objects.back();
+    objects[slot] = last;
+    _nameSlots[last->_index] = slot;
+    objects.pop_back();
+    if (objects.empty())
+    {
+        _nameIndex.erase(itr);
+        _namesSorted = false;
+    }
+}
+
+size_t Scene::NameHash::operator()(const std::string* name) const
+{
+    return std::hash<std::string>()(*name);
+}
+
+bool Scene::NameEqual::operator()(const std::string* a, const std::string* b) const
+{
+    return a == b || *a == *b;
+}
+
+size_t Scene::countNamedObjects(const std::string& name, bool exactMatch, const std::string** key)
+{
+    if (exactMatch)
+    {
+        // The entry is found by content, its key is the name the objects hold.
+        auto itr = _nameIndex.find(&name);
+        if (itr == _nameIndex.end())
+            return 0;
+        *key = itr->first;
+        return itr->second.size();
+    }
+
+    // All the names starting with the prefix are next to each other.
+    sortNames();
+    size_t count = 0;
+    auto itr = std::lower_bound(_sortedNames.begin(), _sortedNames.end(), name, [](const std::string* a, const std::string& b)
+    {
+        return *a < b;
+    });
+    for (; itr != _sortedNames.end() && (*itr)->compare(0, name.size(), name) == 0; ++itr)
+    {
+        count += _nameIndex.find(*itr)->second.size();
+    }
+    return count;
+}
+
+void Scene::findSubtreeObjects(size_t index, const std::string& name, bool exactMatch, bool first, std::vector<SceneObject*>& objects)
+{
+    // In a sorted scene the subtree is one run of objects per level, so the depth of an
+    // object is the run that holds it and the objects of a level are in breadth first order.
+    // Otherwise each object walks up its parents once.
+    bool sorted = _sorted && index >= _bakedCount;
+    std::vector<size_t>& runs = _boundsOrder;
+    runs.clear();
+    if (sorted)
+    {
+        for (size_t begin = index, end = index + 1; begin < end; begin = _childStarts[begin], end = _childStarts[end])
+        {
+            runs.push_back(begin);
+            runs.push_back(end);
+        }
+    }
+    _candidates.clear();
+    size_t bestDepth = INDEX_NONE;
+    SceneObject* best = nullptr;
+    auto visit = [&](const std::vector<SceneObject*>& named)
+    {
+        for (SceneObject* object : named)
+        {
+            size_t depth = INDEX_NONE;
+            if (sorted)
+            {
+                size_t i = object->_index;
+                if (i <= index || i >= runs.back())
+                    continue;
+                auto run = std::upper_bound(runs.begin(), runs.end(), i);
+                if (((run - runs.begin()) & 1) == 0)
+                    continue;
+                depth = (run - runs.begin()) / 2;
+            }
+            else
+            {
+                depth = getDepth(object->_index, index);
+                if (depth == 0 || depth == INDEX_NONE)
+                    continue;
+            }
+            if (!first)
+                _candidates.push_back(std::make_pair(depth, object));
+            else if (depth < bestDepth || (depth == bestDepth && (sorted ? object->_index < best->_index : object->precedes(best))))
+            {
+                best = object;
+                bestDepth = depth;
+            }
+        }
+    };
+
+    if (exactMatch)
+    {
+        auto itr = _nameIndex.find(&name);
+        if (itr != _nameIndex.end())
+            visit(itr->second);
+    }
+    else
+    {
+        sortNames();
+        auto itr = std::lower_bound(_sortedNames.begin(), _sortedNames.end(), name, [](const std::string* a, const std::string& b)
+        {
+            return *a < b;
+        });
+        for (; itr != _sortedNames.end() && (*itr)->compare(0, name.size(), name) == 0; ++itr)
+        {
+            visit(_nameIndex.find(*itr)->second);
+        }
+    }
+
+    if (first)
+    {
+        if (best)
+            objects.push_back(best);
+        return;
+    }
+
+    // The nearest levels come first, and the objects of a level in breadth first order when it is known.
+    std::stable_sort(_candidates.begin(), _candidates.end(), [sorted](const std::pair<size_t, SceneObject*>& a, const std::pair<size_t, SceneObject*>& b)
+    {
+        return a.first < b.first || (sorted && a.first == b.first && a.second->_index < b.second->_index);
+    });
+    for (const auto& candidate : _candidates)
+    {
+        objects.push_back(candidate.second);
+    }
+}
+
+size_t Scene::getSubtreeSize(size_t index) const
+{
+    // A sorted subtree is one run of objects per level, otherwise its size isn't known without walking it.
+    if (!_sorted || index < _bakedCount)
+        return INDEX_NONE;
+    size_t size = 0;
+    for (size_t begin = index, end = index + 1; begin < end; begin = _childStarts[begin], end = _childStarts[end])
+    {
+        size += end - begin;
+    }
+    return size;
+}
+
+void Scene::sortNames()
+{
+    // The distinct names are sorted on demand after names were added or removed.
+    if (_namesSorted)
+        return;
+    _sortedNames.clear();
+    for (const auto& entry : _nameIndex)
+    {
+        _sortedNames.push_back(entry.first);
+    }
+    std::sort(_sortedNames.begin(), _sortedNames.end(), [](const std::string* a, const std::string* b)
+    {
+        return *a < *b;
+    });
+    _namesSorted = true;
+}
+
+size_t Scene::getDepth(size_t index, size_t ancestor) const
+{
+    size_t depth = 0;
+    while (index != INDEX_NONE && index != ancestor)
+    {
+        index = _parents[index];
+        ++depth;
+    }
+    return index == ancestor ? depth : INDEX_NONE;
+}
+
+static const std::string* getEmptyName()
+{
+    // The default name is held by most objects while they are created. It is
+    // interned once and never released, so it doesn't take the lock each time.
+    static const std::string* emptyName = []()
+    {
+        std::lock_guard<std::mutex> lock(__namesMutex);
+        return &*__names.insert(std::string()).first;
+    }();
+    return emptyName;
+}
+
+const std::string* Scene::internName(const std::string& name)
+{
+    if (name.empty())
+        return getEmptyName();
+    std::lock_guard<std::mutex> lock(__namesMutex);
+    const std::string* interned = &*__names.insert(name).first;
+    ++__nameCounts[interned];
+    return interned;
+}
+
+const std::string* Scene::retainName(const std::string* name)
+{
+    GP_ASSERT(name);
+    if (name == getEmptyName())
+        return name;
+    std::lock_guard<std::mutex> lock(__namesMutex);
+    ++__nameCounts[name];
+    return name;
+}
+
+void Scene::releaseName(const std::string* name)
+{
+    // Each name counts the objects that hold it and is removed with the
+    // last of them, so the names generated at runtime don't pile up.
+    // The entries of the set don't move, so the pointers stay valid until then.
+    GP_ASSERT(name);
+    if (name == getEmptyName())
+        return;
+    std::lock_guard<std::mutex> lock(__namesMutex);
+    auto itr = __nameCounts.find(name);
+    GP_ASSERT(itr != __nameCounts.end());
+    if (--itr->second == 0)
+    {
+        __nameCounts.erase(itr);
+        __names.erase(*name);
+    }
+}
+
+size_t Scene::getLevel(size_t index) const
+{
+    // The baked objects are on level 0, before the first level that is updated.
+    return std::upper_bound(_levels.begin(), _levels.end(), index) - _levels.begin();
+}
+
+void Scene::appendToLevels(size_t index, size_t parent)
+{
+    // The object joins the last level, unless its parent is on it and it starts a new
+    // one. Every parent stays on an earlier level than its children, so the levels are
+    // still updated one after the other, they just aren't breadth first anymore.
+    GP_ASSERT(index == _levels.back());
+    if (parent != INDEX_NONE && parent >= _levels[_levels.size() - 2])
+        _levels.push_back(index + 1);
+    else
+        _levels.back() = index + 1;
+    ++_unsortedCount;
+}
+
+void Scene::relocate(size_t index)
+{
+    // The subtree is appended breadth first after its new parent. The slots it leaves
+    // are dead until the next sort, like the ones of the released objects.
+    size_t base = _traversal.size();
+    _traversal.push_back(_objects[index]);
+    for (size_t i = base; i < _traversal.size(); ++i)
+    {
+        SceneObject* object = _traversal[i];
+        size_t from = object->_index;
+        size_t to = _objects.size();
+        _objects.push_back(object);
+        _parents.push_back(_parents[from]);
+        _positions.push_back(_positions[from]);
+        _rotations.push_back(_rotations[from]);
+        _eulerAngles.push_back(_eulerAngles[from]);
+        _scales.push_back(_scales[from]);
+        _layerMasks.push_back(_layerMasks[from]);
+        _tagMasks.push_back(_tagMasks[from]);
+        _localTransforms.push_back(_localTransforms[from]);
+        _worldTransforms.push_back(_worldTransforms[from]);
+        _worldToLocalTransforms.push_back(_worldToLocalTransforms[from]);
+        _localBounds.push_back(_localBounds[from]);
+        _worldBounds.push_back(_worldBounds[from]);
+        _hierarchyBounds.push_back(_hierarchyBounds[from]);
+        _dirtyBits.push_back(_dirtyBits[from]);
+        _nameSlots.push_back(_nameSlots[from]);
+        _proxies.push_back(_proxies[from]);
+        _objects[from] = nullptr;
+        _dirtyBits[from] &= ~(SCENE_DIRTY_TRANSFORM_WORLD | SCENE_CHANGED);
+        _proxies[from] = SpatialIndex::PROXY_NONE;
+        ++_unsortedCount;
+
+        // The pending changes are reported from the new slot.
+        if (_dirtyBits[to] & SCENE_CHANGED)
+            _journal.push_back(to);
+        object->_index = to;
+        appendToLevels(to, _parents[to]);
+        for (const auto& child : object->_children)
+        {
+            _parents[child->_index] = to;
+            _traversal.push_back(child.get());
+        }
+    }
+    _traversal.resize(base);
+}
+
+template <class T>
+static void reorder(std::vector<T>& values, const std::vector<size_t>& order)
+{
+    std::vector<T> sorted;
+    sorted.reserve(order.size());
+    for (size_t index : order)
+    {
+        sorted.push_back(values[index]);
+    }
+    values.swap(sorted);
+}
+
+void Scene::sort()
+{
+    // Gather the baked objects breadth first starting from the roots.
+    // The parent of a baked object is always baked, so they come first.
+    std::vector<size_t> order;
+    order.reserve(_objectCount);
+    for (size_t i = 0; i < _objects.size(); ++i)
+    {
+        if (_objects[i] && _parents[i] == INDEX_NONE && (_dirtyBits[i] & SCENE_BAKED))
+            order.push_back(i);
+    }
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        for (const auto& child : _objects[order[i]]->_children)
+        {
+            if (_dirtyBits[child->_index] & SCENE_BAKED)
+                order.push_back(child->_index);
+        }
+    }
+    _bakedCount = order.size();
+
+    // The other objects follow breadth first, starting from the
+    // roots and from the children of the baked objects.
+    for (size_t i = 0; i < _objects.size(); ++i)
+    {
+        if (_objects[i] && _parents[i] == INDEX_NONE && !(_dirtyBits[i] & SCENE_BAKED))
+            order.push_back(i);
+    }
+    for (size_t i = 0; i < _bakedCount; ++i)
+    {
+        for (const auto& child : _objects[order[i]]->_children)
+        {
+            if (!(_dirtyBits[child->_index] & SCENE_BAKED))
+                order.push_back(child->_index);
+        }
+    }
+
+    // Record where each level starts so that a level can be updated in parallel,
+    // and where the children of each object start so that a subtree can be walked
+    // one level at a time. The children of an object that isn't baked are stored
+    // together and the children of the next object follow, so the children of
+    // index i are the ones from _childStarts[i] up to _childStarts[i + 1].
+    _levels.clear();
+    _levels.push_back(_bakedCount);
+    _childStarts.resize(_objectCount + 1);
+    size_t levelEnd = order.size();
+    for (size_t i = _bakedCount; i < order.size(); ++i)
+    {
+        if (i == levelEnd)
+        {
+            _levels.push_back(i);
+            levelEnd = order.size();
+        }
+        _childStarts[i] = order.size();
+        for (const auto& child : _objects[order[i]]->_children)
+        {
+            order.push_back(child->_index);
+        }
+    }
+    _levels.push_back(order.size());
+    _childStarts[order.size()] = order.size();
+    GP_ASSERT(order.size() == _objectCount);
+
+    // Remap the parent indices into the new order.
+    std::vector<size_t> remap(_objects.size(), INDEX_NONE);
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        remap[order[i]] = i;
+    }
+    reorder(_objects, order);
+    reorder(_parents, order);
+    reorder(_positions, order);
+    reorder(_rotations, order);
+    reorder(_eulerAngles, order);
+    reorder(_scales, order);
+    reorder(_layerMasks, order);
+    reorder(_tagMasks, order);
+    reorder(_localTransforms, order);
+    reorder(_worldTransforms, order);
+    reorder(_worldToLocalTransforms, order);
+    reorder(_localBounds, order);
+    reorder(_worldBounds, order);
+    reorder(_hierarchyBounds, order);
+    reorder(_dirtyBits, order);
+    reorder(_nameSlots, order);
+    reorder(_proxies, order);
+    for (size_t i = 0; i < _objects.size(); ++i)
+    {
+        _objects[i]->_index = i;
+        if (_parents[i] != INDEX_NONE)
+            _parents[i] = remap[_parents[i]];
+    }
+
+    // The journal follows, without the objects destroyed or moved to another scene.
+    size_t journalCount = 0;
+    for (size_t index : _journal)
+    {
+        if (remap[index] != INDEX_NONE)
+            _journal[journalCount++] = remap[index];
+    }
+    _journal.resize(journalCount);
+    _unsortedCount = 0;
+    _sorted = true;
+    _ordered = true;
+}
+
+}
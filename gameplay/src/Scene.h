@@ -0,0 +1,503 @@
+#pragma once
+
+#include "Vector3.h"
+#include "Quaternion.h"
+#include "AffineTransform.h"
+#include "BoundingBox.h"
+#include "SpatialIndex.h"
+#include "ThreadPool.h"
+#include "Component.h"
+
+namespace gameplay
+{
+
+class SceneObject;
+
+/**
+ * Defines the shared data store for a hierarchy of scene objects.
+ *
+ * Every scene object belongs to exactly one scene. The root of a
+ * hierarchy owns the scene and all of its descendants share it.
+ * Transforms are stored in dense arrays (structure of arrays) that
+ * are ordered breadth first with parent indices, so a single linear
+ * pass over the arrays updates every world transform in the hierarchy.
+ * Objects added or moved afterwards are appended after their parents and
+ * the slots of the removed ones are left dead, so the arrays are only
+ * sorted again once those make up a good part of the scene.
+ *
+ * The SceneObject getters and setters are views into this store.
+ * An object gets a scene of its own when it is first used outside of
+ * a hierarchy, so the objects created to be added to a parent are only
+ * stored in the scene of the parent. The small scenes that are released
+ * are kept for reuse with the memory of their arrays.
+ *
+ * The bounds of the objects and of their subtrees are kept in the same
+ * arrays and are recomputed lazily when they are used after a change.
+ * The objects with bounds are also indexed for the spatial queries, by a
+ * bounding volume hierarchy unless another index is set. It is built on the
+ * first query and the objects whose bounds changed are updated in it before
+ * each query. The baked objects are kept apart in a bounding volume hierarchy
+ * of their own that is built by bake and never refit, and the queries search
+ * both indices.
+ *
+ * The changes to the world transforms, the enabled states and the hierarchy
+ * are recorded in a journal that is published once per frame by
+ * updateTransforms, so the caches that depend on the objects update only
+ * what changed. Each object also has a transform version that changes with
+ * its world transform, for the caches that check a few objects on demand.
+ *
+ * Each object is on a set of layers and has a set of tags, as bit masks
+ * stored next to its transform. The queries and traversals take masks
+ * to filter the objects with, so whole categories are rejected with a
+ * single AND instead of comparing names or looking for components.
+ *
+ * The components attached to the objects are pooled per type.
+ * The scene also indexes its objects by name. The index is keyed by the
+ * interned names but hashes and compares them by content, so a name is
+ * looked up without going through the shared names. A sorted list of
+ * the distinct names backs the prefix searches.
+ */
+class Scene : public std::enable_shared_from_this<Scene>
+{
+    friend class SceneObject;
+
+public:
+
+    /**
+     * The layer mask of the objects not put on other layers.
+     */
+    static const uint32_t LAYER_DEFAULT = 1;
+
+    /**
+     * The layer mask of all the layers.
+     */
+    static const uint32_t LAYER_ALL = 0xffffffff;
+
+    /**
+     * Defines the kinds of changes recorded in the change journal.
+     */
+    enum Change
+    {
+        CHANGE_TRANSFORM = 1,
+        CHANGE_ENABLED = 2,
+        CHANGE_HIERARCHY = 4
+    };
+
+    /**
+     * Defines an object recorded in the change journal.
+     */
+    struct ChangeEntry
+    {
+        /**
+         * The object that changed.
+         */
+        SceneObject* object;
+
+        /**
+         * The changes to the object, a combination of the Change bits.
+         */
+        int changes;
+    };
+
+    /**
+     * Defines an interface for the caches that follow the changes of a scene.
+     */
+    class Listener
+    {
+    public:
+
+        /**
+         * Destructor.
+         */
+        virtual ~Listener();
+
+        /**
+         * Called once per frame by updateTransforms with the change journal.
+         *
+         * @param scene The scene that changed.
+         * @param changes The objects that changed since the last update.
+         */
+        virtual void onSceneChanged(Scene* scene, const std::vector<Scene::ChangeEntry>& changes) = 0;
+    };
+
+    /**
+     * Constructor.
+     */
+    Scene();
+
+    /**
+     * Destructor.
+     */
+    ~Scene();
+
+    /**
+     * Gets the number of objects in the scene.
+     *
+     * @return The number of objects in the scene.
+     */
+    size_t getObjectCount() const;
+
+    /**
+     * Gets the thread pool used to update the scene in parallel.
+     *
+     * @return The thread pool or nullptr if the scene is updated on the calling thread.
+     */
+    std::shared_ptr<ThreadPool> getThreadPool() const;
+
+    /**
+     * Sets the thread pool used to update the scene in parallel.
+     *
+     * When set, each breadth first level of the hierarchy is split across
+     * the threads of the pool. The results are identical to the serial update.
+     *
+     * @param threadPool The thread pool or nullptr to update on the calling thread.
+     */
+    void setThreadPool(std::shared_ptr<ThreadPool> threadPool);
+
+    /**
+     * Sets the local transforms of many objects of the scene at once.
+     *
+     * This is for the crowds and other large groups of objects that move
+     * every frame. The values are written straight into the arrays of the
+     * scene and each object is marked dirty once for all of its changes.
+     * The euler angles of the rotations are only derived if they are read.
+     *
+     * @param objects The objects of this scene to set the transforms of.
+     * @param positions The local position of each object, or nullptr to keep the positions.
+     * @param rotations The local rotation of each object, or nullptr to keep the rotations.
+     * @param scales The local scale of each object, or nullptr to keep the scales.
+     */
+    void setLocalTransforms(const std::vector<SceneObject*>& objects, const Vector3* positions, const Quaternion* rotations, const Vector3* scales);
+
+    /**
+     * Sets the local transforms of many objects of the scene at once.
+     *
+     * The handles that expired are skipped along with their values.
+     *
+     * @param objects The handles of the objects of this scene to set the transforms of.
+     * @param positions The local position of each object, or nullptr to keep the positions.
+     * @param rotations The local rotation of each object, or nullptr to keep the rotations.
+     * @param scales The local scale of each object, or nullptr to keep the scales.
+     */
+    void setLocalTransforms(const std::vector<SceneObjectHandle>& objects, const Vector3* positions, const Quaternion* rotations, const Vector3* scales);
+
+    /**
+     * Updates the world transforms of the objects in the scene that are dirty.
+     *
+     * Changing the local transform or parent of an object marks its whole
+     * subtree dirty. The objects are visited one level at a time so that
+     * every parent is updated before any of its children.
+     *
+     * The change journal is published afterwards and the listeners are
+     * notified. This is called once per frame by the game after updating.
+     *
+     * @return The objects that changed since the last update.
+     *         The list is owned by the scene and is valid until the next update.
+     */
+    const std::vector<Scene::ChangeEntry>& updateTransforms();
+
+    /**
+     * Gets the change journal published by the last update.
+     *
+     * Each object that changed is listed once with all of its changes. A
+     * change to the world transform of an object is recorded for each of its
+     * descendants as well. The objects destroyed or moved to another scene
+     * since they changed are left out, the objects moved into this scene are
+     * recorded with a hierarchy change.
+     *
+     * @return The objects that changed between the last two updates.
+     */
+    const std::vector<Scene::ChangeEntry>& getChanges() const;
+
+    /**
+     * Adds a listener notified of the change journal on each update.
+     *
+     * @param listener The listener to add. The scene doesn't own it.
+     */
+    void addListener(Scene::Listener* listener);
+
+    /**
+     * Removes a listener.
+     *
+     * @param listener The listener to remove.
+     */
+    void removeListener(Scene::Listener* listener);
+
+    /**
+     * Bakes the static parts of the hierarchy.
+     *
+     * An object is baked when it is static and its parent is baked or it
+     * has no parent. The world transforms and the hierarchy bounds of the
+     * baked objects are computed once and they are stored apart, so
+     * updateTransforms doesn't visit them anymore. They are inserted into a
+     * static spatial index that is built at once and never refit, so moving
+     * objects don't make the queries walk through them. Changing the
+     * transform or the parent of a baked object unbakes it along with its
+     * descendants, which moves them back to the dynamic spatial index and
+     * sorts the whole scene again on the next update.
+     *
+     * This is called by the game once a scene is loaded. Objects are static
+     * unless they are set otherwise, so every loaded object is baked unless
+     * the scene marks it as not static. Objects that move should be marked
+     * so, or the first move of each one pays for unbaking it.
+     */
+    void bake();
+
+    /**
+     * Gets the number of baked objects in the scene.
+     *
+     * @return The number of baked objects in the scene.
+     */
+    size_t getBakedObjectCount() const;
+
+    /**
+     * Gets the components of a type attached to the objects in the scene.
+     *
+     * The components of each type are kept in a dense array so systems can
+     * iterate them linearly. The entries can be cast to the class of the type.
+     * The order changes when components are attached or detached.
+     *
+     * @param typeId The type of components to get.
+     * @return The components of the type. The array is owned by the scene.
+     */
+    const std::vector<Component*>& getComponents(Component::TypeId typeId) const;
+
+    /**
+     * Creates copies of a prefab object and its descendants in this scene.
+     *
+     * The copies are roots in this scene, adding them as children of an
+     * object of this scene afterwards doesn't move their data. The first
+     * copy is allocated on its own and the memory it takes sizes the others,
+     * which are allocated from arenas of about 64 KB, each holding as many
+     * whole copies as fit and at least one. An arena is freed once the last copy
+     * allocated from it is released, so a copy that is kept also keeps the
+     * memory of the other copies of its arena, but not of the other arenas.
+     * The components are copied with Component::clone and share their
+     * immutable data with the prefab.
+     *
+     * @param prefab The object to copy with its descendants.
+     * @param count The number of copies to create.
+     * @param objects A vector that the root object of each copy is appended to.
+     */
+    void instantiate(std::shared_ptr<SceneObject> prefab, size_t count, std::vector<std::shared_ptr<SceneObject>>& objects);
+
+    /**
+     * Gets the spatial index of the objects of the scene.
+     *
+     * The index is brought up to date first. A bounding volume hierarchy
+     * is created if no index was set. The baked objects are not in it,
+     * they are in the static index built by bake.
+     *
+     * @return The spatial index of the objects of the scene.
+     */
+    std::shared_ptr<SpatialIndex> getSpatialIndex();
+
+    /**
+     * Sets the spatial index of the objects of the scene.
+     *
+     * The objects are removed from the previous index and inserted into
+     * the new one, which should be empty. A spatial hash grid suits scenes
+     * of many small objects that move every frame and neighbor queries.
+     * The baked objects stay in the static index built by bake.
+     *
+     * @param spatialIndex The spatial index, or nullptr for a bounding volume hierarchy.
+     */
+    void setSpatialIndex(std::shared_ptr<SpatialIndex> spatialIndex);
+
+    /**
+     * Finds the objects whose world bounds intersect a box.
+     *
+     * @param box The box to test against.
+     * @param objects A vector that the objects found are appended to.
+     * @param layerMask The layers to search, objects on none of them are skipped.
+     * @return The number of objects found.
+     */
+    size_t queryObjects(const BoundingBox& box, std::vector<SceneObject*>& objects, uint32_t layerMask = LAYER_ALL);
+
+    /**
+     * Finds the objects whose world bounds intersect a sphere.
+     *
+     * @param sphere The sphere to test against.
+     * @param objects A vector that the objects found are appended to.
+     * @param layerMask The layers to search, objects on none of them are skipped.
+     * @return The number of objects found.
+     */
+    size_t queryObjects(const BoundingSphere& sphere, std::vector<SceneObject*>& objects, uint32_t layerMask = LAYER_ALL);
+
+    /**
+     * Finds the objects whose world bounds intersect a frustum.
+     *
+     * @param frustum The frustum to test against.
+     * @param objects A vector that the objects found are appended to.
+     * @param layerMask The layers to search, objects on none of them are skipped.
+     * @return The number of objects found.
+     */
+    size_t queryObjects(const Frustum& frustum, std::vector<SceneObject*>& objects, uint32_t layerMask = LAYER_ALL);
+
+    /**
+     * Finds the objects nearest to a point.
+     *
+     * The position of an object is the center of its world bounds.
+     *
+     * @param point The point to measure from.
+     * @param count The largest number of objects to find.
+     * @param objects A vector that the objects found are appended to, nearest first.
+     * @param maxDistance The distance beyond which objects are ignored.
+     * @param layerMask The layers to search, objects on none of them are skipped.
+     * @return The number of objects found.
+     */
+    size_t queryNearest(const Vector3& point, size_t count, std::vector<SceneObject*>& objects, float maxDistance = std::numeric_limits<float>::max(),
+                        uint32_t layerMask = LAYER_ALL);
+
+    /**
+     * Finds the nearest object whose world bounds are hit by a ray.
+     *
+     * @param ray The ray to test against. The direction should be normalized.
+     * @param hit The nearest hit if one is found.
+     * @param maxDistance The distance along the ray beyond which objects are ignored.
+     * @param layerMask The layers to search, objects on none of them are skipped.
+     * @return true if an object is hit, false if not.
+     */
+    bool raycast(const Ray& ray, SpatialIndex::Hit* hit, float maxDistance = std::numeric_limits<float>::max(), uint32_t layerMask = LAYER_ALL);
+
+    /**
+     * Finds all the objects whose world bounds are hit by a ray.
+     *
+     * @param ray The ray to test against. The direction should be normalized.
+     * @param hits A vector that the hits are appended to, nearest first.
+     * @param maxDistance The distance along the ray beyond which objects are ignored.
+     * @param layerMask The layers to search, objects on none of them are skipped.
+     * @return The number of hits found.
+     */
+    size_t raycastAll(const Ray& ray, std::vector<SpatialIndex::Hit>& hits, float maxDistance = std::numeric_limits<float>::max(),
+                      uint32_t layerMask = LAYER_ALL);
+
+    /**
+     * Finds the objects that have some tags and are on some layers.
+     *
+     * The masks are scanned linearly without reading the objects, so
+     * this costs about the same as comparing a single name per object.
+     *
+     * @param tagMask The tags that an object must all have, 0 for any object.
+     * @param objects A vector that the objects found are appended to.
+     * @param layerMask The layers to search, objects on none of them are skipped.
+     * @return The number of objects found.
+     */
+    size_t findTaggedObjects(uint64_t tagMask, std::vector<SceneObject*>& objects, uint32_t layerMask = LAYER_ALL) const;
+
+private:
+
+    static const size_t INDEX_NONE = (size_t)-1;
+
+    struct NameHash
+    {
+        size_t operator()(const std::string* name) const;
+    };
+
+    struct NameEqual
+    {
+        bool operator()(const std::string* a, const std::string* b) const;
+    };
+
+    Scene(const Scene& copy);
+    static std::shared_ptr<Scene> create();
+    static void recycle(Scene* scene);
+    void reset();
+    void reserve(size_t count);
+    size_t allocate(SceneObject* object, size_t parent);
+    void release(size_t index);
+    void copy(size_t index, const Scene& scene, size_t sceneIndex);
+    void setParent(size_t index, size_t parent);
+    SceneObject* getParent(size_t index) const;
+    const Vector3& getLocalPosition(size_t index) const;
+    void setLocalPosition(size_t index, const Vector3& position);
+    const Quaternion& getLocalRotation(size_t index) const;
+    void setLocalRotation(size_t index, const Quaternion& rotation);
+    const Vector3& getLocalEulerAngles(size_t index);
+    void setLocalEulerAngles(size_t index, const Vector3& eulerAngles);
+    const Vector3& getLocalScale(size_t index) const;
+    void setLocalScale(size_t index, const Vector3& scale);
+    void setLocalTransform(size_t index, const Vector3* position, const Quaternion* rotation, const Vector3* scale);
+    uint32_t getLayerMask(size_t index) const;
+    void setLayerMask(size_t index, uint32_t layerMask);
+    uint64_t getTagMask(size_t index) const;
+    void setTagMask(size_t index, uint64_t tagMask);
+    const AffineTransform& getLocalTransform(size_t index);
+    const AffineTransform& getWorldTransform(size_t index);
+    const AffineTransform& getWorldToLocalTransform(size_t index);
+    const BoundingBox& getLocalBounds(size_t index);
+    const BoundingBox& getWorldBounds(size_t index);
+    const BoundingBox& getHierarchyBounds(size_t index);
+    bool isBaked(size_t index) const;
+    void setChanged(size_t index, int changedBits);
+    void setEnabledChanged(size_t index);
+    void setDirty(size_t index, int dirtyBits);
+    void setBoundsDirty(size_t index);
+    void setHierarchyBoundsDirty(size_t index);
+    void unbake(size_t index);
+    void unbakeSubtree(size_t index);
+    void setSpatialDirty(size_t index);
+    SpatialIndex* getSpatialIndex(size_t index) const;
+    void updateSpatialIndex();
+    void populateSpatialIndex(SpatialIndex* spatialIndex, bool baked);
+    void insertComponent(Component* component);
+    void eraseComponent(Component* component);
+    void insertName(size_t index);
+    void eraseName(size_t index);
+    size_t countNamedObjects(const std::string& name, bool exactMatch, const std::string** key);
+    void findSubtreeObjects(size_t index, const std::string& name, bool exactMatch, bool first, std::vector<SceneObject*>& objects);
+    size_t getSubtreeSize(size_t index) const;
+    void sortNames();
+    size_t getDepth(size_t index, size_t ancestor) const;
+    static const std::string* internName(const std::string& name);
+    static const std::string* retainName(const std::string* name);
+    static void releaseName(const std::string* name);
+    void updateWorldTransforms(size_t begin, size_t end);
+    size_t getLevel(size_t index) const;
+    void appendToLevels(size_t index, size_t parent);
+    void relocate(size_t index);
+    void sort();
+
+    std::vector<SceneObject*> _objects;
+    std::vector<size_t> _parents;
+    std::vector<Vector3> _positions;
+    std::vector<Quaternion> _rotations;
+    std::vector<Vector3> _eulerAngles;
+    std::vector<Vector3> _scales;
+    std::vector<uint32_t> _layerMasks;
+    std::vector<uint64_t> _tagMasks;
+    std::vector<AffineTransform> _localTransforms;
+    std::vector<AffineTransform> _worldTransforms;
+    std::vector<AffineTransform> _worldToLocalTransforms;
+    std::vector<BoundingBox> _localBounds;
+    std::vector<BoundingBox> _worldBounds;
+    std::vector<BoundingBox> _hierarchyBounds;
+    std::vector<int> _dirtyBits;
+    std::vector<size_t> _nameSlots;
+    std::vector<size_t> _proxies;
+    std::vector<size_t> _levels;
+    std::vector<size_t> _childStarts;
+    std::vector<size_t> _journal;
+    std::vector<Scene::ChangeEntry> _changes;
+    std::vector<Scene::Listener*> _listeners;
+    std::vector<size_t> _stack;
+    std::vector<SceneObject*> _traversal;
+    std::vector<size_t> _boundsOrder;
+    std::unordered_map<const std::string*, std::vector<SceneObject*>, Scene::NameHash, Scene::NameEqual> _nameIndex;
+    std::vector<const std::string*> _sortedNames;
+    std::vector<SceneObject*> _matches;
+    std::vector<std::pair<size_t, SceneObject*>> _candidates;
+    std::vector<std::vector<Component*>> _componentPools;
+    std::shared_ptr<SpatialIndex> _spatialIndex;
+    std::shared_ptr<SpatialIndex> _staticSpatialIndex;
+    std::vector<SceneObjectHandle> _spatialUpdates;
+    size_t _objectCount;
+    size_t _bakedCount;
+    size_t _unsortedCount;
+    bool _sorted;
+    bool _ordered;
+    bool _namesSorted;
+    std::shared_ptr<ThreadPool> _threadPool;
+};
+
+}
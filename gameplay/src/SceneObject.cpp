@@ -2,48 +2,124 @@
 #include "SceneObject.h"
 #include "Camera.h"
 #include "Light.h"
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
 
-#define SCENEOBJECT_DIRTY_MATRIX_LOCAL 1
-#define SCENEOBJECT_DIRTY_MATRIX_WORLD 2
-#define SCENEOBJECT_DIRTY_ALL (SCENEOBJECT_DIRTY_MATRIX_LOCAL | SCENEOBJECT_DIRTY_MATRIX_WORLD)
 #define SCENEOBJECT_NAME ""
 #define SCENEOBJECT_STATIC true
 #define SCENEOBJECT_ENABLED true
+#define SCENEOBJECT_LAYER_MASK Scene::LAYER_DEFAULT
+#define SCENEOBJECT_TAG_MASK "0"
 #define SCENEOBJECT_POSITION Vector3::zero()
 #define SCENEOBJECT_EULER_ANGLES Vector3::zero()
 #define SCENEOBJECT_SCALE Vector3::one()
+#define SCENEOBJECT_FIND_WALK_RATIO 2
 
 namespace gameplay
 {
 
+static thread_local std::vector<std::shared_ptr<SceneObject>>* __releasedChildren = nullptr;
+static thread_local SceneObject* __loadingParent = nullptr;
+
 SceneObject::SceneObject() :
-	_name(SCENEOBJECT_NAME),
+	_name(Scene::internName(SCENEOBJECT_NAME)),
     _loaded(false),
 	_enabled(SCENEOBJECT_ENABLED),
 	_static(SCENEOBJECT_STATIC),
-	_position(SCENEOBJECT_POSITION),
-    _rotation(Quaternion::identity()),
-    _eulerAngles(SCENEOBJECT_EULER_ANGLES),
-	_scale(SCENEOBJECT_SCALE),
-	_localMatrix(Matrix::identity()),
-	_worldMatrix(Matrix::identity()),
-	_worldToLocalMatrix(Matrix::identity()),
-	_dirtyBits(SCENEOBJECT_DIRTY_ALL)
+    _scene(nullptr),
+    _index(Scene::INDEX_NONE),
+    _transformVersion(0),
+    _componentMask(0)
+{
+    _handle = SceneObjectHandle::allocate(this);
+
+    // A child being loaded is built straight into the scene of its parent.
+    // The other objects get a scene when it is first used, which is usually
+    // when they are added to a parent, so they are only stored once.
+    SceneObject* parent = __loadingParent;
+    __loadingParent = nullptr;
+    if (parent)
+    {
+        _scene = parent->_scene;
+        _index = _scene->allocate(this, parent->_index);
+    }
+}
+
+SceneObject::SceneObject(const SceneObject& prefab, const std::shared_ptr<Scene>& scene, size_t parent) :
+	_name(Scene::retainName(prefab._name)),
+    _loaded(false),
+	_enabled(prefab._enabled),
+	_static(prefab._static),
+    _scene(scene),
+    _index(Scene::INDEX_NONE),
+    _transformVersion(0),
+    _componentMask(0)
 {
+    _handle = SceneObjectHandle::allocate(this);
+    _index = _scene->allocate(this, parent);
+    if (prefab._scene)
+        _scene->copy(_index, *prefab._scene, prefab._index);
+    _children.reserve(prefab._children.size());
+    _components.reserve(prefab._components.size());
 }
 
 SceneObject::~SceneObject()
 {
+    SceneObjectHandle::release(_handle);
+
+    // Any children that outlive this object become roots in the scene.
+    // An object without a scene has no children.
+    if (_scene)
+    {
+        for (const auto& child : _children)
+        {
+            _scene->setParent(child->_index, Scene::INDEX_NONE);
+        }
+        _scene->release(_index);
+    }
+    Scene::releaseName(_name);
+
+    // The children are released by the outermost destructor in a loop
+    // rather than from here, so destroying a deep hierarchy doesn't recurse.
+    if (__releasedChildren)
+    {
+        for (auto& child : _children)
+        {
+            __releasedChildren->push_back(std::move(child));
+        }
+        return;
+    }
+    std::vector<std::shared_ptr<SceneObject>> releasedChildren;
+    releasedChildren.swap(_children);
+    __releasedChildren = &releasedChildren;
+    while (!releasedChildren.empty())
+    {
+        std::shared_ptr<SceneObject> child = std::move(releasedChildren.back());
+        releasedChildren.pop_back();
+    }
+    __releasedChildren = nullptr;
 }
 
 std::string SceneObject::getName() const
 {
-	return _name;
+	return *_name;
 }
 
 void SceneObject::setName(const std::string& name)
 {
-	_name = name;
+    const std::string* interned = Scene::internName(name);
+    if (interned == _name)
+    {
+        Scene::releaseName(interned);
+        return;
+    }
+    if (_scene)
+        _scene->eraseName(_index);
+    Scene::releaseName(_name);
+	_name = interned;
+    if (_scene)
+        _scene->insertName(_index);
 }
 
 void SceneObject::resetLocalTransform()
@@ -51,7 +127,6 @@ void SceneObject::resetLocalTransform()
     setLocalPosition(SCENEOBJECT_POSITION);
     setLocalEulerAngles(SCENEOBJECT_EULER_ANGLES);
     setLocalScale(SCENEOBJECT_SCALE);
-    _dirtyBits |= SCENEOBJECT_DIRTY_MATRIX_LOCAL;
 }
 
 bool SceneObject::isStatic() const
@@ -62,6 +137,15 @@ bool SceneObject::isStatic() const
 void SceneObject::setStatic(bool isStatic)
 {
 	_static = isStatic;
+
+    // A moveable object can't stay baked and neither can its descendants.
+    if (!isStatic && isBaked())
+        _scene->unbakeSubtree(_index);
+}
+
+bool SceneObject::isBaked() const
+{
+    return _scene && _scene->isBaked(_index);
 }
 
 bool SceneObject::isEnabled() const
@@ -74,73 +158,113 @@ void SceneObject::setEnabled(bool enabled)
 	if (_enabled != enabled) 
 	{
         _enabled = enabled;
+        if (_scene)
+            _scene->setEnabledChanged(_index);
+    }
+}
+
+uint32_t SceneObject::getLayerMask() const
+{
+    return getSceneStore()->getLayerMask(_index);
+}
+
+void SceneObject::setLayerMask(uint32_t layerMask)
+{
+    getSceneStore()->setLayerMask(_index, layerMask);
+}
+
+uint64_t SceneObject::getTagMask() const
+{
+    return getSceneStore()->getTagMask(_index);
+}
+
+void SceneObject::setTagMask(uint64_t tagMask)
+{
+    getSceneStore()->setTagMask(_index, tagMask);
+}
+
+SceneObjectHandle SceneObject::getHandle() const
+{
+    return _handle;
+}
+
+std::shared_ptr<Scene> SceneObject::getScene() const
+{
+    getSceneStore();
+    return _scene;
+}
+
+Scene* SceneObject::getSceneStore() const
+{
+    // An object that was never used has no data to keep, it gets a
+    // scene of its own the first time one is needed.
+    if (!_scene)
+    {
+        _scene = Scene::create();
+        _index = _scene->allocate(const_cast<SceneObject*>(this), Scene::INDEX_NONE);
     }
+    return _scene.get();
 }
 
 const Vector3& SceneObject::getLocalScale() const
 {
-	return _scale;
+	return getSceneStore()->getLocalScale(_index);
 }
 
 void SceneObject::setLocalScale(const Vector3& scale)
 {
-	_scale = scale;
-	_dirtyBits |= SCENEOBJECT_DIRTY_MATRIX_LOCAL;
+	getSceneStore()->setLocalScale(_index, scale);
 }
 
 const Vector3& SceneObject::getLocalPosition() const
 {
-	return _position;
+	return getSceneStore()->getLocalPosition(_index);
 }
 
 void SceneObject::setLocalPosition(const Vector3& position)
 {
-	_position = position;
-	_dirtyBits |= SCENEOBJECT_DIRTY_MATRIX_LOCAL;
+	getSceneStore()->setLocalPosition(_index, position);
 }
 
 const Vector3& SceneObject::getLocalEulerAngles() const
 {
-	return _eulerAngles;
+	return getSceneStore()->getLocalEulerAngles(_index);
 }
 
 void SceneObject::setLocalEulerAngles(const Vector3& eulerAngles)
 {
-    _eulerAngles = eulerAngles;
-	_rotation.set(eulerAngles);
-	_dirtyBits |= SCENEOBJECT_DIRTY_MATRIX_LOCAL;
+	getSceneStore()->setLocalEulerAngles(_index, eulerAngles);
 }
 
 const Quaternion& SceneObject::getLocalRotation() const
 {
-	return _rotation;
+	return getSceneStore()->getLocalRotation(_index);
 }
 
 void SceneObject::setLocalRotation(const Quaternion& rotation)
 {
-	_rotation = rotation;
-    _rotation.toEulerAngles(&_eulerAngles);
-	_dirtyBits |= SCENEOBJECT_DIRTY_MATRIX_LOCAL;
+	getSceneStore()->setLocalRotation(_index, rotation);
 }
 
 Vector3 SceneObject::getPosition()
 {
-	return getWorldMatrix().getTranslation();
+	return getWorldTransform().getTranslation();
 }
 
 void SceneObject::setPosition(const Vector3& position)
 {
-	if (_parent.lock() == nullptr)
+	SceneObject* parent = _scene ? _scene->getParent(_index) : nullptr;
+	if (parent == nullptr)
 	{
-		_position = position;
+		setLocalPosition(position);
 	}
 	else
 	{
-		_worldMatrix = getWorldMatrix();
-		_worldMatrix.invert(&_worldToLocalMatrix);
-		_worldToLocalMatrix.transformPoint(position, &_position);
+		// The local position is relative to the parent.
+		Vector3 localPosition;
+		parent->getWorldToLocalTransform().transformPoint(position, &localPosition);
+		setLocalPosition(localPosition);
 	}
-	_dirtyBits |= SCENEOBJECT_DIRTY_MATRIX_LOCAL;
 }
 
 Vector3 SceneObject::getEulerAngles()
@@ -151,13 +275,15 @@ Vector3 SceneObject::getEulerAngles()
 void SceneObject::setEulerAngles(const Vector3& eulerAngles)
 {
     setLocalEulerAngles(eulerAngles);
-	if (_parent.lock() != nullptr)
+	SceneObject* parent = _scene ? _scene->getParent(_index) : nullptr;
+	if (parent != nullptr)
 	{
 		Quaternion inversParentRotation;
-		_parent.lock()->getRotation().inverse(&inversParentRotation);
-		Quaternion::multiply(_rotation, inversParentRotation, &_rotation);
+		parent->getRotation().inverse(&inversParentRotation);
+		Quaternion rotation;
+		Quaternion::multiply(getLocalRotation(), inversParentRotation, &rotation);
+		setLocalRotation(rotation);
 	}
-	_dirtyBits |= SCENEOBJECT_DIRTY_MATRIX_LOCAL;
 }
 
 Quaternion SceneObject::getRotation()
@@ -169,25 +295,28 @@ Quaternion SceneObject::getRotation()
 
 void SceneObject::setRotation(const Quaternion& rotation)
 {
-	if (_parent.lock() == nullptr)
+	SceneObject* parent = _scene ? _scene->getParent(_index) : nullptr;
+	if (parent == nullptr)
 	{
         setLocalRotation(rotation);
 	}
 	else
 	{
-		Quaternion inversParentRotation = _parent.lock()->getRotation();
+		Quaternion inversParentRotation = parent->getRotation();
 		inversParentRotation.inverse();
-		Quaternion::multiply(inversParentRotation, rotation, &_rotation);
+		Quaternion localRotation;
+		Quaternion::multiply(inversParentRotation, rotation, &localRotation);
+		setLocalRotation(localRotation);
 	}
-	_dirtyBits |= SCENEOBJECT_DIRTY_MATRIX_LOCAL;
 }
 
 void SceneObject::translateLocal(const Vector3& translation)
 {
 	Vector3 tx = translation;
-	_rotation.transformVector(tx, &tx);
-	_position.add(tx);
-	_dirtyBits |= SCENEOBJECT_DIRTY_MATRIX_LOCAL;
+	Quaternion rotation = getLocalRotation();
+	rotation.transformVector(tx, &tx);
+	tx.add(getLocalPosition());
+	setLocalPosition(tx);
 }
 
 void SceneObject::translate(const Vector3& translation)
@@ -195,7 +324,6 @@ void SceneObject::translate(const Vector3& translation)
 	Vector3 tx = translation;
 	tx.add(getPosition());
 	setPosition(tx);
-	_dirtyBits |= SCENEOBJECT_DIRTY_MATRIX_LOCAL;
 }
 
 void SceneObject::rotateLocal(const Vector3& eulerAngles)
@@ -204,31 +332,31 @@ void SceneObject::rotateLocal(const Vector3& eulerAngles)
 	rotation.set(eulerAngles);
 
     // TODO: fix me
-	Vector3 testRot;
-	rotation.toEulerAngles(&testRot);
-	_rotation.multiply(rotation);
-	
-	Vector3 test;
-	_rotation.toEulerAngles(&test);
-	_dirtyBits |= SCENEOBJECT_DIRTY_MATRIX_LOCAL;
+	Quaternion localRotation = getLocalRotation();
+	localRotation.multiply(rotation);
+	setLocalRotation(localRotation);
 }
 
 void SceneObject::rotate(const Vector3& eulerAngles)
 {
-	if (_parent.lock() == nullptr)
+	SceneObject* parent = _scene ? _scene->getParent(_index) : nullptr;
+	if (parent == nullptr)
 	{
 		Quaternion rotation;
 		rotation.set(eulerAngles);
-		_rotation.multiply(rotation);
+		Quaternion localRotation = getLocalRotation();
+		localRotation.multiply(rotation);
+		setLocalRotation(localRotation);
 	}
 	else
 	{
 		Quaternion rotation = getRotation();
-		Quaternion inverseParentRotation = _parent.lock()->getRotation();
+		Quaternion inverseParentRotation = parent->getRotation();
 		inverseParentRotation.inverse();
-		Quaternion::multiply(inverseParentRotation, rotation, &_rotation);
+		Quaternion localRotation;
+		Quaternion::multiply(inverseParentRotation, rotation, &localRotation);
+		setLocalRotation(localRotation);
 	}
-	_dirtyBits |= SCENEOBJECT_DIRTY_MATRIX_LOCAL;
 }
 
 void SceneObject::lookAt(const Vector3& target, Vector3 worldUp)
@@ -242,81 +370,168 @@ void SceneObject::lookAt(const Vector3& target, Vector3 worldUp)
 
 Vector3 SceneObject::getRight()
 {
-	Vector3 right = getWorldMatrix().getX();
+	Vector3 right = getWorldTransform().getX();
 	return right.normalize();
 }
 
 Vector3 SceneObject::getUp()
 {
-	Vector3 up = getWorldMatrix().getY();
+	Vector3 up = getWorldTransform().getY();
 	return up.normalize();
 }
 
 Vector3 SceneObject::getForward()
 {
-	Vector3 forward = getWorldMatrix().getZ();
+	Vector3 forward = getWorldTransform().getZ();
 	return forward.normalize();
 }
 
-const Matrix& SceneObject::getLocalMatrix()
+const AffineTransform& SceneObject::getLocalTransform()
 {
-	if (_dirtyBits & SCENEOBJECT_DIRTY_MATRIX_LOCAL)
-	{
-		_localMatrix.set(_position, _rotation, _scale);
-		_dirtyBits &= ~SCENEOBJECT_DIRTY_MATRIX_LOCAL;
-	}
-	return _localMatrix;
+	return getSceneStore()->getLocalTransform(_index);
+}
+
+const AffineTransform& SceneObject::getWorldTransform()
+{
+	return getSceneStore()->getWorldTransform(_index);
 }
 
 const Matrix& SceneObject::getWorldMatrix()
 {
-	if (_dirtyBits & (SCENEOBJECT_DIRTY_MATRIX_WORLD | SCENEOBJECT_DIRTY_MATRIX_LOCAL))
-	{
-		_dirtyBits &= ~SCENEOBJECT_DIRTY_MATRIX_WORLD;
-		if (_parent.lock())
-		{
-			Matrix::multiply(_parent.lock()->getWorldMatrix(), getLocalMatrix(), &_worldMatrix);
-		}
-		else
-		{
-			_worldMatrix = getLocalMatrix();
-		}
-        for (auto child : _children)
-		{
-            child->getWorldMatrix();
-		}
-	}
-	return _worldMatrix;
+    const AffineTransform& transform = getWorldTransform();
+    MatrixCache* matrices = getMatrixCache();
+    if (matrices->worldVersion != _transformVersion)
+    {
+        matrices->worldMatrix = transform.getMatrix();
+        matrices->worldVersion = _transformVersion;
+    }
+    return matrices->worldMatrix;
+}
+
+uint32_t SceneObject::getTransformVersion() const
+{
+    return _transformVersion;
+}
+
+const AffineTransform& SceneObject::getWorldToLocalTransform()
+{
+    return getSceneStore()->getWorldToLocalTransform(_index);
 }
 
 const Matrix& SceneObject::getWorldToLocalMatrix()
 {
-    return _worldToLocalMatrix;
+    const AffineTransform& transform = getWorldToLocalTransform();
+    MatrixCache* matrices = getMatrixCache();
+    if (matrices->worldToLocalVersion != _transformVersion)
+    {
+        matrices->worldToLocalMatrix = transform.getMatrix();
+        matrices->worldToLocalVersion = _transformVersion;
+    }
+    return matrices->worldToLocalMatrix;
+}
+
+SceneObject::MatrixCache* SceneObject::getMatrixCache()
+{
+    // The matrices are only kept by the objects they are asked for, the
+    // others are read through their affine transforms. The versions start
+    // out behind the transform so the first call builds the matrices.
+    if (!_matrices)
+    {
+        _matrices.reset(new MatrixCache());
+        _matrices->worldVersion = _transformVersion - 1;
+        _matrices->worldToLocalVersion = _transformVersion - 1;
+    }
+    return _matrices.get();
+}
+
+const BoundingBox& SceneObject::getLocalBoundingBox()
+{
+    return getSceneStore()->getLocalBounds(_index);
+}
+
+BoundingSphere SceneObject::getLocalBoundingSphere()
+{
+    BoundingSphere sphere;
+    const BoundingBox& box = getLocalBoundingBox();
+    if (!box.isEmpty())
+        sphere.set(box);
+    return sphere;
+}
+
+const BoundingBox& SceneObject::getWorldBoundingBox()
+{
+    return getSceneStore()->getWorldBounds(_index);
+}
+
+BoundingSphere SceneObject::getWorldBoundingSphere()
+{
+    // The local sphere is transformed rather than enclosing the world box, which is looser.
+    BoundingSphere sphere = getLocalBoundingSphere();
+    if (!sphere.isEmpty())
+        sphere.transform(getWorldTransform());
+    return sphere;
+}
+
+const BoundingBox& SceneObject::getHierarchyBoundingBox()
+{
+    return getSceneStore()->getHierarchyBounds(_index);
+}
+
+BoundingSphere SceneObject::getHierarchyBoundingSphere()
+{
+    BoundingSphere sphere;
+    const BoundingBox& box = getHierarchyBoundingBox();
+    if (!box.isEmpty())
+        sphere.set(box);
+    return sphere;
 }
 
 void SceneObject::transformPoint(const Vector3& point, Vector3* dst)
 {
 	GP_ASSERT(dst);
-	getWorldMatrix().transformPoint(point, dst);
+	getWorldTransform().transformPoint(point, dst);
 }
 
 void SceneObject::transformVector(const Vector3& vector, Vector3* dst)
 {	
 	GP_ASSERT(dst);
-	getWorldMatrix().transformVector(vector, dst);
+	getWorldTransform().transformVector(vector, dst);
+}
+
+void SceneObject::inverseTransformPoint(const Vector3& point, Vector3* dst)
+{
+	GP_ASSERT(dst);
+	getWorldToLocalTransform().transformPoint(point, dst);
+}
+
+void SceneObject::inverseTransformVector(const Vector3& vector, Vector3* dst)
+{
+	GP_ASSERT(dst);
+	getWorldToLocalTransform().transformVector(vector, dst);
+}
+
+std::shared_ptr<SceneObject> SceneObject::clone()
+{
+    std::vector<std::shared_ptr<SceneObject>> objects;
+    std::make_shared<Scene>()->instantiate(shared_from_this(), 1, objects);
+    return objects.front();
 }
 
 void SceneObject::addChild(std::shared_ptr<SceneObject> object)
 {
-	if (object->_parent.lock() == shared_from_this())
+    SceneObject* parent = object->_scene ? object->_scene->getParent(object->_index) : nullptr;
+	if (parent == this)
 		return;
-	if (object->_parent.lock())
-		removeChild(object);
+	if (parent)
+    {
+        auto itr = std::find(parent->_children.begin(), parent->_children.end(), object);
+        if (itr != parent->_children.end())
+            parent->_children.erase(itr);
+    }
 
+    getSceneStore();
     _children.push_back(object);
-
-	object->_parent = shared_from_this();
-	object->_dirtyBits |= SCENEOBJECT_DIRTY_MATRIX_LOCAL;
+    object->moveToScene(_scene, _index);
 }
 
 void SceneObject::removeChild(std::shared_ptr<SceneObject> object)
@@ -324,18 +539,18 @@ void SceneObject::removeChild(std::shared_ptr<SceneObject> object)
      auto itr = std::find(_children.begin(), _children.end(), object);
      if (itr != _children.end())
      {
-         (*itr)->_parent.reset();
          _children.erase(itr);
+         object->moveToScene(Scene::create(), Scene::INDEX_NONE);
      }
 }
 
 void SceneObject::removeChildren()
 {
-	for (auto itr = _children.begin(); itr != _children.end();)
-	{
-		(*itr)->_parent.reset();
-        _children.erase(itr);
-	}
+    for (const auto& child : _children)
+    {
+        child->moveToScene(Scene::create(), Scene::INDEX_NONE);
+    }
+    _children.clear();
 }
 
 size_t SceneObject::getChildCount() const
@@ -343,117 +558,320 @@ size_t SceneObject::getChildCount() const
 	return _children.size();
 }
 
-std::vector<std::shared_ptr<SceneObject>> SceneObject::getChildren()
+SceneObject* SceneObject::getChild(size_t index) const
 {
-    std::vector<std::shared_ptr<SceneObject>> children;
-    for (auto child : _children)
-    {
-        if (child)
-        {
-            children.push_back(child);
-        }
-	}
-	return children;
+    GP_ASSERT(index < _children.size());
+    return _children[index].get();
 }
 
-std::shared_ptr<SceneObject> SceneObject::getParent() const
+const std::vector<std::shared_ptr<SceneObject>>& SceneObject::getChildren() const
 {
-	return _parent.lock();
+    return _children;
 }
 
-std::shared_ptr<SceneObject> SceneObject::findObject(const std::string& name, bool recursive, bool exactMatch) 
+bool SceneObject::visitDepthFirst(SceneObject::VisitCallback callback, uint64_t componentMask, uint32_t layerMask, uint64_t tagMask)
 {
-    for (auto child : _children)
+    // The stack is shared with nested traversals, each one
+    // only uses the entries above where it started.
+    getSceneStore();
+    std::shared_ptr<Scene> scene = _scene;
+    std::vector<SceneObject*>& stack = scene->_traversal;
+    size_t base = stack.size();
+    stack.push_back(this);
+    while (stack.size() > base)
     {
-        if ((exactMatch && child->_name == name) || (!exactMatch && child->_name.find(name) == 0))
+        SceneObject* object = stack.back();
+        stack.pop_back();
+        Visit visit = VISIT_CONTINUE;
+        size_t index = object->_index;
+        if ((object->_componentMask & componentMask) == componentMask &&
+            (scene->_layerMasks[index] & layerMask) && (scene->_tagMasks[index] & tagMask) == tagMask)
+            visit = callback(object);
+        if (visit == VISIT_STOP)
+        {
+            stack.resize(base);
+            return false;
+        }
+        if (visit == VISIT_SKIP_CHILDREN)
+            continue;
+
+        // Pushed in reverse so the first child is visited first.
+        for (size_t i = object->_children.size(); i > 0; --i)
         {
-            return child;
+            stack.push_back(object->_children[i - 1].get());
         }
     }
-    if (recursive)
+    return true;
+}
+
+bool SceneObject::visitBreadthFirst(SceneObject::VisitCallback callback, uint64_t componentMask, uint32_t layerMask, uint64_t tagMask)
+{
+    // The visited objects stay in the queue until the traversal ends
+    // so nested traversals can share it the same way as the stack.
+    getSceneStore();
+    std::shared_ptr<Scene> scene = _scene;
+    std::vector<SceneObject*>& queue = scene->_traversal;
+    size_t base = queue.size();
+    queue.push_back(this);
+    for (size_t i = base; i < queue.size(); ++i)
     {
-        for (auto child : _children)
+        SceneObject* object = queue[i];
+        Visit visit = VISIT_CONTINUE;
+        size_t index = object->_index;
+        if ((object->_componentMask & componentMask) == componentMask &&
+            (scene->_layerMasks[index] & layerMask) && (scene->_tagMasks[index] & tagMask) == tagMask)
+            visit = callback(object);
+        if (visit == VISIT_STOP)
         {
-            std::shared_ptr<SceneObject> match = child->findObject(name, true, exactMatch);
-            if (match)
-            {
-                return match;
-            }
+            queue.resize(base);
+            return false;
+        }
+        if (visit == VISIT_SKIP_CHILDREN)
+            continue;
+        for (const auto& child : object->_children)
+        {
+            queue.push_back(child.get());
         }
     }
-    return nullptr;
+    queue.resize(base);
+    return true;
+}
+
+std::shared_ptr<SceneObject> SceneObject::getParent() const
+{
+    SceneObject* parent = _scene ? _scene->getParent(_index) : nullptr;
+    return parent ? parent->shared_from_this() : nullptr;
+}
+
+SceneObjectHandle SceneObject::getParentHandle() const
+{
+    SceneObject* parent = _scene ? _scene->getParent(_index) : nullptr;
+    return parent ? parent->_handle : SceneObjectHandle();
+}
+
+std::shared_ptr<SceneObject> SceneObject::findObject(const std::string& name, bool recursive, bool exactMatch) 
+{
+    if (!_scene)
+        return nullptr;
+    std::vector<SceneObject*>& matches = _scene->_matches;
+    matches.clear();
+    findObjects(name, matches, recursive, exactMatch, true);
+    return matches.empty() ? nullptr : matches.front()->shared_from_this();
 }
 
 size_t SceneObject::findObjects(const std::string& name, std::vector<std::shared_ptr<SceneObject>>& objects, bool recursive, bool exactMatch)
 {
-    size_t count = 0;
-    
-    for (auto child : _children)
+    if (!_scene)
+        return 0;
+    std::vector<SceneObject*>& matches = _scene->_matches;
+    matches.clear();
+    findObjects(name, matches, recursive, exactMatch, false);
+    for (SceneObject* match : matches)
+    {
+        objects.push_back(match->shared_from_this());
+    }
+    return matches.size();
+}
+
+bool SceneObject::precedes(const SceneObject* object) const
+{
+    // The two objects are on the same level, so their ancestors meet at a common
+    // ancestor whose children are visited in order by a breadth first search.
+    const SceneObject* a = this;
+    const SceneObject* b = object;
+    SceneObject* parentA = _scene->getParent(a->_index);
+    SceneObject* parentB = _scene->getParent(b->_index);
+    while (parentA != parentB)
+    {
+        a = parentA;
+        b = parentB;
+        parentA = _scene->getParent(a->_index);
+        parentB = _scene->getParent(b->_index);
+    }
+    GP_ASSERT(parentA);
+    for (const auto& child : parentA->_children)
+    {
+        if (child.get() == a)
+            return true;
+        if (child.get() == b)
+            return false;
+    }
+    return false;
+}
+
+static size_t getNamedSearchCost(size_t count)
+{
+    // Each named object is placed in the hierarchy and ordered with the others,
+    // about log2(count) steps each, where a walk takes one step per object.
+    size_t steps = 1;
+    for (size_t n = count; n > 1; n >>= 1)
     {
-        if ((exactMatch && child->_name == name) || (!exactMatch && child->_name.find(name) == 0))
+        ++steps;
+    }
+    return count * steps;
+}
+
+static bool matchesName(const std::string* objectName, const std::string* key, const std::string& name, bool exactMatch)
+{
+    // The objects with the exact name hold the same interned name as the key.
+    return exactMatch ? objectName == key : objectName->compare(0, name.size(), name) == 0;
+}
+
+void SceneObject::findObjects(const std::string& name, std::vector<SceneObject*>& objects, bool recursive, bool exactMatch, bool first)
+{
+    const std::string* key = nullptr;
+    size_t count = _scene->countNamedObjects(name, exactMatch, &key);
+    if (count == 0)
+        return;
+    if (!recursive)
+    {
+        for (const auto& child : _children)
         {
-            objects.push_back(child);
-            ++count;
+            if (matchesName(child->_name, key, name, exactMatch))
+            {
+                objects.push_back(child.get());
+                if (first)
+                    return;
+            }
         }
+        return;
     }
-    if (recursive)
+
+    // The hierarchy is searched breadth first, the first match is then the nearest one,
+    // unless visiting only the named objects and keeping the ones in the hierarchy is
+    // clearly cheaper. When the size of the hierarchy is known that is decided up front,
+    // otherwise the walk gives up once it has cost that much.
+    size_t cost = getNamedSearchCost(count) * SCENEOBJECT_FIND_WALK_RATIO;
+    size_t size = _scene->getSubtreeSize(_index);
+    if (size != Scene::INDEX_NONE && size > cost)
+    {
+        _scene->findSubtreeObjects(_index, name, exactMatch, first, objects);
+        return;
+    }
+    size_t budget = size != Scene::INDEX_NONE ? size : cost;
+    std::vector<SceneObject*>& queue = _scene->_traversal;
+    size_t base = queue.size();
+    size_t found = objects.size();
+    queue.push_back(this);
+    size_t i = base;
+    for (; i < queue.size() && queue.size() - base <= budget; ++i)
     {
-        for (auto child : _children)
+        for (const auto& child : queue[i]->_children)
         {
-            count += child->findObjects(name, objects, recursive, exactMatch);
+            if (matchesName(child->_name, key, name, exactMatch))
+            {
+                objects.push_back(child.get());
+                if (first)
+                {
+                    queue.resize(base);
+                    return;
+                }
+            }
+            queue.push_back(child.get());
         }
     }
-    return count;
+    bool complete = i == queue.size();
+    queue.resize(base);
+    if (complete)
+        return;
+    objects.resize(found);
+    _scene->findSubtreeObjects(_index, name, exactMatch, first, objects);
 }
 
+static size_t countBits(uint64_t bits)
+{
+#if defined(_MSC_VER)
+    return (size_t)__popcnt64(bits);
+#else
+    return (size_t)__builtin_popcountll(bits);
+#endif
+}
 
 void SceneObject::attachComponent(std::shared_ptr<Component> component)
 {
-    std::shared_ptr<Component> existing = getComponent(component->getTypeId());
-    if (!existing)
+    GP_ASSERT(component);
+
+    // The components are kept sorted by type so the position
+    // of a type is the number of lower types attached.
+    Component::TypeId typeId = component->getTypeId();
+    GP_ASSERT((size_t)typeId < Component::TYPEID_MAX);
+    uint64_t bit = (uint64_t)1 << typeId;
+    if (_componentMask & bit)
+        return;
+    _components.insert(_components.begin() + countBits(_componentMask & (bit - 1)), component);
+    _componentMask |= bit;
+    if (_scene)
     {
-        _components.push_back(component);
+        _scene->insertComponent(component.get());
+        _scene->setBoundsDirty(_index);
     }
+    component->setObject(shared_from_this());
 }
 
 void SceneObject::detachComponent(std::shared_ptr<Component> component)
 {
-    auto itr = std::find(_components.begin(), _components.end(), component);
-    if (itr != _components.end())
+    GP_ASSERT(component);
+
+    Component::TypeId typeId = component->getTypeId();
+    uint64_t bit = (uint64_t)1 << typeId;
+    if (!(_componentMask & bit))
+        return;
+    auto itr = _components.begin() + countBits(_componentMask & (bit - 1));
+    if (*itr != component)
+        return;
+    if (_scene)
     {
-        _components.erase(itr);
+        _scene->eraseComponent(component.get());
+        _scene->setBoundsDirty(_index);
     }
+    _components.erase(itr);
+    _componentMask &= ~bit;
+    component->setObject(nullptr);
+}
+
+Component* SceneObject::findComponent(Component::TypeId typeId) const
+{
+    uint64_t bit = (uint64_t)1 << typeId;
+    if (!(_componentMask & bit))
+        return nullptr;
+    return _components[countBits(_componentMask & (bit - 1))].get();
+}
+
+void SceneObject::setBoundsDirty()
+{
+    if (_scene)
+        _scene->setBoundsDirty(_index);
 }
 
 std::shared_ptr<Component> SceneObject::getComponent(Component::TypeId typeId)
 {
-    for (auto component : _components)
-    {
-        if (component->getTypeId() == typeId)
-        {
-            return component;
-        }
-    }
-    return nullptr;
+    uint64_t bit = (uint64_t)1 << typeId;
+    if (!(_componentMask & bit))
+        return nullptr;
+    return _components[countBits(_componentMask & (bit - 1))];
+}
+
+bool SceneObject::hasComponent(Component::TypeId typeId) const
+{
+    return (_componentMask & ((uint64_t)1 << typeId)) != 0;
+}
+
+uint64_t SceneObject::getComponentMask() const
+{
+    return _componentMask;
 }
 
 void SceneObject::getComponents(Component::TypeId typeId, std::vector<std::shared_ptr<Component>>& components)
 {
-    for (auto component : _components)
-    {
-        if (component->getTypeId() == typeId)
-        {
-            components.push_back(component);
-        }
-    }
+    // Only one component of each type can be attached.
+    std::shared_ptr<Component> component = getComponent(typeId);
+    if (component)
+        components.push_back(component);
 }
 
 void SceneObject::getComponents(std::vector<std::shared_ptr<Component>>& components)
 {
-    for (auto component : _components)
-    {
-        components.push_back(component);
-    }
+    components.insert(components.end(), _components.begin(), _components.end());
 }
 
 void SceneObject::load()
@@ -476,9 +894,12 @@ std::string SceneObject::getClassName()
 
 void SceneObject::onSerialize(Serializer* serializer)
 {
-    serializer->writeString("name", _name.c_str(), SCENEOBJECT_NAME);
+    serializer->writeString("name", _name->c_str(), SCENEOBJECT_NAME);
     serializer->writeBool("enabled", isEnabled(), SCENEOBJECT_ENABLED);
     serializer->writeBool("static", isStatic(), SCENEOBJECT_STATIC);
+    serializer->writeInt("layerMask", (int)getLayerMask(), (int)SCENEOBJECT_LAYER_MASK);
+    // The serializers have no 64 bit integers, so the tags are written in decimal.
+    serializer->writeString("tagMask", std::to_string(getTagMask()).c_str(), SCENEOBJECT_TAG_MASK);
     serializer->writeVector("position", getLocalPosition(), SCENEOBJECT_POSITION);
     serializer->writeVector("eulerAngles", getLocalEulerAngles(), SCENEOBJECT_EULER_ANGLES);
     serializer->writeVector("scale", getLocalScale(), SCENEOBJECT_SCALE);
@@ -502,35 +923,124 @@ void SceneObject::onSerialize(Serializer* serializer)
 
 void SceneObject::onDeserialize(Serializer* serializer)
 {
-    serializer->readString("name", _name, SCENEOBJECT_NAME);
+    std::string name;
+    serializer->readString("name", name, SCENEOBJECT_NAME);
     _enabled = serializer->readBool("enabled", SCENEOBJECT_STATIC);
     _static = serializer->readBool("static", SCENEOBJECT_STATIC);
-    _position = serializer->readVector("position", SCENEOBJECT_POSITION);
-    _eulerAngles = serializer->readVector("eulerAngles", SCENEOBJECT_EULER_ANGLES);
-    _scale = serializer->readVector("scale", SCENEOBJECT_SCALE);
+    setLayerMask((uint32_t)serializer->readInt("layerMask", (int)SCENEOBJECT_LAYER_MASK));
+    std::string tagMask;
+    serializer->readString("tagMask", tagMask, SCENEOBJECT_TAG_MASK);
+    setTagMask(std::strtoull(tagMask.c_str(), nullptr, 10));
+    setLocalPosition(serializer->readVector("position", SCENEOBJECT_POSITION));
+    setLocalEulerAngles(serializer->readVector("eulerAngles", SCENEOBJECT_EULER_ANGLES));
+    setLocalScale(serializer->readVector("scale", SCENEOBJECT_SCALE));
     size_t childCount = serializer->readObjectList("children");
     if (childCount > 0)
     {
-        _children.resize(childCount);
-        for (size_t i = 0; i < _children.size(); i++)
+        // Each child is constructed into this scene by the reader. A child read by
+        // reference already exists elsewhere, the parent is left unused and it is moved.
+        _children.reserve(childCount);
+        getSceneStore();
+        if (!_scene->getParent(_index))
+            _scene->reserve(_scene->_objects.size() + childCount);
+        for (size_t i = 0; i < childCount; i++)
         {
-            _children[i] = std::static_pointer_cast<SceneObject>(serializer->readObject(nullptr));
+            __loadingParent = this;
+            std::shared_ptr<SceneObject> child = std::static_pointer_cast<SceneObject>(serializer->readObject(nullptr));
+            if (__loadingParent)
+            {
+                __loadingParent = nullptr;
+                if (child)
+                    addChild(child);
+            }
+            else if (child)
+            {
+                _children.push_back(child);
+            }
         }
     }
+
+    // The name is set once the children are read, so the default name stays in use
+    // by the objects being loaded and isn't interned and indexed again for each one.
+    setName(name);
+
     size_t componentCount =  serializer->readObjectList("components");
     if (componentCount > 0)
     {
-        _components.resize(componentCount);
-        for (size_t i = 0; i < _components.size(); i++)
+        _components.reserve(componentCount);
+        for (size_t i = 0; i < componentCount; i++)
         {
-            _components[i] = std::static_pointer_cast<Component>(serializer->readObject(nullptr));
+            attachComponent(std::static_pointer_cast<Component>(serializer->readObject(nullptr)));
         }
     }
 }
 
 std::shared_ptr<Serializable> SceneObject::createObject()
 {
-    return std::static_pointer_cast<Serializable>(std::make_shared<SceneObject>());
+    return std::static_pointer_cast<Serializable>(Serializer::getActivator()->createShared<SceneObject>());
+}
+
+std::shared_ptr<SceneObject> SceneObject::createClone(const SceneObject& prefab, const std::shared_ptr<Scene>& scene, size_t parent, const std::shared_ptr<Arena>& arena)
+{
+    // The object is constructed in the arena and its control block is allocated there as well.
+    void* memory = arena->allocate(sizeof(SceneObject), alignof(SceneObject));
+    std::shared_ptr<SceneObject> object(new (memory) SceneObject(prefab, scene, parent), [](SceneObject* object)
+    {
+        object->~SceneObject();
+    }, ArenaAllocator<SceneObject>(arena));
+    for (const auto& component : prefab._components)
+    {
+        std::shared_ptr<Component> clone = component->clone();
+        if (clone)
+            object->attachComponent(clone);
+    }
+    return object;
+}
+
+void SceneObject::moveToScene(const std::shared_ptr<Scene>& scene, size_t parent)
+{
+    if (scene == _scene)
+    {
+        _scene->setParent(_index, parent);
+        return;
+    }
+
+    // Each object is moved before its children are pushed so that their
+    // parent index in the new scene is known, without recursing.
+    moveObjectToScene(scene, parent);
+    std::vector<SceneObject*>& stack = scene->_traversal;
+    size_t base = stack.size();
+    stack.push_back(this);
+    while (stack.size() > base)
+    {
+        SceneObject* object = stack.back();
+        stack.pop_back();
+        for (const auto& child : object->_children)
+        {
+            child->moveObjectToScene(scene, object->_index);
+            stack.push_back(child.get());
+        }
+    }
+}
+
+void SceneObject::moveObjectToScene(const std::shared_ptr<Scene>& scene, size_t parent)
+{
+    // An object without a scene has nothing to copy.
+    if (!_scene)
+    {
+        _scene = scene;
+        _index = scene->allocate(this, parent);
+        return;
+    }
+
+    // Release first so the components leave the old pools before
+    // joining the new ones. The released data stays until the next sort.
+    _scene->release(_index);
+    size_t index = scene->allocate(this, parent);
+    scene->copy(index, *_scene, _index);
+    _scene = scene;
+    _index = index;
+    ++_transformVersion;
 }
 
 void SceneObject::onInitialize()
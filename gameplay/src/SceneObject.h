@@ -1,11 +1,14 @@
 #pragma once
 
 #include "Serializable.h"
+#include "Scene.h"
 #include "Vector3.h"
 #include "Quaternion.h"
 #include "Matrix.h"
+#include "AffineTransform.h"
 #include "BoundingSphere.h"
 #include "Component.h"
+#include "SceneObjectHandle.h"
 
 class Camera;
 class Light;
@@ -25,6 +28,8 @@ namespace gameplay
 class SceneObject : public std::enable_shared_from_this<SceneObject>, public Serializable
 {
     friend class Game;
+    friend class Scene;
+    friend class Component;
     friend class Serializer::Activator;
 
 public:
@@ -38,6 +43,21 @@ public:
      */
 	~SceneObject();
 
+    /**
+     * Defines what a traversal does after visiting an object.
+     */
+    enum Visit
+    {
+        VISIT_CONTINUE,
+        VISIT_SKIP_CHILDREN,
+        VISIT_STOP
+    };
+
+    /**
+     * Defines the callback called for each object visited by a traversal.
+     */
+    typedef std::function<SceneObject::Visit(SceneObject* object)> VisitCallback;
+
 	/**
 	 * Gets the name of this object.
 	 *
@@ -62,12 +82,25 @@ public:
 	/**
 	 * Sets the object to be static (not moveable).
 	 *
-	 * Used by editor only.
+	 * Used by editor only. Objects are static by default, including the
+	 * ones loaded from scenes without a "static" value, and a loaded scene
+	 * bakes them, see Scene::bake. Objects that move should be set to not
+	 * static, since moving a baked object unbakes it and sorts the scene.
 	 *
 	 * @param isStatic true if the object is static, false if not.
 	 */
 	void setStatic(bool isStatic);
 
+	/**
+	 * Determines if the transform of the object is baked.
+	 *
+	 * Baked objects are skipped by the per frame transform update.
+	 *
+	 * @return true if the object is baked, false if not.
+	 * @see Scene::bake
+	 */
+	bool isBaked() const;
+
     /**
      * Determines the local enabled state.
 	 *
@@ -88,6 +121,63 @@ public:
      */
 	void setEnabled(bool enabled);
 
+    /**
+     * Gets the layers this object is on.
+     *
+     * @return The layers as a bit mask, Scene::LAYER_DEFAULT unless set.
+     */
+    uint32_t getLayerMask() const;
+
+    /**
+     * Sets the layers this object is on.
+     *
+     * The object is only found by the queries and traversals whose layer
+     * mask shares a bit with it, such as the culling mask of a camera.
+     * An object is usually on a single layer, the bit of its category.
+     *
+     * @param layerMask The layers as a bit mask.
+     */
+    void setLayerMask(uint32_t layerMask);
+
+    /**
+     * Gets the tags of this object.
+     *
+     * @return The tags as a bit mask, 0 unless set.
+     */
+    uint64_t getTagMask() const;
+
+    /**
+     * Sets the tags of this object.
+     *
+     * The meaning of each bit is up to the game. The traversals and
+     * Scene::findTaggedObjects only find the objects that have all the
+     * tags of their tag mask.
+     *
+     * @param tagMask The tags as a bit mask.
+     */
+    void setTagMask(uint64_t tagMask);
+
+    /**
+     * Gets the handle of this object.
+     *
+     * The handle is a weak reference that can be stored instead of a
+     * shared pointer and resolved without any reference counting.
+     *
+     * @return The handle of this object.
+     */
+    SceneObjectHandle getHandle() const;
+
+    /**
+     * Gets the scene this object belongs to.
+     *
+     * All the objects in a hierarchy share the scene of the hierarchy root.
+     * An object that was never added to a hierarchy gets a scene of its own
+     * the first time it is used.
+     *
+     * @return The scene this object belongs to.
+     */
+    std::shared_ptr<Scene> getScene() const;
+
     /**
      * Resets the local position, eulerAngles/rotation and scale.
      */
@@ -248,20 +338,104 @@ public:
 	 */
     Vector3 getForward();
 
+	/**
+	 * Gets the affine transform that transforms a point from local space into world space.
+	 *
+	 * @return The affine transform that transforms a point from local space into world space.
+	 */
+	const AffineTransform& getWorldTransform();
+
 	/**
 	 * Gets the matrix that transforms a point from local space into world space.
 	 *
+	 * The matrix is built from the world transform the first time it is asked
+	 * for after the transform changed and it is kept by the object.
+	 *
 	 * @return The matrix that transforms a point from local space into world space.
 	 */
 	const Matrix& getWorldMatrix();
 
+    /**
+     * Gets the version of the world transform of this object.
+     *
+     * The version changes whenever the world transform changes, through this
+     * object or one of its ancestors. A cache derived from the transform can
+     * keep the version and compare it instead of the transform.
+     *
+     * @return The version of the world transform.
+     * @see Scene::getChanges
+     */
+    uint32_t getTransformVersion() const;
+
+	/**
+	 * Gets the affine transform that transforms a point from world space into local space.
+	 *
+	 * @return The affine transform that transforms a point from world space into local space.
+	 */
+	const AffineTransform& getWorldToLocalTransform();
+
 	/**
 	 * Gets the matrix that transforms a point from world space into local space.
 	 *
+	 * The matrix is built from the world to local transform the first time it is
+	 * asked for after the transform changed and it is kept by the object.
+	 *
 	 * @return The matrix that transforms a point from world space into local space.
 	 */
 	const Matrix& getWorldToLocalMatrix();
 
+	/**
+	 * Gets the bounds of the object in local space.
+	 *
+	 * The bounds are the union of the bounds of the attached components,
+	 * see Component::getBounds. An object without bounds has an empty box.
+	 *
+	 * @return The bounds of the object in local space.
+	 */
+	const BoundingBox& getLocalBoundingBox();
+
+	/**
+	 * Gets the sphere enclosing the bounds of the object in local space.
+	 *
+	 * @return The sphere enclosing the bounds of the object in local space.
+	 */
+	BoundingSphere getLocalBoundingSphere();
+
+	/**
+	 * Gets the bounds of the object in world space.
+	 *
+	 * This is the axis aligned box enclosing the transformed local bounds.
+	 * It is recomputed when it is used after the object moved.
+	 *
+	 * @return The bounds of the object in world space.
+	 */
+	const BoundingBox& getWorldBoundingBox();
+
+	/**
+	 * Gets the sphere enclosing the bounds of the object in world space.
+	 *
+	 * @return The sphere enclosing the bounds of the object in world space.
+	 */
+	BoundingSphere getWorldBoundingSphere();
+
+	/**
+	 * Gets the bounds of the object and all its descendants in world space.
+	 *
+	 * When a subtree is outside of a frustum or missed by a ray, none of
+	 * its objects need to be tested. The bounds are only recomputed for the
+	 * parts of the subtree that changed since they were last used.
+	 *
+	 * @return The bounds of the object and all its descendants in world space.
+	 */
+	const BoundingBox& getHierarchyBoundingBox();
+
+	/**
+	 * Gets the sphere enclosing the bounds of the object and all its descendants in world space.
+	 *
+	 * @return The sphere enclosing the bounds of the object and all its descendants in world space.
+	 */
+	BoundingSphere getHierarchyBoundingSphere();
+
 	/**
 	 * Transforms a point in local space to world space.
 	 * 
@@ -278,6 +452,32 @@ public:
 	 */
     void transformVector(const Vector3& v, Vector3* dst);
 
+	/**
+	 * Transforms a point in world space to local space.
+	 * 
+	 * @param p The point to be transformed.
+	 * @param dst The transform point.
+	 */
+	void inverseTransformPoint(const Vector3& p, Vector3* dst);
+
+	/**
+	 * Transforms a vector in world space to local space.
+	 * 
+	 * @param v The vector to be transformed.
+	 * @param dst The transform point.
+	 */
+	void inverseTransformVector(const Vector3& v, Vector3* dst);
+
+    /**
+     * Creates a copy of this object and its descendants.
+     *
+     * The copy is the root of a new scene and has no parent.
+     *
+     * @return The copy of this object.
+     * @see Scene::instantiate to create many copies at once.
+     */
+    std::shared_ptr<SceneObject> clone();
+
     /**
      * Adds an object as a child of this object.
      *
@@ -304,14 +504,59 @@ public:
      */
     size_t getChildCount() const;
 
+    /**
+     * Gets a child of this object.
+     *
+     * @param index The index of the child, less than getChildCount.
+     * @return The child object.
+     */
+    SceneObject* getChild(size_t index) const;
+
     /**
      * Gets the children object.
      *
-     * The children are a copy.
+     * The children are not copied, the array changes when
+     * children are added or removed.
      *
      * @return The children objects.
      */
-    std::vector<std::shared_ptr<SceneObject>> getChildren();
+    const std::vector<std::shared_ptr<SceneObject>>& getChildren() const;
+
+    /**
+     * Visits this object and its descendants depth first.
+     *
+     * Each object is visited before its children and the children are
+     * visited in order. The traversal uses a stack owned by the scene,
+     * so it does not allocate once the stack has grown and does not
+     * recurse. The hierarchy must not change during the traversal.
+     *
+     * @param callback The callback called for each object visited.
+     * @param componentMask The component types, as bits of Component::TypeId, that an
+     *        object must have to be passed to the callback. The children of the objects
+     *        that are filtered out are still visited.
+     * @param layerMask The layers that an object must be on one of to be passed to the callback.
+     * @param tagMask The tags that an object must all have to be passed to the callback.
+     * @return false if the callback stopped the traversal, true otherwise.
+     */
+    bool visitDepthFirst(SceneObject::VisitCallback callback, uint64_t componentMask = 0, uint32_t layerMask = Scene::LAYER_ALL, uint64_t tagMask = 0);
+
+    /**
+     * Visits this object and its descendants breadth first.
+     *
+     * All the objects of a level are visited before the level below.
+     * The traversal uses a queue owned by the scene, so it does not
+     * allocate once the queue has grown and does not recurse.
+     * The hierarchy must not change during the traversal.
+     *
+     * @param callback The callback called for each object visited.
+     * @param componentMask The component types, as bits of Component::TypeId, that an
+     *        object must have to be passed to the callback. The children of the objects
+     *        that are filtered out are still visited.
+     * @param layerMask The layers that an object must be on one of to be passed to the callback.
+     * @param tagMask The tags that an object must all have to be passed to the callback.
+     * @return false if the callback stopped the traversal, true otherwise.
+     */
+    bool visitBreadthFirst(SceneObject::VisitCallback callback, uint64_t componentMask = 0, uint32_t layerMask = Scene::LAYER_ALL, uint64_t tagMask = 0);
 
     /**
      * Gets the parent of this object.
@@ -320,12 +565,26 @@ public:
      */
     std::shared_ptr<SceneObject> getParent() const;
 
+    /**
+     * Gets the handle of the parent of this object.
+     *
+     * @return The handle of the parent or the null handle if this object is a root.
+     */
+    SceneObjectHandle getParentHandle() const;
+
     /**
      * Finds the first child object that matches the given name.
      *
      * This method checks the specified name against its immediate children
      * but does not check the name against itself.
-     * If recursive is true, it also traverses the objects's hierarchy with a breadth first search.
+     * If recursive is true, it also searches the objects's hierarchy and the
+     * match with the fewest levels below this object is returned. Between
+     * matches on the same level, the first one in breadth first order of the
+     * children is returned.
+     *
+     * The hierarchy is walked unless it is much larger than the number of
+     * objects in the scene with a matching name, which are then looked up in
+     * the scene's name index instead.
      *
      * @param name The name of the child object to find.
      * @param recursive true to search recursively all the object's children, false for only direct children.
@@ -338,6 +597,8 @@ public:
     /**
      * Finds all child object that match the given name.
      *
+     * The matches are returned level by level, the nearest ones first.
+     *
      * @param name The name of the object to find.
      * @param objects A vector of objects to be populated with matches.
      * @param recursive true if a recursive search should be performed, false otherwise.
@@ -368,6 +629,35 @@ public:
      */
     std::shared_ptr<Component> getComponent(Component::TypeId typeId);
 
+    /**
+     * Gets a componenent from the object for the class type.
+     *
+     * The lookup is constant time and the component is borrowed, it stays
+     * valid while it is attached to this object. The class must declare a
+     * static TYPEID member, see Component::registerTypeId.
+     *
+     * @return The component or nullptr if none of the type is attached.
+     */
+    template <class T>
+    T* getComponent();
+
+    /**
+     * Determines if a component of the class type is attached to the object.
+     *
+     * @param typeId The type of component.
+     * @return true if a component of the type is attached, false if not.
+     */
+    bool hasComponent(Component::TypeId typeId) const;
+
+    /**
+     * Gets the types of the components attached to the object.
+     *
+     * Bit n is set when a component with the Component::TypeId n is attached.
+     *
+     * @return The types of the components attached to the object.
+     */
+    uint64_t getComponentMask() const;
+
     /**
      * Gets a componenent from the object for the class type.
      *
@@ -421,27 +711,49 @@ protected:
 
 private:
 
-	const Matrix& getLocalMatrix();
+    struct MatrixCache
+    {
+        Matrix worldMatrix;
+        Matrix worldToLocalMatrix;
+        uint32_t worldVersion;
+        uint32_t worldToLocalVersion;
+    };
+
+	SceneObject(const SceneObject& copy);
+	SceneObject(const SceneObject& prefab, const std::shared_ptr<Scene>& scene, size_t parent);
+	static std::shared_ptr<SceneObject> createClone(const SceneObject& prefab, const std::shared_ptr<Scene>& scene, size_t parent, const std::shared_ptr<Arena>& arena);
+	Scene* getSceneStore() const;
+	const AffineTransform& getLocalTransform();
+	SceneObject::MatrixCache* getMatrixCache();
+	void moveToScene(const std::shared_ptr<Scene>& scene, size_t parent);
+	void moveObjectToScene(const std::shared_ptr<Scene>& scene, size_t parent);
+	void findObjects(const std::string& name, std::vector<SceneObject*>& objects, bool recursive, bool exactMatch, bool first);
+	bool precedes(const SceneObject* object) const;
+	Component* findComponent(Component::TypeId typeId) const;
+	void setBoundsDirty();
 	void onInitialize();
 	void onFinalize();
 	void onUpdate(float elapsedTime);
 	void onRender(float elapsedTime);
 
-	std::string _name;
+	const std::string* _name;
     bool _loaded;
 	bool _enabled;
 	bool _static;
-	Vector3 _position;
-    Quaternion _rotation;
-	Vector3 _eulerAngles;
-	Vector3 _scale;
-	Matrix _localMatrix;
-	Matrix _worldMatrix;
-	Matrix _worldToLocalMatrix;
-    int _dirtyBits;
-	std::weak_ptr<SceneObject> _parent;
+    mutable std::shared_ptr<Scene> _scene;
+    mutable size_t _index;
+    uint32_t _transformVersion;
+    std::unique_ptr<SceneObject::MatrixCache> _matrices;
+    SceneObjectHandle _handle;
     std::vector<std::shared_ptr<SceneObject>> _children;
     std::vector<std::shared_ptr<Component>> _components;
+    uint64_t _componentMask;
 };
 
+template <class T>
+T* SceneObject::getComponent()
+{
+    return static_cast<T*>(findComponent(T::TYPEID));
+}
+
 }
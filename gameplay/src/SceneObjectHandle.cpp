@@ -0,0 +1,202 @@
+#include "Base.h"
+#include "SceneObjectHandle.h"
+#include "SceneObject.h"
+
+#define SCENEOBJECTHANDLE_CHUNK_SHIFT 12
+#define SCENEOBJECTHANDLE_CHUNK_SIZE (1 << SCENEOBJECTHANDLE_CHUNK_SHIFT)
+#define SCENEOBJECTHANDLE_CHUNK_MAX 16384
+
+namespace gameplay
+{
+
+struct SceneObjectSlot
+{
+    std::atomic<SceneObject*> object;
+    std::atomic<uint32_t> generation;
+    std::atomic<uint32_t> next;
+};
+
+struct SceneObjectChunks
+{
+    ~SceneObjectChunks();
+    std::vector<std::unique_ptr<SceneObjectSlot[]>> chunks;
+};
+
+// The slots are allocated in chunks that don't move until exit, so handles are
+// resolved without a lock while other threads allocate slots. The released slots
+// are kept in a lock-free list whose head packs the first slot, plus one so 0 is
+// the empty list, with a tag that changes on every update. A popped slot is never
+// freed, so reading the next slot of a head that was taken meanwhile is safe and
+// the tag makes the exchange fail. Only a new chunk takes the lock.
+// Generation 0 is never given to a slot so the null handle never resolves.
+static std::atomic<SceneObjectSlot*> __chunks[SCENEOBJECTHANDLE_CHUNK_MAX];
+static std::atomic<uint32_t> __slotCount(0);
+static std::atomic<uint64_t> __freeSlots(0);
+static std::mutex __chunksMutex;
+static bool __chunksDestroyed = false;
+
+SceneObjectChunks::~SceneObjectChunks()
+{
+    // The objects destroyed after this at exit find no chunk and have nothing to release.
+    for (size_t i = 0; i < chunks.size(); ++i)
+    {
+        __chunks[i].store(nullptr);
+    }
+    __chunksDestroyed = true;
+}
+
+static SceneObjectChunks& getChunks()
+{
+    // Created on first use so the objects created during static initialization have it.
+    static SceneObjectChunks chunks;
+    return chunks;
+}
+
+static SceneObjectSlot* getSlot(uint32_t index)
+{
+    uint32_t chunk = index >> SCENEOBJECTHANDLE_CHUNK_SHIFT;
+    if (chunk >= SCENEOBJECTHANDLE_CHUNK_MAX)
+        return nullptr;
+    SceneObjectSlot* slots = __chunks[chunk].load();
+    return slots ? &slots[index & (SCENEOBJECTHANDLE_CHUNK_SIZE - 1)] : nullptr;
+}
+
+static uint64_t makeFreeHead(uint64_t head, uint32_t first)
+{
+    return (((head >> 32) + 1) << 32) | first;
+}
+
+SceneObjectHandle::SceneObjectHandle() :
+    _index(0),
+    _generation(0)
+{
+}
+
+SceneObjectHandle::SceneObjectHandle(uint32_t index, uint32_t generation) :
+    _index(index),
+    _generation(generation)
+{
+}
+
+SceneObjectHandle::~SceneObjectHandle()
+{
+}
+
+uint32_t SceneObjectHandle::getIndex() const
+{
+    return _index;
+}
+
+uint32_t SceneObjectHandle::getGeneration() const
+{
+    return _generation;
+}
+
+bool SceneObjectHandle::isNull() const
+{
+    return _generation == 0;
+}
+
+bool SceneObjectHandle::isValid() const
+{
+    return get() != nullptr;
+}
+
+SceneObject* SceneObjectHandle::get() const
+{
+    SceneObjectSlot* slot = getSlot(_index);
+    if (!slot)
+        return nullptr;
+
+    // The generation is checked again after reading the object, so an object
+    // that took the slot meanwhile is not returned for an expired handle.
+    if (slot->generation.load() != _generation)
+        return nullptr;
+    SceneObject* object = slot->object.load();
+    return slot->generation.load() == _generation ? object : nullptr;
+}
+
+std::shared_ptr<SceneObject> SceneObjectHandle::lock() const
+{
+    SceneObject* object = get();
+    return object ? object->shared_from_this() : nullptr;
+}
+
+bool SceneObjectHandle::operator==(const SceneObjectHandle& handle) const
+{
+    return _index == handle._index && _generation == handle._generation;
+}
+
+bool SceneObjectHandle::operator!=(const SceneObjectHandle& handle) const
+{
+    return !(*this == handle);
+}
+
+SceneObjectHandle SceneObjectHandle::allocate(SceneObject* object)
+{
+    GP_ASSERT(object);
+
+    uint64_t head = __freeSlots.load();
+    while ((uint32_t)head != 0)
+    {
+        uint32_t index = (uint32_t)head - 1;
+        SceneObjectSlot* slot = getSlot(index);
+        if (__freeSlots.compare_exchange_weak(head, makeFreeHead(head, slot->next.load())))
+        {
+            slot->object.store(object);
+            return SceneObjectHandle(index, slot->generation.load());
+        }
+    }
+
+    uint32_t index = __slotCount.fetch_add(1);
+    if (index >= (uint32_t)SCENEOBJECTHANDLE_CHUNK_MAX * SCENEOBJECTHANDLE_CHUNK_SIZE)
+    {
+        GP_ERROR("Too many scene objects (max %u).", (uint32_t)SCENEOBJECTHANDLE_CHUNK_MAX * SCENEOBJECTHANDLE_CHUNK_SIZE);
+        return SceneObjectHandle();
+    }
+    SceneObjectSlot* slot = getSlot(index);
+    if (!slot)
+    {
+        std::lock_guard<std::mutex> lock(__chunksMutex);
+        slot = getSlot(index);
+        if (!slot)
+        {
+            // The objects created at exit after the chunks were freed get the null handle.
+            if (__chunksDestroyed)
+                return SceneObjectHandle();
+            SceneObjectChunks& chunks = getChunks();
+            uint32_t chunk = index >> SCENEOBJECTHANDLE_CHUNK_SHIFT;
+            if (chunks.chunks.size() <= chunk)
+                chunks.chunks.resize(chunk + 1);
+            chunks.chunks[chunk].reset(new SceneObjectSlot[SCENEOBJECTHANDLE_CHUNK_SIZE]());
+            __chunks[chunk].store(chunks.chunks[chunk].get());
+            slot = getSlot(index);
+        }
+    }
+    slot->object.store(object);
+    slot->generation.store(1);
+    return SceneObjectHandle(index, 1);
+}
+
+void SceneObjectHandle::release(const SceneObjectHandle& handle)
+{
+    if (handle.isNull())
+        return;
+    SceneObjectSlot* slot = getSlot(handle._index);
+    if (!slot)
+        return;
+    GP_ASSERT(slot->generation.load() == handle._generation);
+
+    // A new generation expires every handle to the object.
+    slot->object.store(nullptr);
+    uint32_t generation = handle._generation + 1;
+    slot->generation.store(generation == 0 ? 1 : generation);
+    uint64_t head = __freeSlots.load();
+    do
+    {
+        slot->next.store((uint32_t)head);
+    }
+    while (!__freeSlots.compare_exchange_weak(head, makeFreeHead(head, handle._index + 1)));
+}
+
+}
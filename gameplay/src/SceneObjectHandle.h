@@ -0,0 +1,115 @@
+#pragma once
+
+namespace gameplay
+{
+
+class SceneObject;
+
+/**
+ * Defines a weak reference to a scene object as an index and a generation.
+ *
+ * Handles are plain values that are resolved through a table of the live
+ * objects. When an object is destroyed its slot gets a new generation, so
+ * any handle to it stops resolving and the slot can be reused without the
+ * old handles finding the new object. Resolving a handle does not touch any
+ * reference count.
+ *
+ * The object table is shared by every scene, so a handle stays valid
+ * while its object moves between scenes. It is stored in chunks that don't
+ * move until exit, so handles are resolved without a lock on any thread,
+ * and the slots are taken and returned without a lock, including while
+ * objects are created on other threads. A handle resolved while its object
+ * is being destroyed on another thread may still return it, so an object
+ * should be destroyed on the threads that use its handles.
+ */
+class SceneObjectHandle
+{
+    friend class SceneObject;
+
+public:
+
+    /**
+     * Constructor.
+     *
+     * The handle is null and does not resolve to any object.
+     */
+    SceneObjectHandle();
+
+    /**
+     * Destructor.
+     */
+    ~SceneObjectHandle();
+
+    /**
+     * Gets the slot of the object in the object table.
+     *
+     * @return The slot of the object in the object table.
+     */
+    uint32_t getIndex() const;
+
+    /**
+     * Gets the generation of the slot when the handle was created.
+     *
+     * @return The generation of the slot when the handle was created.
+     */
+    uint32_t getGeneration() const;
+
+    /**
+     * Determines if this is the null handle.
+     *
+     * A handle that is not null may still have expired.
+     *
+     * @return true if the handle is null, false if not.
+     */
+    bool isNull() const;
+
+    /**
+     * Determines if the object the handle refers to is still alive.
+     *
+     * @return true if the object is alive, false if the handle is null or expired.
+     */
+    bool isValid() const;
+
+    /**
+     * Gets the object the handle refers to.
+     *
+     * The object is borrowed and stays valid as long as it is alive.
+     *
+     * @return The object or nullptr if the handle is null or expired.
+     */
+    SceneObject* get() const;
+
+    /**
+     * Gets a shared pointer to the object the handle refers to.
+     *
+     * @return The object or nullptr if the handle is null or expired.
+     */
+    std::shared_ptr<SceneObject> lock() const;
+
+    /**
+     * Determines if two handles refer to the same object.
+     *
+     * @param handle The handle to compare with.
+     * @return true if the handles are equal, false if not.
+     */
+    bool operator==(const SceneObjectHandle& handle) const;
+
+    /**
+     * Determines if two handles refer to different objects.
+     *
+     * @param handle The handle to compare with.
+     * @return true if the handles are not equal, false if not.
+     */
+    bool operator!=(const SceneObjectHandle& handle) const;
+
+private:
+
+    SceneObjectHandle(uint32_t index, uint32_t generation);
+    static SceneObjectHandle allocate(SceneObject* object);
+    static void release(const SceneObjectHandle& handle);
+
+    uint32_t _index;
+    uint32_t _generation;
+};
+
+}
@@ -7,12 +7,16 @@
 #include "SceneObject.h"
 #include "Camera.h"
 #include "Light.h"
+#include "RendererLod.h"
 
 namespace gameplay
 {
 
 static Serializer::Activator* __activator = nullptr;
 
+// Each thread allocates from its own arena, since arenas are not thread safe.
+static thread_local std::shared_ptr<Arena> __arena;
+
 Serializer::Activator::Activator()
 {
 }
@@ -28,6 +32,7 @@ void Serializer::Activator::initializeTypes()
     registerType("gameplay::SceneObject", SceneObject::createObject);
     registerType("gameplay::Camera", Camera::createObject);
     registerType("gameplay::Light", Light::createObject);
+    registerType("gameplay::RendererLod", RendererLod::createObject);
 }
 
 void Serializer::Activator::initializeEnums()
@@ -37,6 +42,7 @@ void Serializer::Activator::initializeEnums()
     registerEnum("gameplay::Light::Type", Light::enumToString, Light::enumParse);
     registerEnum("gameplay::Light::Mode", Light::enumToString, Light::enumParse);
     registerEnum("gameplay::Light::Shadows", Light::enumToString, Light::enumParse);
+    registerEnum("gameplay::RendererLod::Metric", RendererLod::enumToString, RendererLod::enumParse);
 }
     
 std::shared_ptr<Serializable> Serializer::Activator::createObject(const std::string& className)
@@ -102,6 +108,16 @@ void Serializer::Activator::registerEnum(const std::string& enumName, EnumToStri
     }
 }
 
+void Serializer::Activator::setArena(std::shared_ptr<Arena> arena)
+{
+    __arena = arena;
+}
+
+std::shared_ptr<Arena> Serializer::Activator::getArena() const
+{
+    return __arena;
+}
+
 Serializer::Serializer(Type type, const std::string& path, Stream* stream, unsigned int versionMajor, unsigned int versionMinor) : 
     _type(type),
     _path(path),
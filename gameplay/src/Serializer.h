@@ -1,5 +1,7 @@
 #pragma once
 
+#include "Arena.h"
+
 namespace gameplay
 {
     
@@ -521,6 +523,37 @@ public:
          * @param enumParse The enumParse callback function.
          */
         void registerEnum(const std::string& enumName, EnumToStringCallback enumToString, EnumParseCallback enumParse);
+
+        /**
+         * Sets the arena that new objects are allocated from on the calling thread.
+         *
+         * Set an arena while loading a scene so its objects are allocated in a few
+         * large blocks that are freed together once the last object is released.
+         * The arena is only used by the thread that set it, since arenas are not
+         * thread safe, so the objects created on other threads meanwhile come
+         * from the heap or from the arenas of those threads. Restore the previous
+         * arena once done.
+         *
+         * @param arena The arena to allocate from or nullptr to use the heap.
+         */
+        void setArena(std::shared_ptr<Arena> arena);
+
+        /**
+         * Gets the arena that new objects are allocated from on the calling thread.
+         *
+         * @return The arena or nullptr if objects are allocated on the heap.
+         */
+        std::shared_ptr<Arena> getArena() const;
+
+        /**
+         * Creates a new shared object, from the current arena if one is set.
+         *
+         * Used by the CreateObjectCallback of the registered classes.
+         *
+         * @return The new object instance.
+         */
+        template <class T>
+        std::shared_ptr<T> createShared();
         
     private:
         
@@ -562,4 +595,13 @@ protected:
     
 };
 
+template <class T>
+std::shared_ptr<T> Serializer::Activator::createShared()
+{
+    std::shared_ptr<Arena> arena = getArena();
+    if (arena)
+        return std::allocate_shared<T>(ArenaAllocator<T>(arena));
+    return std::make_shared<T>();
+}
+
 }
@@ -0,0 +1,567 @@
+#include "Base.h"
+#include "SpatialHashGrid.h"
+
+#define SPATIAL_HASH_GRID_CELL_SIZE_DEFAULT 4.0f
+#define SPATIAL_HASH_GRID_KEY_BITS 21
+#define SPATIAL_HASH_GRID_KEY_MASK ((1 << SPATIAL_HASH_GRID_KEY_BITS) - 1)
+#define SPATIAL_HASH_GRID_COORDINATE_MAX ((1 << (SPATIAL_HASH_GRID_KEY_BITS - 1)) - 1)
+#define SPATIAL_HASH_GRID_CELL_NONE ((size_t)-1)
+
+namespace gameplay
+{
+
+SpatialHashGrid::SpatialHashGrid() :
+    _maxHalfSize(Vector3::zero()),
+    _maxHalfSizeDirty(false),
+    _cellSize(SPATIAL_HASH_GRID_CELL_SIZE_DEFAULT),
+    _inverseCellSize(1.0f / SPATIAL_HASH_GRID_CELL_SIZE_DEFAULT),
+    _objectCount(0)
+{
+    resetCoordinates();
+}
+
+SpatialHashGrid::SpatialHashGrid(float cellSize) :
+    _maxHalfSize(Vector3::zero()),
+    _maxHalfSizeDirty(false),
+    _cellSize(cellSize),
+    _inverseCellSize(1.0f / cellSize),
+    _objectCount(0)
+{
+    GP_ASSERT(cellSize > 0.0f);
+    resetCoordinates();
+}
+
+SpatialHashGrid::~SpatialHashGrid()
+{
+}
+
+float SpatialHashGrid::getCellSize() const
+{
+    return _cellSize;
+}
+
+void SpatialHashGrid::setCellSize(float cellSize)
+{
+    GP_ASSERT(cellSize > 0.0f);
+
+    _cellSize = cellSize;
+    _inverseCellSize = 1.0f / cellSize;
+    _cellIndex.clear();
+    _cells.clear();
+    _freeCells.clear();
+    _largeEntries.clear();
+    _maxHalfSize.set(Vector3::zero());
+    _maxHalfSizeDirty = false;
+    resetCoordinates();
+    for (size_t i = 0; i < _entries.size(); ++i)
+    {
+        if (!_entries[i].object)
+            continue;
+        _entries[i].key = getKey(_entries[i].box);
+        insertIntoCell(i);
+    }
+}
+
+size_t SpatialHashGrid::getCellCount() const
+{
+    return _cellIndex.size();
+}
+
+size_t SpatialHashGrid::insert(SceneObject* object, const BoundingBox& box, uint32_t layerMask)
+{
+    GP_ASSERT(object);
+
+    size_t proxy;
+    if (_freeEntries.empty())
+    {
+        proxy = _entries.size();
+        _entries.emplace_back();
+    }
+    else
+    {
+        proxy = _freeEntries.back();
+        _freeEntries.pop_back();
+    }
+    Entry& entry = _entries[proxy];
+    entry.box = box;
+    entry.object = object;
+    entry.layerMask = layerMask;
+    entry.key = getKey(box);
+    insertIntoCell(proxy);
+    ++_objectCount;
+    return proxy;
+}
+
+bool SpatialHashGrid::update(size_t proxy, const BoundingBox& box)
+{
+    GP_ASSERT(proxy < _entries.size() && _entries[proxy].object);
+
+    // An object that stays in its cell or in the large list only needs its box.
+    Entry& entry = _entries[proxy];
+    uint64_t key = getKey(box);
+    bool large = isLarge(box);
+    shrinkMaxHalfSize(entry, large ? Vector3::zero() : getHalfSize(box));
+    if (large == (entry.cell == SPATIAL_HASH_GRID_CELL_NONE) && (large || key == entry.key))
+    {
+        entry.box = box;
+        if (!large)
+            growMaxHalfSize(box);
+        return false;
+    }
+    removeFromCell(proxy);
+    entry.box = box;
+    entry.key = key;
+    insertIntoCell(proxy);
+    return true;
+}
+
+void SpatialHashGrid::remove(size_t proxy)
+{
+    GP_ASSERT(proxy < _entries.size() && _entries[proxy].object);
+
+    shrinkMaxHalfSize(_entries[proxy], Vector3::zero());
+    removeFromCell(proxy);
+    _entries[proxy].object = nullptr;
+    _freeEntries.push_back(proxy);
+    --_objectCount;
+}
+
+void SpatialHashGrid::setLayerMask(size_t proxy, uint32_t layerMask)
+{
+    GP_ASSERT(proxy < _entries.size() && _entries[proxy].object);
+    _entries[proxy].layerMask = layerMask;
+}
+
+void SpatialHashGrid::clear()
+{
+    _entries.clear();
+    _freeEntries.clear();
+    _cellIndex.clear();
+    _cells.clear();
+    _freeCells.clear();
+    _largeEntries.clear();
+    _maxHalfSize.set(Vector3::zero());
+    _maxHalfSizeDirty = false;
+    _objectCount = 0;
+    resetCoordinates();
+}
+
+SceneObject* SpatialHashGrid::getObject(size_t proxy) const
+{
+    GP_ASSERT(proxy < _entries.size());
+    return _entries[proxy].object;
+}
+
+const BoundingBox& SpatialHashGrid::getBounds(size_t proxy) const
+{
+    GP_ASSERT(proxy < _entries.size());
+    return _entries[proxy].box;
+}
+
+size_t SpatialHashGrid::getObjectCount() const
+{
+    return _objectCount;
+}
+
+size_t SpatialHashGrid::query(const BoundingBox& box, std::vector<SceneObject*>& objects, uint32_t layerMask)
+{
+    size_t count = objects.size();
+    gatherCandidates(box);
+    for (size_t proxy : _candidates)
+    {
+        const Entry& entry = _entries[proxy];
+        if ((entry.layerMask & layerMask) && entry.box.intersects(box))
+            objects.push_back(entry.object);
+    }
+    return objects.size() - count;
+}
+
+size_t SpatialHashGrid::query(const BoundingSphere& sphere, std::vector<SceneObject*>& objects, uint32_t layerMask)
+{
+    size_t count = objects.size();
+    Vector3 radius(sphere.radius, sphere.radius, sphere.radius);
+    gatherCandidates(BoundingBox(sphere.center - radius, sphere.center + radius));
+    for (size_t proxy : _candidates)
+    {
+        const Entry& entry = _entries[proxy];
+        if ((entry.layerMask & layerMask) && sphere.intersects(entry.box))
+            objects.push_back(entry.object);
+    }
+    return objects.size() - count;
+}
+
+size_t SpatialHashGrid::query(const Frustum& frustum, std::vector<SceneObject*>& objects, uint32_t layerMask)
+{
+    size_t count = objects.size();
+    Vector3 corners[8];
+    frustum.getCorners(corners);
+    BoundingBox region(corners[0], corners[0]);
+    for (size_t i = 1; i < 8; ++i)
+    {
+        region.min.set(std::min(region.min.x, corners[i].x), std::min(region.min.y, corners[i].y), std::min(region.min.z, corners[i].z));
+        region.max.set(std::max(region.max.x, corners[i].x), std::max(region.max.y, corners[i].y), std::max(region.max.z, corners[i].z));
+    }
+    gatherCandidates(region);
+    for (size_t proxy : _candidates)
+    {
+        // The box of the frustum also rejects the objects near its corners
+        // that the plane tests let through.
+        const Entry& entry = _entries[proxy];
+        if ((entry.layerMask & layerMask) && entry.box.intersects(region) && frustum.intersects(entry.box))
+            objects.push_back(entry.object);
+    }
+    return objects.size() - count;
+}
+
+size_t SpatialHashGrid::queryNearest(const Vector3& point, size_t count, float maxDistance, std::vector<SceneObject*>& objects, uint32_t layerMask)
+{
+    _nearest.clear();
+    if (_objectCount == 0 || count == 0)
+        return 0;
+
+    // Every center within radius cells of the point is in the shells visited so far,
+    // so the search stops once the nearest objects found are within that distance.
+    // The shells are clipped to the cells that have held objects and the ones
+    // that miss them entirely are skipped.
+    const float maxDistanceSquared = maxDistance * maxDistance;
+    for (size_t proxy : _largeEntries)
+    {
+        addNearest(proxy, point, maxDistanceSquared, layerMask);
+    }
+    size_t visited = _largeEntries.size();
+    if (_cellIndex.empty())
+        return finishNearest(count, objects);
+    int center[3] = { getCoordinate(point.x), getCoordinate(point.y), getCoordinate(point.z) };
+    int radius = 0;
+    for (size_t i = 0; i < 3; ++i)
+    {
+        radius = std::max(radius, std::max(_minCoordinates[i] - center[i], center[i] - _maxCoordinates[i]));
+    }
+    for (; ; ++radius)
+    {
+        int minX = std::max(-radius, _minCoordinates[0] - center[0]);
+        int minY = std::max(-radius, _minCoordinates[1] - center[1]);
+        int minZ = std::max(-radius, _minCoordinates[2] - center[2]);
+        int maxX = std::min(radius, _maxCoordinates[0] - center[0]);
+        int maxY = std::min(radius, _maxCoordinates[1] - center[1]);
+        int maxZ = std::min(radius, _maxCoordinates[2] - center[2]);
+
+        // Once the shells would cover more cells than the grid holds every object is tested.
+        double volume = ((double)maxX - minX + 1.0) * ((double)maxY - minY + 1.0) * ((double)maxZ - minZ + 1.0);
+        if (volume > (double)_cellIndex.size())
+        {
+            _nearest.clear();
+            for (size_t i = 0; i < _entries.size(); ++i)
+            {
+                if (_entries[i].object)
+                    addNearest(i, point, maxDistanceSquared, layerMask);
+            }
+            break;
+        }
+        for (int dx = minX; dx <= maxX; ++dx)
+        {
+            for (int dy = minY; dy <= maxY; ++dy)
+            {
+                // Inside the shell only the two cells at its ends along z are on it.
+                bool side = dx == -radius || dx == radius || dy == -radius || dy == radius;
+                int step = side ? 1 : 2 * radius;
+                for (int dz = side ? minZ : -radius; dz <= maxZ; dz += step)
+                {
+                    if (dz < minZ)
+                        continue;
+                    auto itr = _cellIndex.find(getKey(center[0] + dx, center[1] + dy, center[2] + dz));
+                    if (itr == _cellIndex.end())
+                        continue;
+                    const std::vector<size_t>& cell = _cells[itr->second];
+                    for (size_t proxy : cell)
+                    {
+                        addNearest(proxy, point, maxDistanceSquared, layerMask);
+                    }
+                    visited += cell.size();
+                }
+            }
+        }
+        float covered = radius * _cellSize;
+        if (visited == _objectCount || covered >= maxDistance)
+            break;
+        if (_nearest.size() >= count)
+        {
+            std::nth_element(_nearest.begin(), _nearest.begin() + (count - 1), _nearest.end());
+            if (_nearest[count - 1].first <= covered * covered)
+                break;
+        }
+    }
+    return finishNearest(count, objects);
+}
+
+bool SpatialHashGrid::raycast(const Ray& ray, float maxDistance, Hit* hit, uint32_t layerMask)
+{
+    GP_ASSERT(hit);
+
+    const Vector3& origin = ray.getOrigin();
+    Vector3 end = origin + ray.getDirection() * maxDistance;
+    gatherCandidates(BoundingBox(Vector3(std::min(origin.x, end.x), std::min(origin.y, end.y), std::min(origin.z, end.z)),
+                                 Vector3(std::max(origin.x, end.x), std::max(origin.y, end.y), std::max(origin.z, end.z))));
+    Vector3 inverseDirection = getInverseDirection(ray);
+    float nearest = maxDistance;
+    SceneObject* object = nullptr;
+    float distance;
+    for (size_t proxy : _candidates)
+    {
+        const Entry& entry = _entries[proxy];
+        if ((entry.layerMask & layerMask) && intersectRay(entry.box, origin, inverseDirection, nearest, &distance))
+        {
+            nearest = distance;
+            object = entry.object;
+        }
+    }
+    if (!object)
+        return false;
+    hit->object = object;
+    hit->distance = nearest;
+    return true;
+}
+
+size_t SpatialHashGrid::raycastAll(const Ray& ray, float maxDistance, std::vector<Hit>& hits, uint32_t layerMask)
+{
+    size_t count = hits.size();
+    const Vector3& origin = ray.getOrigin();
+    Vector3 end = origin + ray.getDirection() * maxDistance;
+    gatherCandidates(BoundingBox(Vector3(std::min(origin.x, end.x), std::min(origin.y, end.y), std::min(origin.z, end.z)),
+                                 Vector3(std::max(origin.x, end.x), std::max(origin.y, end.y), std::max(origin.z, end.z))));
+    Vector3 inverseDirection = getInverseDirection(ray);
+    float distance;
+    for (size_t proxy : _candidates)
+    {
+        const Entry& entry = _entries[proxy];
+        if ((entry.layerMask & layerMask) && intersectRay(entry.box, origin, inverseDirection, maxDistance, &distance))
+        {
+            Hit hit = { entry.object, distance };
+            hits.push_back(hit);
+        }
+    }
+    sortHits(hits, count);
+    return hits.size() - count;
+}
+
+int SpatialHashGrid::getCoordinate(float value) const
+{
+    // Clamped to the coordinates that a key holds without wrapping around, so that
+    // two cells never share a key and far away and infinite values stay in range.
+    // The objects beyond share the cells at the edge, which only costs extra tests.
+    // Clamping only brings cells closer together, so the nearest searches still
+    // find every object by the time they have covered its distance.
+    float coordinate = std::floor(value * _inverseCellSize);
+    coordinate = std::max(std::min(coordinate, (float)SPATIAL_HASH_GRID_COORDINATE_MAX), -(float)SPATIAL_HASH_GRID_COORDINATE_MAX);
+    return (int)coordinate;
+}
+
+uint64_t SpatialHashGrid::getKey(int x, int y, int z)
+{
+    // The coordinates are clamped to the range of the key bits, so each cell has its own key.
+    return (uint64_t)((uint32_t)x & SPATIAL_HASH_GRID_KEY_MASK) |
+           (uint64_t)((uint32_t)y & SPATIAL_HASH_GRID_KEY_MASK) << SPATIAL_HASH_GRID_KEY_BITS |
+           (uint64_t)((uint32_t)z & SPATIAL_HASH_GRID_KEY_MASK) << (SPATIAL_HASH_GRID_KEY_BITS * 2);
+}
+
+void SpatialHashGrid::resetCoordinates()
+{
+    for (size_t i = 0; i < 3; ++i)
+    {
+        _minCoordinates[i] = std::numeric_limits<int>::max();
+        _maxCoordinates[i] = std::numeric_limits<int>::min();
+    }
+}
+
+uint64_t SpatialHashGrid::getKey(const BoundingBox& box) const
+{
+    return getKey(getCoordinate((box.min.x + box.max.x) * 0.5f),
+                  getCoordinate((box.min.y + box.max.y) * 0.5f),
+                  getCoordinate((box.min.z + box.max.z) * 0.5f));
+}
+
+bool SpatialHashGrid::isLarge(const BoundingBox& box) const
+{
+    return box.max.x - box.min.x > 2.0f * _cellSize ||
+           box.max.y - box.min.y > 2.0f * _cellSize ||
+           box.max.z - box.min.z > 2.0f * _cellSize;
+}
+
+void SpatialHashGrid::insertIntoCell(size_t proxy)
+{
+    // Objects whose half size is larger than a cell go to the large list, so they
+    // don't grow the region of every query. The cells emptied are kept for reuse
+    // with their memory.
+    Entry& entry = _entries[proxy];
+    const BoundingBox& box = entry.box;
+    if (isLarge(box))
+    {
+        entry.cell = SPATIAL_HASH_GRID_CELL_NONE;
+        entry.slot = _largeEntries.size();
+        _largeEntries.push_back(proxy);
+        return;
+    }
+    growMaxHalfSize(box);
+    auto itr = _cellIndex.find(entry.key);
+    if (itr == _cellIndex.end())
+    {
+        size_t cell;
+        if (_freeCells.empty())
+        {
+            cell = _cells.size();
+            _cells.emplace_back();
+        }
+        else
+        {
+            cell = _freeCells.back();
+            _freeCells.pop_back();
+        }
+        itr = _cellIndex.insert(std::make_pair(entry.key, cell)).first;
+    }
+    std::vector<size_t>& cell = _cells[itr->second];
+    entry.cell = itr->second;
+    int coordinates[3] = { getCoordinate((box.min.x + box.max.x) * 0.5f),
+                           getCoordinate((box.min.y + box.max.y) * 0.5f),
+                           getCoordinate((box.min.z + box.max.z) * 0.5f) };
+    for (size_t i = 0; i < 3; ++i)
+    {
+        _minCoordinates[i] = std::min(_minCoordinates[i], coordinates[i]);
+        _maxCoordinates[i] = std::max(_maxCoordinates[i], coordinates[i]);
+    }
+    entry.slot = cell.size();
+    cell.push_back(proxy);
+}
+
+void SpatialHashGrid::removeFromCell(size_t proxy)
+{
+    // Swap with the last object of the cell so the removal is constant time.
+    Entry& entry = _entries[proxy];
+    if (entry.cell == SPATIAL_HASH_GRID_CELL_NONE)
+    {
+        size_t last = _largeEntries.back();
+        _largeEntries[entry.slot] = last;
+        _entries[last].slot = entry.slot;
+        _largeEntries.pop_back();
+        return;
+    }
+    std::vector<size_t>& cell = _cells[entry.cell];
+    size_t last = cell.back();
+    cell[entry.slot] = last;
+    _entries[last].slot = entry.slot;
+    cell.pop_back();
+    if (cell.empty())
+    {
+        _cellIndex.erase(entry.key);
+        _freeCells.push_back(entry.cell);
+    }
+}
+
+Vector3 SpatialHashGrid::getHalfSize(const BoundingBox& box)
+{
+    return Vector3((box.max.x - box.min.x) * 0.5f, (box.max.y - box.min.y) * 0.5f, (box.max.z - box.min.z) * 0.5f);
+}
+
+void SpatialHashGrid::growMaxHalfSize(const BoundingBox& box)
+{
+    Vector3 halfSize = getHalfSize(box);
+    _maxHalfSize.set(std::max(_maxHalfSize.x, halfSize.x), std::max(_maxHalfSize.y, halfSize.y), std::max(_maxHalfSize.z, halfSize.z));
+}
+
+void SpatialHashGrid::shrinkMaxHalfSize(const Entry& entry, const Vector3& halfSize)
+{
+    // When an object in the cells that set the largest half size on an axis
+    // shrinks there or leaves the cells, the largest is found again lazily.
+    if (entry.cell == SPATIAL_HASH_GRID_CELL_NONE)
+        return;
+    Vector3 previous = getHalfSize(entry.box);
+    if ((previous.x >= _maxHalfSize.x && halfSize.x < previous.x) ||
+        (previous.y >= _maxHalfSize.y && halfSize.y < previous.y) ||
+        (previous.z >= _maxHalfSize.z && halfSize.z < previous.z))
+    {
+        _maxHalfSizeDirty = true;
+    }
+}
+
+void SpatialHashGrid::updateMaxHalfSize()
+{
+    _maxHalfSize.set(Vector3::zero());
+    for (const Entry& entry : _entries)
+    {
+        if (entry.object && entry.cell != SPATIAL_HASH_GRID_CELL_NONE)
+            growMaxHalfSize(entry.box);
+    }
+    _maxHalfSizeDirty = false;
+}
+
+void SpatialHashGrid::gatherCandidates(const BoundingBox& region)
+{
+    // Objects are stored by their centers, so a region query has to look as
+    // far around the region as the largest object reaches from its center.
+    // The large objects are candidates for every region.
+    if (_maxHalfSizeDirty)
+        updateMaxHalfSize();
+    _candidates.assign(_largeEntries.begin(), _largeEntries.end());
+    int minX = std::max(getCoordinate(region.min.x - _maxHalfSize.x), _minCoordinates[0]);
+    int minY = std::max(getCoordinate(region.min.y - _maxHalfSize.y), _minCoordinates[1]);
+    int minZ = std::max(getCoordinate(region.min.z - _maxHalfSize.z), _minCoordinates[2]);
+    int maxX = std::min(getCoordinate(region.max.x + _maxHalfSize.x), _maxCoordinates[0]);
+    int maxY = std::min(getCoordinate(region.max.y + _maxHalfSize.y), _maxCoordinates[1]);
+    int maxZ = std::min(getCoordinate(region.max.z + _maxHalfSize.z), _maxCoordinates[2]);
+    if (minX > maxX || minY > maxY || minZ > maxZ)
+        return;
+    double volume = ((double)maxX - minX + 1.0) * ((double)maxY - minY + 1.0) * ((double)maxZ - minZ + 1.0);
+    if (volume > (double)_cellIndex.size())
+    {
+        for (const std::vector<size_t>& cell : _cells)
+        {
+            _candidates.insert(_candidates.end(), cell.begin(), cell.end());
+        }
+        return;
+    }
+    for (int x = minX; x <= maxX; ++x)
+    {
+        for (int y = minY; y <= maxY; ++y)
+        {
+            for (int z = minZ; z <= maxZ; ++z)
+            {
+                gatherCell(getKey(x, y, z));
+            }
+        }
+    }
+}
+
+void SpatialHashGrid::gatherCell(uint64_t key)
+{
+    auto itr = _cellIndex.find(key);
+    if (itr == _cellIndex.end())
+        return;
+    const std::vector<size_t>& cell = _cells[itr->second];
+    _candidates.insert(_candidates.end(), cell.begin(), cell.end());
+}
+
+void SpatialHashGrid::addNearest(size_t proxy, const Vector3& point, float maxDistanceSquared, uint32_t layerMask)
+{
+    const Entry& entry = _entries[proxy];
+    if (!(entry.layerMask & layerMask))
+        return;
+    const BoundingBox& box = entry.box;
+    float x = (box.min.x + box.max.x) * 0.5f - point.x;
+    float y = (box.min.y + box.max.y) * 0.5f - point.y;
+    float z = (box.min.z + box.max.z) * 0.5f - point.z;
+    float distanceSquared = x * x + y * y + z * z;
+    if (distanceSquared <= maxDistanceSquared)
+        _nearest.push_back(std::make_pair(distanceSquared, proxy));
+}
+
+size_t SpatialHashGrid::finishNearest(size_t count, std::vector<SceneObject*>& objects)
+{
+    count = std::min(count, _nearest.size());
+    std::partial_sort(_nearest.begin(), _nearest.begin() + count, _nearest.end());
+    for (size_t i = 0; i < count; ++i)
+    {
+        objects.push_back(_entries[_nearest[i].second].object);
+    }
+    return count;
+}
+
+}
@@ -0,0 +1,196 @@
+#pragma once
+
+#include "SpatialIndex.h"
+
+namespace gameplay
+{
+
+/**
+ * Defines a uniform grid of cells over scene objects, stored in a hash table.
+ *
+ * Each object is stored in the cell that holds the center of its bounds,
+ * so inserting, moving and removing an object take constant time and
+ * nothing is rebuilt when objects move every frame. Only the cells that
+ * hold objects are stored, so the grid spans about a million cells on each
+ * side of the origin without paying for the empty ones. Objects beyond share
+ * the cells at its edges. The queries are clipped to the range of cells that
+ * have held objects.
+ *
+ * The cell size should be about the distance of the typical neighbor query.
+ * Region queries visit the cells that overlap the region grown by the largest
+ * half size of the objects in the cells. Objects larger than the cells are
+ * kept in a list of their own that every query tests, so they don't make the
+ * queries visit more cells, and the largest half size shrinks again when the
+ * objects that set it shrink or are removed. A query that would visit more
+ * cells than the grid holds tests every object instead. Unbounded rays test every object,
+ * the bounding volume hierarchy is better suited to them.
+ */
+class SpatialHashGrid : public SpatialIndex
+{
+public:
+
+    /**
+     * Constructor.
+     */
+    SpatialHashGrid();
+
+    /**
+     * Constructor.
+     *
+     * @param cellSize The size of the cells in world units.
+     */
+    SpatialHashGrid(float cellSize);
+
+    /**
+     * Destructor.
+     */
+    ~SpatialHashGrid();
+
+    /**
+     * Gets the size of the cells.
+     *
+     * @return The size of the cells in world units.
+     */
+    float getCellSize() const;
+
+    /**
+     * Sets the size of the cells.
+     *
+     * The objects in the grid are moved to their new cells.
+     *
+     * @param cellSize The size of the cells in world units.
+     */
+    void setCellSize(float cellSize);
+
+    /**
+     * Gets the number of cells that hold objects.
+     *
+     * @return The number of cells that hold objects.
+     */
+    size_t getCellCount() const;
+
+    /**
+     * @see SpatialIndex::insert
+     */
+    size_t insert(SceneObject* object, const BoundingBox& box, uint32_t layerMask);
+
+    /**
+     * Updates the bounds of an object in the grid.
+     *
+     * The object moves to another cell when the center of its bounds does.
+     *
+     * @see SpatialIndex::update
+     */
+    bool update(size_t proxy, const BoundingBox& box);
+
+    /**
+     * @see SpatialIndex::remove
+     */
+    void remove(size_t proxy);
+
+    /**
+     * @see SpatialIndex::setLayerMask
+     */
+    void setLayerMask(size_t proxy, uint32_t layerMask);
+
+    /**
+     * @see SpatialIndex::clear
+     */
+    void clear();
+
+    /**
+     * @see SpatialIndex::getObject
+     */
+    SceneObject* getObject(size_t proxy) const;
+
+    /**
+     * @see SpatialIndex::getBounds
+     */
+    const BoundingBox& getBounds(size_t proxy) const;
+
+    /**
+     * @see SpatialIndex::getObjectCount
+     */
+    size_t getObjectCount() const;
+
+    /**
+     * @see SpatialIndex::query
+     */
+    size_t query(const BoundingBox& box, std::vector<SceneObject*>& objects, uint32_t layerMask);
+
+    /**
+     * @see SpatialIndex::query
+     */
+    size_t query(const BoundingSphere& sphere, std::vector<SceneObject*>& objects, uint32_t layerMask);
+
+    /**
+     * @see SpatialIndex::query
+     */
+    size_t query(const Frustum& frustum, std::vector<SceneObject*>& objects, uint32_t layerMask);
+
+    /**
+     * Finds the objects nearest to a point.
+     *
+     * The cells are visited in growing shells around the cell of the point
+     * until the shells are farther than the objects found.
+     *
+     * @see SpatialIndex::queryNearest
+     */
+    size_t queryNearest(const Vector3& point, size_t count, float maxDistance, std::vector<SceneObject*>& objects, uint32_t layerMask);
+
+    /**
+     * @see SpatialIndex::raycast
+     */
+    bool raycast(const Ray& ray, float maxDistance, Hit* hit, uint32_t layerMask);
+
+    /**
+     * @see SpatialIndex::raycastAll
+     */
+    size_t raycastAll(const Ray& ray, float maxDistance, std::vector<Hit>& hits, uint32_t layerMask);
+
+private:
+
+    struct Entry
+    {
+        BoundingBox box;
+        SceneObject* object;
+        uint32_t layerMask;
+        uint64_t key;
+        size_t cell;
+        size_t slot;
+    };
+
+    int getCoordinate(float value) const;
+    void resetCoordinates();
+    static uint64_t getKey(int x, int y, int z);
+    uint64_t getKey(const BoundingBox& box) const;
+    bool isLarge(const BoundingBox& box) const;
+    void insertIntoCell(size_t proxy);
+    void removeFromCell(size_t proxy);
+    static Vector3 getHalfSize(const BoundingBox& box);
+    void growMaxHalfSize(const BoundingBox& box);
+    void shrinkMaxHalfSize(const Entry& entry, const Vector3& halfSize);
+    void updateMaxHalfSize();
+    void gatherCandidates(const BoundingBox& region);
+    void gatherCell(uint64_t key);
+    void addNearest(size_t proxy, const Vector3& point, float maxDistanceSquared, uint32_t layerMask);
+    size_t finishNearest(size_t count, std::vector<SceneObject*>& objects);
+
+    std::vector<Entry> _entries;
+    std::vector<size_t> _freeEntries;
+    std::unordered_map<uint64_t, size_t> _cellIndex;
+    std::vector<std::vector<size_t>> _cells;
+    std::vector<size_t> _freeCells;
+    std::vector<size_t> _largeEntries;
+    std::vector<size_t> _candidates;
+    std::vector<std::pair<float, size_t>> _nearest;
+    Vector3 _maxHalfSize;
+    bool _maxHalfSizeDirty;
+    int _minCoordinates[3];
+    int _maxCoordinates[3];
+    float _cellSize;
+    float _inverseCellSize;
+    size_t _objectCount;
+};
+
+}
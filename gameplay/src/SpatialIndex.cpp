@@ -0,0 +1,73 @@
+#include "Base.h"
+#include "SpatialIndex.h"
+
+namespace gameplay
+{
+
+const size_t SpatialIndex::PROXY_NONE;
+
+SpatialIndex::SpatialIndex()
+{
+}
+
+SpatialIndex::~SpatialIndex()
+{
+}
+
+void SpatialIndex::insert(const std::vector<SceneObject*>& objects, const std::vector<BoundingBox>& boxes, const std::vector<uint32_t>& layerMasks,
+                          std::vector<size_t>& proxies)
+{
+    GP_ASSERT(objects.size() == boxes.size());
+    GP_ASSERT(objects.size() == layerMasks.size());
+
+    proxies.reserve(proxies.size() + objects.size());
+    for (size_t i = 0; i < objects.size(); ++i)
+    {
+        proxies.push_back(insert(objects[i], boxes[i], layerMasks[i]));
+    }
+}
+
+bool SpatialIndex::intersectRay(const BoundingBox& box, const Vector3& origin, const Vector3& inverseDirection, float maxDistance, float* distance)
+{
+    // Slab test with the direction inverted once per query.
+    float t1 = (box.min.x - origin.x) * inverseDirection.x;
+    float t2 = (box.max.x - origin.x) * inverseDirection.x;
+    float tmin = std::min(t1, t2);
+    float tmax = std::max(t1, t2);
+    t1 = (box.min.y - origin.y) * inverseDirection.y;
+    t2 = (box.max.y - origin.y) * inverseDirection.y;
+    tmin = std::max(tmin, std::min(t1, t2));
+    tmax = std::min(tmax, std::max(t1, t2));
+    t1 = (box.min.z - origin.z) * inverseDirection.z;
+    t2 = (box.max.z - origin.z) * inverseDirection.z;
+    tmin = std::max(tmin, std::min(t1, t2));
+    tmax = std::min(tmax, std::max(t1, t2));
+
+    // A ray starting inside the box hits it at the origin.
+    tmin = std::max(tmin, 0.0f);
+    if (tmin > tmax || tmin > maxDistance)
+        return false;
+    *distance = tmin;
+    return true;
+}
+
+Vector3 SpatialIndex::getInverseDirection(const Ray& ray)
+{
+    // A zero component never crosses the slabs on that axis,
+    // so it is given the largest finite inverse instead of infinity.
+    const Vector3& direction = ray.getDirection();
+    const float largest = std::numeric_limits<float>::max();
+    return Vector3(direction.x != 0.0f ? 1.0f / direction.x : largest,
+                   direction.y != 0.0f ? 1.0f / direction.y : largest,
+                   direction.z != 0.0f ? 1.0f / direction.z : largest);
+}
+
+void SpatialIndex::sortHits(std::vector<Hit>& hits, size_t begin)
+{
+    std::sort(hits.begin() + begin, hits.end(), [](const Hit& a, const Hit& b)
+    {
+        return a.distance < b.distance;
+    });
+}
+
+}
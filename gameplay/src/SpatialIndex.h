@@ -0,0 +1,241 @@
+#pragma once
+
+#include "BoundingBox.h"
+#include "BoundingSphere.h"
+#include "Frustum.h"
+#include "Ray.h"
+
+namespace gameplay
+{
+
+class SceneObject;
+
+/**
+ * Defines the base class for the spatial indices of the objects of a scene.
+ *
+ * An index stores the world bounds of each object behind a proxy that
+ * stays valid until the object is removed. The scene keeps its index up
+ * to date and runs its queries against it. Queries append their results
+ * to vectors owned by the caller.
+ *
+ * Each proxy also stores the layer mask of its object. The queries take a
+ * layer mask too and skip the objects that are on none of its layers,
+ * without testing their bounds.
+ *
+ * The bounding volume hierarchy suits scenes with objects of any size
+ * and ray queries. The spatial hash grid suits many small objects that
+ * move every frame and neighbor queries.
+ */
+class SpatialIndex
+{
+public:
+
+    /**
+     * The proxy that does not refer to any object.
+     */
+    static const size_t PROXY_NONE = (size_t)-1;
+
+    /**
+     * Defines an object hit by a ray.
+     */
+    struct Hit
+    {
+        /**
+         * The object that was hit.
+         */
+        SceneObject* object;
+
+        /**
+         * The distance along the ray to the bounds of the object.
+         */
+        float distance;
+    };
+
+    /**
+     * Destructor.
+     */
+    virtual ~SpatialIndex();
+
+    /**
+     * Inserts an object into the index.
+     *
+     * @param object The object to insert.
+     * @param box The world bounds of the object.
+     * @param layerMask The layers of the object.
+     * @return The proxy of the object.
+     */
+    virtual size_t insert(SceneObject* object, const BoundingBox& box, uint32_t layerMask) = 0;
+
+    /**
+     * Inserts many objects into the index at once.
+     *
+     * @param objects The objects to insert.
+     * @param boxes The world bounds of each object.
+     * @param layerMasks The layers of each object.
+     * @param proxies A vector that the proxy of each object is appended to.
+     */
+    virtual void insert(const std::vector<SceneObject*>& objects, const std::vector<BoundingBox>& boxes, const std::vector<uint32_t>& layerMasks,
+                        std::vector<size_t>& proxies);
+
+    /**
+     * Updates the bounds of an object in the index.
+     *
+     * @param proxy The proxy of the object.
+     * @param box The new world bounds of the object.
+     * @return true if the object moved within the index, false if only its bounds were updated.
+     */
+    virtual bool update(size_t proxy, const BoundingBox& box) = 0;
+
+    /**
+     * Removes an object from the index.
+     *
+     * @param proxy The proxy of the object.
+     */
+    virtual void remove(size_t proxy) = 0;
+
+    /**
+     * Sets the layers of an object in the index.
+     *
+     * @param proxy The proxy of the object.
+     * @param layerMask The layers of the object.
+     */
+    virtual void setLayerMask(size_t proxy, uint32_t layerMask) = 0;
+
+    /**
+     * Removes all the objects from the index.
+     */
+    virtual void clear() = 0;
+
+    /**
+     * Gets the object of a proxy.
+     *
+     * @param proxy The proxy of the object.
+     * @return The object of the proxy.
+     */
+    virtual SceneObject* getObject(size_t proxy) const = 0;
+
+    /**
+     * Gets the world bounds of the object of a proxy.
+     *
+     * @param proxy The proxy of the object.
+     * @return The world bounds of the object.
+     */
+    virtual const BoundingBox& getBounds(size_t proxy) const = 0;
+
+    /**
+     * Gets the number of objects in the index.
+     *
+     * @return The number of objects in the index.
+     */
+    virtual size_t getObjectCount() const = 0;
+
+    /**
+     * Finds the objects whose bounds intersect a box.
+     *
+     * @param box The box to test against.
+     * @param objects A vector that the objects found are appended to.
+     * @param layerMask The layers to search.
+     * @return The number of objects found.
+     */
+    virtual size_t query(const BoundingBox& box, std::vector<SceneObject*>& objects, uint32_t layerMask) = 0;
+
+    /**
+     * Finds the objects whose bounds intersect a sphere.
+     *
+     * @param sphere The sphere to test against.
+     * @param objects A vector that the objects found are appended to.
+     * @param layerMask The layers to search.
+     * @return The number of objects found.
+     */
+    virtual size_t query(const BoundingSphere& sphere, std::vector<SceneObject*>& objects, uint32_t layerMask) = 0;
+
+    /**
+     * Finds the objects whose bounds intersect a frustum.
+     *
+     * @param frustum The frustum to test against.
+     * @param objects A vector that the objects found are appended to.
+     * @param layerMask The layers to search.
+     * @return The number of objects found.
+     */
+    virtual size_t query(const Frustum& frustum, std::vector<SceneObject*>& objects, uint32_t layerMask) = 0;
+
+    /**
+     * Finds the objects nearest to a point.
+     *
+     * The position of an object is the center of its bounds. With a
+     * count larger than the number of objects this finds all the
+     * objects within the distance.
+     *
+     * @param point The point to measure from.
+     * @param count The largest number of objects to find.
+     * @param maxDistance The distance beyond which objects are ignored.
+     * @param objects A vector that the objects found are appended to, nearest first.
+     * @param layerMask The layers to search.
+     * @return The number of objects found.
+     */
+    virtual size_t queryNearest(const Vector3& point, size_t count, float maxDistance, std::vector<SceneObject*>& objects, uint32_t layerMask) = 0;
+
+    /**
+     * Finds the nearest object whose bounds are hit by a ray.
+     *
+     * @param ray The ray to test against. The direction should be normalized.
+     * @param maxDistance The distance along the ray beyond which objects are ignored.
+     * @param hit The nearest hit if one is found.
+     * @param layerMask The layers to search.
+     * @return true if an object is hit, false if not.
+     */
+    virtual bool raycast(const Ray& ray, float maxDistance, Hit* hit, uint32_t layerMask) = 0;
+
+    /**
+     * Finds all the objects whose bounds are hit by a ray.
+     *
+     * @param ray The ray to test against. The direction should be normalized.
+     * @param maxDistance The distance along the ray beyond which objects are ignored.
+     * @param hits A vector that the hits are appended to, nearest first.
+     * @param layerMask The layers to search.
+     * @return The number of hits found.
+     */
+    virtual size_t raycastAll(const Ray& ray, float maxDistance, std::vector<Hit>& hits, uint32_t layerMask) = 0;
+
+protected:
+
+    /**
+     * Constructor.
+     */
+    SpatialIndex();
+
+    /**
+     * Tests a ray against a box with the inverse of the ray direction.
+     *
+     * @param box The box to test.
+     * @param origin The origin of the ray.
+     * @param inverseDirection The inverse of each component of the ray direction.
+     * @param maxDistance The distance along the ray beyond which the box is ignored.
+     * @param distance The distance along the ray where it enters the box, 0 if it starts inside.
+     * @return true if the ray hits the box within the distance, false if not.
+     */
+    static bool intersectRay(const BoundingBox& box, const Vector3& origin, const Vector3& inverseDirection, float maxDistance, float* distance);
+
+    /**
+     * Gets the inverse of each component of the direction of a ray.
+     *
+     * @param ray The ray.
+     * @return The inverse of each component of the direction, the largest float for the zero ones.
+     */
+    static Vector3 getInverseDirection(const Ray& ray);
+
+    /**
+     * Sorts hits by distance.
+     *
+     * @param hits The hits to sort.
+     * @param begin The first hit to sort.
+     */
+    static void sortHits(std::vector<Hit>& hits, size_t begin);
+
+private:
+
+    SpatialIndex(const SpatialIndex& copy);
+    SpatialIndex& operator=(const SpatialIndex& copy);
+};
+
+}
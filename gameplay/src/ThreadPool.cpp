@@ -0,0 +1,97 @@
+#include "Base.h"
+#include "ThreadPool.h"
+
+namespace gameplay
+{
+
+ThreadPool::ThreadPool(size_t threadCount) :
+    _job(nullptr),
+    _jobCount(0),
+    _jobGeneration(0),
+    _jobsPending(0),
+    _running(true)
+{
+    if (threadCount == 0)
+        threadCount = std::max((size_t)std::thread::hardware_concurrency(), (size_t)1);
+
+    // The calling thread executes the first chunk of each job.
+    for (size_t i = 1; i < threadCount; ++i)
+    {
+        _threads.push_back(std::thread(&ThreadPool::run, this, i));
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _running = false;
+    }
+    _jobReady.notify_all();
+    for (auto& thread : _threads)
+    {
+        thread.join();
+    }
+}
+
+size_t ThreadPool::getThreadCount() const
+{
+    return _threads.size() + 1;
+}
+
+void ThreadPool::execute(size_t count, const Job& job)
+{
+    size_t threadCount = getThreadCount();
+    if (threadCount == 1 || count < threadCount)
+    {
+        job(0, count);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _job = &job;
+        _jobCount = count;
+        _jobsPending = _threads.size();
+        ++_jobGeneration;
+    }
+    _jobReady.notify_all();
+
+    job(0, count / threadCount);
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    _jobDone.wait(lock, [this] { return _jobsPending == 0; });
+    _job = nullptr;
+}
+
+void ThreadPool::run(size_t threadIndex)
+{
+    size_t generation = 0;
+    while (true)
+    {
+        const Job* job;
+        size_t count;
+        size_t threadCount;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _jobReady.wait(lock, [this, generation] { return !_running || _jobGeneration != generation; });
+            if (!_running)
+                return;
+            generation = _jobGeneration;
+            job = _job;
+            count = _jobCount;
+            threadCount = getThreadCount();
+        }
+
+        (*job)(count * threadIndex / threadCount, count * (threadIndex + 1) / threadCount);
+
+        bool done;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            done = (--_jobsPending == 0);
+        }
+        if (done)
+            _jobDone.notify_one();
+    }
+}
+
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+namespace gameplay
+{
+
+/**
+ * Defines a pool of worker threads used to split work across cores.
+ *
+ * Work is submitted as a range of items that is divided into one
+ * contiguous chunk per thread. The calling thread processes the first
+ * chunk itself and then waits for the workers to finish the rest, so
+ * each chunk always covers the same items for a given count.
+ */
+class ThreadPool
+{
+public:
+
+    /**
+     * Defines a job to be executed over a range of items [begin, end).
+     */
+    typedef std::function<void(size_t begin, size_t end)> Job;
+
+    /**
+     * Constructor.
+     *
+     * @param threadCount The number of threads (including the calling thread)
+     *        to execute jobs on. Zero uses the number of hardware threads.
+     */
+    ThreadPool(size_t threadCount);
+
+    /**
+     * Destructor.
+     */
+    ~ThreadPool();
+
+    /**
+     * Gets the number of threads (including the calling thread) jobs execute on.
+     *
+     * @return The number of threads jobs execute on.
+     */
+    size_t getThreadCount() const;
+
+    /**
+     * Executes a job over a range of items and waits for it to complete.
+     *
+     * @param count The number of items to process.
+     * @param job The job to execute for each chunk of the items.
+     */
+    void execute(size_t count, const Job& job);
+
+private:
+
+    ThreadPool(const ThreadPool& copy);
+    void run(size_t threadIndex);
+
+    std::vector<std::thread> _threads;
+    std::mutex _mutex;
+    std::condition_variable _jobReady;
+    std::condition_variable _jobDone;
+    const Job* _job;
+    size_t _jobCount;
+    size_t _jobGeneration;
+    size_t _jobsPending;
+    bool _running;
+};
+
+}
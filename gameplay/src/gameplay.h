@@ -2,6 +2,8 @@
 
 #include "Base.h"
 #include "Logger.h"
+#include "ThreadPool.h"
+#include "Arena.h"
 #include "Platform.h"
 #include "Game.h"
 #include "MathUtil.h"
@@ -10,7 +12,9 @@
 #include "Vector4.h"
 #include "Quaternion.h"
 #include "Matrix.h"
+#include "AffineTransform.h"
 #include "Frustum.h"
+#include "OcclusionCuller.h"
 #include "BoundingSphere.h"
 #include "BoundingBox.h"
 #include "Plane.h"
@@ -22,6 +26,11 @@
 #include "Serializer.h"
 #include "SerializerBinary.h"
 #include "SerializerJson.h"
+#include "SpatialIndex.h"
+#include "BoundingVolumeHierarchy.h"
+#include "SpatialHashGrid.h"
+#include "Scene.h"
+#include "SceneObjectHandle.h"
 #include "SceneObject.h"
 #include "Component.h"
 #include "Script.h"
@@ -55,6 +64,7 @@
 //#include "PhysicsVehicle.h"
 
 #include "Renderer.h"
+#include "RendererLod.h"
 //#include "RendererText.h"
 //#include "RendererSprite.h"
 //#include "RendererTileSet.h"